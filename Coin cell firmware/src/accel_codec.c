@@ -0,0 +1,283 @@
+/**
+ * @file accel_codec.c
+ * @brief Lossless streaming codec for packed sensor samples
+ *
+ * The encoder never has to back out: for every candidate (order, k) it keeps
+ * the bits the pending block would take, so a sample is only accepted if the
+ * cheapest choice per channel still fits. Flushing at any point is then
+ * guaranteed to succeed.
+ */
+
+#include <string.h>
+
+#include "accel_codec.h"
+
+/*============================================================================
+ * Bit I/O (LSB first)
+ *===========================================================================*/
+
+static void bits_put(struct accel_codec *c, uint32_t val, uint8_t n) {
+  while (n > 0) {
+    uint32_t byte = c->bits >> 3;
+    uint8_t shift = c->bits & 7;
+    uint8_t take = 8 - shift;
+
+    if (take > n) {
+      take = n;
+    }
+    if (shift == 0) {
+      c->buf[byte] = 0;
+    }
+    c->buf[byte] |= (uint8_t)((val & ((1U << take) - 1)) << shift);
+    val >>= take;
+    c->bits += take;
+    n -= take;
+  }
+}
+
+struct bit_reader {
+  const uint8_t *buf;
+  uint32_t len_bits;
+  uint32_t pos;
+};
+
+static int bits_get(struct bit_reader *r, uint8_t n, uint32_t *val) {
+  uint32_t v = 0;
+
+  if (r->pos + n > r->len_bits) {
+    return -1;
+  }
+  for (uint8_t i = 0; i < n; i++, r->pos++) {
+    v |= (uint32_t)((r->buf[r->pos >> 3] >> (r->pos & 7)) & 1) << i;
+  }
+  *val = v;
+  return 0;
+}
+
+/*============================================================================
+ * Residuals
+ *===========================================================================*/
+
+static uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t u) {
+  return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+static int32_t predict(uint8_t order, int16_t prev1, int16_t prev2) {
+  return order ? 2 * (int32_t)prev1 - prev2 : prev1;
+}
+
+static uint8_t rice_len(uint32_t u, uint8_t k) {
+  uint32_t q = u >> k;
+
+  return q < ACCEL_CODEC_ESCAPE ? (uint8_t)(q + 1 + k)
+                                : ACCEL_CODEC_ESCAPE + ACCEL_CODEC_RAW_BITS;
+}
+
+static void rice_put(struct accel_codec *c, uint32_t u, uint8_t k) {
+  uint32_t q = u >> k;
+
+  if (q >= ACCEL_CODEC_ESCAPE) {
+    bits_put(c, (1U << ACCEL_CODEC_ESCAPE) - 1, ACCEL_CODEC_ESCAPE);
+    bits_put(c, u, ACCEL_CODEC_RAW_BITS);
+    return;
+  }
+  bits_put(c, (1U << q) - 1, (uint8_t)(q + 1)); /* q ones, then a zero */
+  bits_put(c, u, k);
+}
+
+/*============================================================================
+ * Encoder
+ *===========================================================================*/
+
+/* Cheapest (order, k) for channel ch of the pending block, plus its cost */
+static uint32_t block_best(const struct accel_codec *c, uint8_t ch,
+                           uint8_t *order, uint8_t *k) {
+  uint32_t best = UINT32_MAX;
+
+  for (uint8_t o = 0; o < ACCEL_CODEC_ORDERS; o++) {
+    for (uint8_t kk = 0; kk <= ACCEL_CODEC_K_MAX; kk++) {
+      if (c->cost[ch][o][kk] < best) {
+        best = c->cost[ch][o][kk];
+        *order = o;
+        *k = kk;
+      }
+    }
+  }
+  return best + 1 + ACCEL_CODEC_K_BITS;
+}
+
+static void block_flush(struct accel_codec *c) {
+  for (uint8_t ch = 0; ch < c->nch; ch++) {
+    uint8_t order = 0;
+    uint8_t k = 0;
+
+    block_best(c, ch, &order, &k);
+    bits_put(c, order, 1);
+    bits_put(c, k, ACCEL_CODEC_K_BITS);
+    for (uint8_t i = 0; i < c->block_len; i++) {
+      rice_put(c, c->res[order][i][ch], k);
+    }
+  }
+
+  c->block_len = 0;
+  memset(c->cost, 0, sizeof(c->cost));
+}
+
+void accel_codec_begin(struct accel_codec *c, uint8_t *buf, size_t cap,
+                       uint8_t nch) {
+  c->buf = buf;
+  c->cap_bits = (uint32_t)cap * 8U;
+  c->bits = 0;
+  c->nch = nch;
+  c->count = 0;
+  c->block_len = 0;
+  memset(c->cost, 0, sizeof(c->cost));
+}
+
+bool accel_codec_put(struct accel_codec *c, const int16_t *sample) {
+  if (c->count >= ACCEL_CODEC_SAMPLES_MAX) {
+    return false;
+  }
+
+  /* First sample: verbatim */
+  if (c->count == 0) {
+    if (c->cap_bits < 16U * c->nch) {
+      return false;
+    }
+    for (uint8_t ch = 0; ch < c->nch; ch++) {
+      bits_put(c, (uint16_t)sample[ch], 16);
+      c->prev1[ch] = sample[ch];
+      c->prev2[ch] = sample[ch]; /* Order 1 degrades to order 0 once */
+    }
+    c->count = 1;
+    return true;
+  }
+
+  /* Would the pending block still fit with this sample in it? (Costs are
+   * recomputed on accept rather than staged: this runs on a small stack) */
+  uint32_t res[ACCEL_CODEC_ORDERS][ACCEL_CODEC_CH_MAX];
+  uint32_t need = c->bits;
+
+  for (uint8_t ch = 0; ch < c->nch; ch++) {
+    uint32_t best = UINT32_MAX;
+
+    for (uint8_t o = 0; o < ACCEL_CODEC_ORDERS; o++) {
+      res[o][ch] =
+          zigzag(sample[ch] - predict(o, c->prev1[ch], c->prev2[ch]));
+      for (uint8_t k = 0; k <= ACCEL_CODEC_K_MAX; k++) {
+        uint32_t cost = c->cost[ch][o][k] + rice_len(res[o][ch], k);
+
+        if (cost < best) {
+          best = cost;
+        }
+      }
+    }
+    need += best + 1 + ACCEL_CODEC_K_BITS;
+  }
+  if (need > c->cap_bits) {
+    return false;
+  }
+
+  for (uint8_t ch = 0; ch < c->nch; ch++) {
+    for (uint8_t o = 0; o < ACCEL_CODEC_ORDERS; o++) {
+      c->res[o][c->block_len][ch] = res[o][ch];
+      for (uint8_t k = 0; k <= ACCEL_CODEC_K_MAX; k++) {
+        c->cost[ch][o][k] += rice_len(res[o][ch], k);
+      }
+    }
+    c->prev2[ch] = c->prev1[ch];
+    c->prev1[ch] = sample[ch];
+  }
+  c->count++;
+
+  if (++c->block_len == ACCEL_CODEC_BLOCK) {
+    block_flush(c);
+  }
+  return true;
+}
+
+size_t accel_codec_finish(struct accel_codec *c) {
+  if (c->block_len > 0) {
+    block_flush(c);
+  }
+  return (c->bits + 7) / 8;
+}
+
+/*============================================================================
+ * Decoder
+ *===========================================================================*/
+
+static int rice_get(struct bit_reader *r, uint8_t k, uint32_t *u) {
+  uint32_t q = 0;
+  uint32_t bit;
+
+  for (;;) {
+    if (bits_get(r, 1, &bit)) {
+      return -1;
+    }
+    if (!bit) {
+      break;
+    }
+    if (++q == ACCEL_CODEC_ESCAPE) {
+      return bits_get(r, ACCEL_CODEC_RAW_BITS, u);
+    }
+  }
+  if (bits_get(r, k, u)) {
+    return -1;
+  }
+  *u |= q << k;
+  return 0;
+}
+
+int accel_codec_decode(const uint8_t *buf, size_t len, uint8_t nch,
+                       uint16_t count, int16_t *out) {
+  struct bit_reader r = {.buf = buf, .len_bits = (uint32_t)len * 8U};
+  int16_t prev1[ACCEL_CODEC_CH_MAX];
+  int16_t prev2[ACCEL_CODEC_CH_MAX];
+  uint32_t v;
+
+  if (nch == 0 || nch > ACCEL_CODEC_CH_MAX || count == 0) {
+    return -1;
+  }
+
+  for (uint8_t ch = 0; ch < nch; ch++) {
+    if (bits_get(&r, 16, &v)) {
+      return -1;
+    }
+    out[ch] = (int16_t)v;
+    prev1[ch] = prev2[ch] = (int16_t)v;
+  }
+
+  for (uint16_t start = 1; start < count; start += ACCEL_CODEC_BLOCK) {
+    uint16_t n = count - start;
+
+    if (n > ACCEL_CODEC_BLOCK) {
+      n = ACCEL_CODEC_BLOCK;
+    }
+
+    for (uint8_t ch = 0; ch < nch; ch++) {
+      uint32_t order;
+      uint32_t k;
+
+      if (bits_get(&r, 1, &order) || bits_get(&r, ACCEL_CODEC_K_BITS, &k)) {
+        return -1;
+      }
+      for (uint16_t i = 0; i < n; i++) {
+        if (rice_get(&r, (uint8_t)k, &v)) {
+          return -1;
+        }
+        int32_t x = predict((uint8_t)order, prev1[ch], prev2[ch]) +
+                    unzigzag(v);
+
+        out[(start + i) * nch + ch] = (int16_t)x;
+        prev2[ch] = prev1[ch];
+        prev1[ch] = (int16_t)x;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file accel_codec.h
+ * @brief Lossless streaming codec for packed sensor samples
+ *
+ * Each packet is coded on its own, so a lost notification never affects the
+ * packets after it:
+ *
+ * - The first sample holds every channel verbatim (int16, 16 bits).
+ * - The rest go in blocks of ACCEL_CODEC_BLOCK samples (the last block may
+ *   be shorter, sample_count says how long). Per block, channel by channel:
+ *   1 bit predictor order (0 = previous sample, 1 = linear extrapolation
+ *   from the previous two), 4 bits Rice parameter k, then one Rice code per
+ *   sample of the zig-zagged prediction residual.
+ * - Rice code of u: q = u >> k ones, a zero, then the k low bits of u. If
+ *   q >= ACCEL_CODEC_ESCAPE, ACCEL_CODEC_ESCAPE ones then u in
+ *   ACCEL_CODEC_RAW_BITS bits instead.
+ *
+ * Bits are written LSB first. The encoder picks order and k per block for
+ * the fewest bits, so a static axis costs ~1-2 bits per sample and full-scale
+ * noise a little over 16.
+ *
+ * No Zephyr dependencies: host tools can build accel_codec.c as is to decode
+ * captured packets.
+ */
+
+#ifndef ACCEL_CODEC_H_
+#define ACCEL_CODEC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACCEL_CODEC_CH_MAX 7     /* Channels per sample */
+#define ACCEL_CODEC_BLOCK 16     /* Samples per block after the first */
+#define ACCEL_CODEC_K_BITS 4     /* Rice parameter 0-15 */
+#define ACCEL_CODEC_K_MAX 15
+#define ACCEL_CODEC_ORDERS 2     /* Predictor orders tried per block */
+#define ACCEL_CODEC_ESCAPE 24    /* Unary length that flags a raw residual */
+#define ACCEL_CODEC_RAW_BITS 18  /* Zig-zagged 2nd-order residual of int16 */
+#define ACCEL_CODEC_SAMPLES_MAX 255 /* sample_count is a uint8 */
+
+/* Encoder state for one packet */
+struct accel_codec {
+  uint8_t *buf;
+  uint32_t cap_bits;
+  uint32_t bits;         /* Written so far */
+  uint8_t nch;
+  uint16_t count;        /* Samples taken, pending block included */
+  int16_t prev1[ACCEL_CODEC_CH_MAX];
+  int16_t prev2[ACCEL_CODEC_CH_MAX];
+  uint8_t block_len;     /* Samples in the pending block */
+  /* Zig-zagged residuals of the pending block, by order */
+  uint32_t res[ACCEL_CODEC_ORDERS][ACCEL_CODEC_BLOCK][ACCEL_CODEC_CH_MAX];
+  /* Bits the pending block would take, by channel, order and k */
+  uint16_t cost[ACCEL_CODEC_CH_MAX][ACCEL_CODEC_ORDERS][ACCEL_CODEC_K_MAX + 1];
+};
+
+/**
+ * @brief Start coding a packet
+ * @param c Encoder state
+ * @param buf Packet data area, written as samples are taken
+ * @param cap Size of buf in bytes
+ * @param nch Channels per sample (1 to ACCEL_CODEC_CH_MAX)
+ */
+void accel_codec_begin(struct accel_codec *c, uint8_t *buf, size_t cap,
+                       uint8_t nch);
+
+/**
+ * @brief Add one sample
+ *
+ * Only accepted if the packet can still be finished with it.
+ * @param c Encoder state
+ * @param sample nch channel values
+ * @return true if taken, false if the packet is full (the sample belongs to
+ *         the next one)
+ */
+bool accel_codec_put(struct accel_codec *c, const int16_t *sample);
+
+/**
+ * @brief Flush the pending block and zero the unused bits of the last byte
+ * @param c Encoder state
+ * @return Bytes of buf used
+ */
+size_t accel_codec_finish(struct accel_codec *c);
+
+/**
+ * @brief Decode one packet's data
+ * @param buf Packet data area
+ * @param len Size of buf in bytes
+ * @param nch Channels per sample
+ * @param count Samples in the packet (sample_count)
+ * @param out count * nch values, sample-major
+ * @return 0 on success, -1 if the data ends early or is malformed
+ */
+int accel_codec_decode(const uint8_t *buf, size_t len, uint8_t nch,
+                       uint16_t count, int16_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ACCEL_CODEC_H_ */
@@ -11,6 +11,7 @@
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/crc.h>
 
 #include "accel_service.h"
@@ -21,20 +22,45 @@ LOG_MODULE_REGISTER(accel_svc, LOG_LEVEL_INF);
  * Configuration
  *===========================================================================*/
 
-#define SAMPLING_RATE_HZ 1000
+#define SAMPLING_RATE_HZ SAMPLING_RATE_MAX_HZ /* Until main.c publishes */
 
 /*============================================================================
  * State Variables
  *===========================================================================*/
 
+/* Set while any central is subscribed; each connection's own CCC value is
+ * checked with bt_gatt_is_subscribed() */
 static bool data_notify_enabled = false;
 static bool timestamp_notify_enabled = false;
-static struct bt_conn *current_conn = NULL;
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+static bool history_notify_enabled = false;
+#endif
+#if defined(CONFIG_ACCEL_SPECTRUM)
+static bool spectrum_notify_enabled = false;
+#endif
+#if defined(CONFIG_ACCEL_FEATURES)
+static bool features_notify_enabled = false;
+#endif
+#if defined(CONFIG_ACCEL_TRIGGER)
+static bool trigger_notify_enabled = false;
+#endif
 static operating_mode_t current_mode = MODE_COINCELL_BURST;
 
 /* Cached attribute pointers - resolved at init, not hard-coded indices */
 static const struct bt_gatt_attr *accel_data_attr = NULL;
 static const struct bt_gatt_attr *timestamp_attr = NULL;
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+static const struct bt_gatt_attr *history_attr = NULL;
+#endif
+#if defined(CONFIG_ACCEL_SPECTRUM)
+static const struct bt_gatt_attr *spectrum_attr = NULL;
+#endif
+#if defined(CONFIG_ACCEL_FEATURES)
+static const struct bt_gatt_attr *features_attr = NULL;
+#endif
+#if defined(CONFIG_ACCEL_TRIGGER)
+static const struct bt_gatt_attr *trigger_attr = NULL;
+#endif
 
 /* External power detection stub - TODO: implement ADC check */
 static bool external_power_detected = false;
@@ -43,7 +69,25 @@ static bool external_power_detected = false;
  *===========================================================================*/
 
 static uint16_t sampling_rate = SAMPLING_RATE_HZ;
+static accel_service_rate_cb_t rate_cb = NULL;
+static uint8_t channel_mask = ACCEL_CH_ACCEL_XYZ;
+static accel_service_chmask_cb_t chmask_cb = NULL;
+#if defined(CONFIG_ACCEL_RETX)
+static accel_service_retx_cb_t retx_cb = NULL;
+#endif
+#if defined(CONFIG_ACCEL_TRIGGER)
+static accel_service_trigger_cb_t trigger_cb = NULL;
+static trigger_config_t trigger_config; /* TRIGGER_OFF */
+#endif
+#if defined(CONFIG_ACCEL_L2CAP_STREAM)
+static uint16_t l2cap_psm = 0; /* 0 until the server is registered */
+#endif
+static link_profile_t link_profiles[CONFIG_BT_MAX_CONN]; /* By conn index */
 static uint32_t current_timestamp = 0;
+#if defined(CONFIG_ACCEL_FEATURES)
+static accel_features_t features_latest;
+static uint16_t features_len = 0; /* 0 until the first window closes */
+#endif
 
 static sensor_metadata_t sensor_meta = {
     .sensor_name = "ISRO_Phase3_Accel", .range_g = 16, .unit = "g"};
@@ -56,7 +100,7 @@ static void accel_data_ccc_changed(const struct bt_gatt_attr *attr,
                                    uint16_t value) {
   data_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
   LOG_INF("Acceleration Data notifications %s",
-          data_notify_enabled ? "ENABLED" : "DISABLED");
+          data_notify_enabled ? "ENABLED" : "DISABLED (all centrals)");
 }
 
 static void timestamp_ccc_changed(const struct bt_gatt_attr *attr,
@@ -66,6 +110,42 @@ static void timestamp_ccc_changed(const struct bt_gatt_attr *attr,
           timestamp_notify_enabled ? "enabled" : "disabled");
 }
 
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+static void history_ccc_changed(const struct bt_gatt_attr *attr,
+                                uint16_t value) {
+  history_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+  LOG_INF("History notifications %s",
+          history_notify_enabled ? "enabled" : "disabled");
+}
+#endif
+
+#if defined(CONFIG_ACCEL_SPECTRUM)
+static void spectrum_ccc_changed(const struct bt_gatt_attr *attr,
+                                 uint16_t value) {
+  spectrum_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+  LOG_INF("Spectrum notifications %s",
+          spectrum_notify_enabled ? "enabled" : "disabled");
+}
+#endif
+
+#if defined(CONFIG_ACCEL_FEATURES)
+static void features_ccc_changed(const struct bt_gatt_attr *attr,
+                                 uint16_t value) {
+  features_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+  LOG_INF("Feature notifications %s",
+          features_notify_enabled ? "enabled" : "disabled");
+}
+#endif
+
+#if defined(CONFIG_ACCEL_TRIGGER)
+static void trigger_ccc_changed(const struct bt_gatt_attr *attr,
+                                uint16_t value) {
+  trigger_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+  LOG_INF("Trigger notifications %s",
+          trigger_notify_enabled ? "enabled" : "disabled");
+}
+#endif
+
 /*============================================================================
  * Read Callbacks
  *===========================================================================*/
@@ -85,6 +165,162 @@ static ssize_t read_sampling_rate(struct bt_conn *conn,
                            sizeof(sampling_rate));
 }
 
+static ssize_t write_sampling_rate(struct bt_conn *conn,
+                                   const struct bt_gatt_attr *attr,
+                                   const void *buf, uint16_t len,
+                                   uint16_t offset, uint8_t flags) {
+  if (offset != 0) {
+    return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+  }
+  if (len != sizeof(uint16_t)) {
+    return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+  }
+  if (!rate_cb) {
+    return BT_GATT_ERR(BT_ATT_ERR_WRITE_NOT_PERMITTED);
+  }
+
+  uint16_t requested = sys_get_le16(buf);
+  int err = rate_cb(requested);
+  if (err == -EINVAL) {
+    LOG_WRN("Rejecting sampling rate %u Hz", requested);
+    return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+  } else if (err) {
+    return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+  }
+
+  LOG_INF("Sampling rate change to %u Hz requested", requested);
+  return len;
+}
+
+static ssize_t read_channel_mask(struct bt_conn *conn,
+                                 const struct bt_gatt_attr *attr, void *buf,
+                                 uint16_t len, uint16_t offset) {
+  return bt_gatt_attr_read(conn, attr, buf, len, offset, &channel_mask,
+                           sizeof(channel_mask));
+}
+
+static ssize_t write_channel_mask(struct bt_conn *conn,
+                                  const struct bt_gatt_attr *attr,
+                                  const void *buf, uint16_t len,
+                                  uint16_t offset, uint8_t flags) {
+  if (offset != 0) {
+    return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+  }
+  if (len != 1) {
+    return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+  }
+  if (!chmask_cb) {
+    return BT_GATT_ERR(BT_ATT_ERR_WRITE_NOT_PERMITTED);
+  }
+
+  uint8_t requested = ((const uint8_t *)buf)[0];
+  int err = chmask_cb(requested);
+  if (err == -EINVAL) {
+    LOG_WRN("Rejecting channel mask 0x%02x", requested);
+    return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+  } else if (err) {
+    return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+  }
+
+  LOG_INF("Channel mask change to 0x%02x requested", requested);
+  return len;
+}
+
+#if defined(CONFIG_ACCEL_RETX)
+static ssize_t write_retx_request(struct bt_conn *conn,
+                                  const struct bt_gatt_attr *attr,
+                                  const void *buf, uint16_t len,
+                                  uint16_t offset, uint8_t flags) {
+  if (offset != 0) {
+    return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+  }
+  if (len != RETX_REQUEST_SIZE) {
+    return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+  }
+  if (!retx_cb) {
+    return BT_GATT_ERR(BT_ATT_ERR_WRITE_NOT_PERMITTED);
+  }
+
+  uint32_t first = sys_get_le32(buf);
+  uint16_t count = sys_get_le16((const uint8_t *)buf + 4);
+  int err = retx_cb(conn, first, count);
+  if (err == -EINVAL) {
+    return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+  } else if (err) {
+    LOG_WRN("Retransmit request %u+%u dropped (err %d)", first, count, err);
+    return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+  }
+
+  LOG_DBG("Retransmit of %u samples from %u requested", count, first);
+  return len;
+}
+#endif
+
+#if defined(CONFIG_ACCEL_L2CAP_STREAM)
+static ssize_t read_l2cap_psm(struct bt_conn *conn,
+                              const struct bt_gatt_attr *attr, void *buf,
+                              uint16_t len, uint16_t offset) {
+  uint8_t psm_le[2];
+
+  sys_put_le16(l2cap_psm, psm_le);
+  return bt_gatt_attr_read(conn, attr, buf, len, offset, psm_le,
+                           sizeof(psm_le));
+}
+#endif
+
+#if defined(CONFIG_ACCEL_FEATURES)
+static ssize_t read_features(struct bt_conn *conn,
+                             const struct bt_gatt_attr *attr, void *buf,
+                             uint16_t len, uint16_t offset) {
+  return bt_gatt_attr_read(conn, attr, buf, len, offset, &features_latest,
+                           features_len);
+}
+#endif
+
+#if defined(CONFIG_ACCEL_TRIGGER)
+static ssize_t read_trigger(struct bt_conn *conn,
+                            const struct bt_gatt_attr *attr, void *buf,
+                            uint16_t len, uint16_t offset) {
+  return bt_gatt_attr_read(conn, attr, buf, len, offset, &trigger_config,
+                           sizeof(trigger_config));
+}
+
+static ssize_t write_trigger(struct bt_conn *conn,
+                             const struct bt_gatt_attr *attr, const void *buf,
+                             uint16_t len, uint16_t offset, uint8_t flags) {
+  trigger_config_t cfg;
+
+  if (offset != 0) {
+    return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+  }
+  if (len != sizeof(cfg)) {
+    return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+  }
+  if (!trigger_cb) {
+    return BT_GATT_ERR(BT_ATT_ERR_WRITE_NOT_PERMITTED);
+  }
+
+  memcpy(&cfg, buf, sizeof(cfg));
+  int err = trigger_cb(&cfg);
+  if (err == -EINVAL) {
+    return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+  } else if (err) {
+    return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+  }
+
+  return len;
+}
+#endif
+
+static ssize_t read_link_profile(struct bt_conn *conn,
+                                 const struct bt_gatt_attr *attr, void *buf,
+                                 uint16_t len, uint16_t offset) {
+  /* Each central reads the parameters of its own link */
+  return bt_gatt_attr_read(conn, attr, buf, len, offset,
+                           &link_profiles[bt_conn_index(conn)],
+                           sizeof(link_profile_t));
+}
+
 static ssize_t read_sensor_meta(struct bt_conn *conn,
                                 const struct bt_gatt_attr *attr, void *buf,
                                 uint16_t len, uint16_t offset) {
@@ -146,9 +382,11 @@ BT_GATT_SERVICE_DEFINE(
                            BT_GATT_PERM_READ, read_timestamp, NULL, NULL),
     BT_GATT_CCC(timestamp_ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
 
-    /* Sampling Rate Characteristic (READ only) */
-    BT_GATT_CHARACTERISTIC(SAMPLE_RATE_CHAR_UUID, BT_GATT_CHRC_READ,
-                           BT_GATT_PERM_READ, read_sampling_rate, NULL, NULL),
+    /* Sampling Rate Characteristic (READ | WRITE) */
+    BT_GATT_CHARACTERISTIC(SAMPLE_RATE_CHAR_UUID,
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+                           BT_GATT_PERM_READ | BT_GATT_PERM_WRITE,
+                           read_sampling_rate, write_sampling_rate, NULL),
 
     /* Sensor Metadata Characteristic (READ only) */
     BT_GATT_CHARACTERISTIC(SENSOR_META_CHAR_UUID, BT_GATT_CHRC_READ,
@@ -158,7 +396,64 @@ BT_GATT_SERVICE_DEFINE(
     BT_GATT_CHARACTERISTIC(OPERATING_MODE_CHAR_UUID,
                            BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
                            BT_GATT_PERM_READ | BT_GATT_PERM_WRITE,
-                           read_operating_mode, write_operating_mode, NULL), );
+                           read_operating_mode, write_operating_mode, NULL),
+
+    /* Channel Mask Characteristic (READ | WRITE) */
+    BT_GATT_CHARACTERISTIC(CHANNEL_MASK_CHAR_UUID,
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+                           BT_GATT_PERM_READ | BT_GATT_PERM_WRITE,
+                           read_channel_mask, write_channel_mask, NULL),
+
+    /* L2CAP PSM Characteristic (READ only) */
+    IF_ENABLED(CONFIG_ACCEL_L2CAP_STREAM,
+               (BT_GATT_CHARACTERISTIC(L2CAP_PSM_CHAR_UUID, BT_GATT_CHRC_READ,
+                                       BT_GATT_PERM_READ, read_l2cap_psm,
+                                       NULL, NULL),))
+
+    /* Link Profile Characteristic (READ only) */
+    BT_GATT_CHARACTERISTIC(LINK_PROFILE_CHAR_UUID, BT_GATT_CHRC_READ,
+                           BT_GATT_PERM_READ, read_link_profile, NULL, NULL),
+
+    /* History Characteristic (NOTIFY only, flash log backfill) */
+    IF_ENABLED(CONFIG_ACCEL_FLASH_LOG,
+               (BT_GATT_CHARACTERISTIC(HISTORY_CHAR_UUID, BT_GATT_CHRC_NOTIFY,
+                                       BT_GATT_PERM_NONE, NULL, NULL, NULL),
+                BT_GATT_CCC(history_ccc_changed,
+                            BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),))
+
+    /* Retransmit Request Characteristic (WRITE, with or without response) */
+    IF_ENABLED(CONFIG_ACCEL_RETX,
+               (BT_GATT_CHARACTERISTIC(RETX_CHAR_UUID,
+                                       BT_GATT_CHRC_WRITE |
+                                           BT_GATT_CHRC_WRITE_WITHOUT_RESP,
+                                       BT_GATT_PERM_WRITE, NULL,
+                                       write_retx_request, NULL),))
+
+    /* Spectrum Characteristic (NOTIFY only, on-device FFT) */
+    IF_ENABLED(CONFIG_ACCEL_SPECTRUM,
+               (BT_GATT_CHARACTERISTIC(SPECTRUM_CHAR_UUID, BT_GATT_CHRC_NOTIFY,
+                                       BT_GATT_PERM_NONE, NULL, NULL, NULL),
+                BT_GATT_CCC(spectrum_ccc_changed,
+                            BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),))
+
+    /* Features Characteristic (READ | NOTIFY, per-window statistics) */
+    IF_ENABLED(CONFIG_ACCEL_FEATURES,
+               (BT_GATT_CHARACTERISTIC(FEATURES_CHAR_UUID,
+                                       BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
+                                       BT_GATT_PERM_READ, read_features, NULL,
+                                       NULL),
+                BT_GATT_CCC(features_ccc_changed,
+                            BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),))
+
+    /* Trigger Characteristic (READ | WRITE | NOTIFY, event capture) */
+    IF_ENABLED(CONFIG_ACCEL_TRIGGER,
+               (BT_GATT_CHARACTERISTIC(TRIGGER_CHAR_UUID,
+                                       BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE |
+                                           BT_GATT_CHRC_NOTIFY,
+                                       BT_GATT_PERM_READ | BT_GATT_PERM_WRITE,
+                                       read_trigger, write_trigger, NULL),
+                BT_GATT_CCC(trigger_ccc_changed,
+                            BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),)));
 
 /*============================================================================
  * API Implementation
@@ -170,8 +465,31 @@ int accel_service_init(void) {
                                          ACCEL_DATA_CHAR_UUID);
   timestamp_attr = bt_gatt_find_by_uuid(accel_svc.attrs, accel_svc.attr_count,
                                         TIMESTAMP_CHAR_UUID);
-
-  if (!accel_data_attr || !timestamp_attr) {
+  bool found = accel_data_attr && timestamp_attr;
+
+  /* Optional characteristics exist only with their feature */
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+  history_attr = bt_gatt_find_by_uuid(accel_svc.attrs, accel_svc.attr_count,
+                                      HISTORY_CHAR_UUID);
+  found = found && history_attr;
+#endif
+#if defined(CONFIG_ACCEL_SPECTRUM)
+  spectrum_attr = bt_gatt_find_by_uuid(accel_svc.attrs, accel_svc.attr_count,
+                                       SPECTRUM_CHAR_UUID);
+  found = found && spectrum_attr;
+#endif
+#if defined(CONFIG_ACCEL_FEATURES)
+  features_attr = bt_gatt_find_by_uuid(accel_svc.attrs, accel_svc.attr_count,
+                                       FEATURES_CHAR_UUID);
+  found = found && features_attr;
+#endif
+#if defined(CONFIG_ACCEL_TRIGGER)
+  trigger_attr = bt_gatt_find_by_uuid(accel_svc.attrs, accel_svc.attr_count,
+                                      TRIGGER_CHAR_UUID);
+  found = found && trigger_attr;
+#endif
+
+  if (!found) {
     LOG_ERR("Failed to find GATT attributes");
     return -EINVAL;
   }
@@ -186,54 +504,248 @@ int accel_service_init(void) {
   return 0;
 }
 
+/* conn's own subscription to attr, or anyone's for conn == NULL */
+static bool notify_enabled(struct bt_conn *conn,
+                           const struct bt_gatt_attr *attr, bool any) {
+  if (!conn) {
+    return any;
+  }
+  return bt_gatt_is_subscribed(conn, attr, BT_GATT_CCC_NOTIFY);
+}
+
 int accel_service_notify_packet(struct bt_conn *conn,
                                 const accel_packet_t *packet) {
-  if (!data_notify_enabled) {
+  if (!notify_enabled(conn, accel_data_attr, data_notify_enabled)) {
     return -ENOTCONN;
   }
 
-  struct bt_conn *target = conn ? conn : current_conn;
-  if (!target) {
+  /* Packet already includes CRC, just send it */
+  return bt_gatt_notify(conn, accel_data_attr, packet, ACCEL_PACKET_SIZE);
+}
+
+int accel_service_notify_packet_cb(struct bt_conn *conn,
+                                   const accel_packet_t *packet,
+                                   bt_gatt_complete_func_t func,
+                                   void *user_data) {
+  if (!notify_enabled(conn, accel_data_attr, data_notify_enabled)) {
     return -ENOTCONN;
   }
 
-  /* Packet already includes CRC, just send it */
-  return bt_gatt_notify(target, accel_data_attr, packet, ACCEL_PACKET_SIZE);
+  /* Params are only read during the call, the stack keeps func/user_data */
+  struct bt_gatt_notify_params params = {
+      .attr = accel_data_attr,
+      .data = packet,
+      .len = ACCEL_PACKET_SIZE,
+      .func = func,
+      .user_data = user_data,
+  };
+
+  return bt_gatt_notify_cb(conn, &params);
 }
 
-int accel_service_notify_timestamp(struct bt_conn *conn, uint32_t uptime_ms) {
-  if (!timestamp_notify_enabled) {
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+int accel_service_notify_history(struct bt_conn *conn,
+                                 const accel_packet_t *packet,
+                                 bt_gatt_complete_func_t func,
+                                 void *user_data) {
+  if (!notify_enabled(conn, history_attr, history_notify_enabled)) {
     return -ENOTCONN;
   }
 
-  struct bt_conn *target = conn ? conn : current_conn;
-  if (!target) {
+  struct bt_gatt_notify_params params = {
+      .attr = history_attr,
+      .data = packet,
+      .len = ACCEL_PACKET_SIZE,
+      .func = func,
+      .user_data = user_data,
+  };
+
+  return bt_gatt_notify_cb(conn, &params);
+}
+#endif
+
+int accel_service_notify_packets(struct bt_conn *conn,
+                                 const accel_packet_t *packets, size_t count,
+                                 bool with_timestamp,
+                                 bt_gatt_complete_func_t func,
+                                 void *user_data) {
+  struct bt_gatt_notify_params params[ACCEL_NOTIFY_PACKETS_MAX + 1];
+  uint32_t uptime_ms;
+  uint16_t n = 0;
+
+  /* One connection's PDUs: coalescing needs a single peer */
+  if (!conn) {
+    return -EINVAL;
+  }
+  if (!bt_gatt_is_subscribed(conn, accel_data_attr, BT_GATT_CCC_NOTIFY)) {
     return -ENOTCONN;
   }
+  if (count == 0 || count > ACCEL_NOTIFY_PACKETS_MAX) {
+    return -EINVAL;
+  }
+
+  /* Same func and user_data on every entry, or the stack won't coalesce */
+  for (size_t i = 0; i < count; i++) {
+    params[n++] = (struct bt_gatt_notify_params){
+        .attr = accel_data_attr,
+        .data = &packets[i],
+        .len = ACCEL_PACKET_SIZE,
+        .func = func,
+        .user_data = user_data,
+    };
+  }
 
-  return bt_gatt_notify(target, timestamp_attr, &uptime_ms, sizeof(uptime_ms));
+  if (with_timestamp &&
+      bt_gatt_is_subscribed(conn, timestamp_attr, BT_GATT_CCC_NOTIFY)) {
+    uptime_ms = k_uptime_get_32();
+    params[n++] = (struct bt_gatt_notify_params){
+        .attr = timestamp_attr,
+        .data = &uptime_ms,
+        .len = sizeof(uptime_ms),
+        .func = func,
+        .user_data = user_data,
+    };
+  }
+
+#if defined(CONFIG_BT_GATT_NOTIFY_MULTIPLE)
+  /* Falls back to single notifications if the peer lacks the feature */
+  return bt_gatt_notify_multiple(conn, n, params);
+#else
+  for (uint16_t i = 0; i < n; i++) {
+    int err = bt_gatt_notify_cb(conn, &params[i]);
+
+    if (err) {
+      return err;
+    }
+  }
+  return 0;
+#endif
 }
 
-bool accel_service_data_notify_enabled(void) {
-  return data_notify_enabled && (current_conn != NULL);
+#if defined(CONFIG_ACCEL_SPECTRUM)
+int accel_service_notify_spectrum(struct bt_conn *conn,
+                                  const accel_spectrum_t *msg, uint16_t len) {
+  if (!notify_enabled(conn, spectrum_attr, spectrum_notify_enabled)) {
+    return -ENOTCONN;
+  }
+  if (len < ACCEL_SPECTRUM_HDR_SIZE || len > sizeof(*msg)) {
+    return -EINVAL;
+  }
+
+  return bt_gatt_notify(conn, spectrum_attr, msg, len);
 }
+#endif
 
-void accel_service_set_conn(struct bt_conn *conn) {
-  if (current_conn) {
-    bt_conn_unref(current_conn);
+#if defined(CONFIG_ACCEL_FEATURES)
+int accel_service_publish_features(const accel_features_t *rec,
+                                   uint16_t len) {
+  if (len < ACCEL_FEATURES_HDR_SIZE || len > sizeof(*rec)) {
+    return -EINVAL;
   }
-  current_conn = conn ? bt_conn_ref(conn) : NULL;
 
-  if (!current_conn) {
-    /* Reset CCC state on disconnect to ensure safety */
-    data_notify_enabled = false;
-    timestamp_notify_enabled = false;
-    LOG_INF("CCC state reset on disconnect");
+  memcpy(&features_latest, rec, len);
+  features_len = len;
+
+  if (!features_notify_enabled) {
+    return -ENOTCONN;
   }
+  return bt_gatt_notify(NULL, features_attr, rec, len);
 }
+#endif
+
+#if defined(CONFIG_ACCEL_TRIGGER)
+int accel_service_notify_trigger(struct bt_conn *conn,
+                                 const trigger_event_t *event) {
+  if (!notify_enabled(conn, trigger_attr, trigger_notify_enabled)) {
+    return -ENOTCONN;
+  }
+
+  return bt_gatt_notify(conn, trigger_attr, event, sizeof(*event));
+}
+#endif
+
+uint16_t accel_service_packets_per_pdu(struct bt_conn *conn) {
+#if defined(CONFIG_BT_GATT_NOTIFY_MULTIPLE)
+  if (!conn) {
+    return 1;
+  }
+
+  /* Leave room for the timestamp so it never pushes a packet out */
+  uint16_t mtu = bt_gatt_get_mtu(conn);
+  uint16_t room = (mtu > 1 + ACCEL_MULTI_TS_SIZE)
+                      ? mtu - 1 - ACCEL_MULTI_TS_SIZE
+                      : 0;
+  uint16_t n = room / (ACCEL_MULTI_ENTRY_HDR + ACCEL_PACKET_SIZE);
+
+  return CLAMP(n, 1, ACCEL_NOTIFY_PACKETS_MAX);
+#else
+  ARG_UNUSED(conn);
+  return 1;
+#endif
+}
+
+int accel_service_notify_timestamp(struct bt_conn *conn, uint32_t uptime_ms) {
+  if (!notify_enabled(conn, timestamp_attr, timestamp_notify_enabled)) {
+    return -ENOTCONN;
+  }
+
+  return bt_gatt_notify(conn, timestamp_attr, &uptime_ms, sizeof(uptime_ms));
+}
+
+bool accel_service_data_notify_enabled(struct bt_conn *conn) {
+  return conn &&
+         bt_gatt_is_subscribed(conn, accel_data_attr, BT_GATT_CCC_NOTIFY);
+}
+
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+bool accel_service_history_notify_enabled(struct bt_conn *conn) {
+  return conn && bt_gatt_is_subscribed(conn, history_attr, BT_GATT_CCC_NOTIFY);
+}
+#endif
+
+#if defined(CONFIG_ACCEL_SPECTRUM)
+bool accel_service_spectrum_notify_enabled(struct bt_conn *conn) {
+  return notify_enabled(conn, spectrum_attr, spectrum_notify_enabled);
+}
+#endif
 
 operating_mode_t accel_service_get_mode(void) { return current_mode; }
 
+void accel_service_set_rate_cb(accel_service_rate_cb_t cb) { rate_cb = cb; }
+
+void accel_service_set_sampling_rate(uint16_t rate_hz) {
+  sampling_rate = rate_hz;
+}
+
+void accel_service_set_chmask_cb(accel_service_chmask_cb_t cb) {
+  chmask_cb = cb;
+}
+
+void accel_service_set_channel_mask(uint8_t mask) { channel_mask = mask; }
+
+#if defined(CONFIG_ACCEL_RETX)
+void accel_service_set_retx_cb(accel_service_retx_cb_t cb) { retx_cb = cb; }
+#endif
+
+#if defined(CONFIG_ACCEL_TRIGGER)
+void accel_service_set_trigger_cb(accel_service_trigger_cb_t cb) {
+  trigger_cb = cb;
+}
+
+void accel_service_set_trigger_config(const trigger_config_t *cfg) {
+  trigger_config = *cfg;
+}
+#endif
+
+#if defined(CONFIG_ACCEL_L2CAP_STREAM)
+void accel_service_set_l2cap_psm(uint16_t psm) { l2cap_psm = psm; }
+#endif
+
+void accel_service_set_link_profile(struct bt_conn *conn,
+                                    const link_profile_t *profile) {
+  link_profiles[bt_conn_index(conn)] = *profile;
+}
+
 int accel_service_set_mode(operating_mode_t mode, bool power_detected) {
   /* Update static state for GATT callbacks */
   external_power_detected = power_detected;
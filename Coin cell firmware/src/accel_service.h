@@ -2,13 +2,16 @@
  * @file accel_service.h
  * @brief Coin-Cell Wireless Accelerometer GATT Service
  *
- * Architecture: Rev 3 - Burst mode with 10-byte samples, 24 samples/packet
+ * Architecture: Rev 3 - Burst mode with 10-byte samples, 24 samples/packet,
+ * or a packed layout carrying any subset of accel/temp/gyro channels
  */
 
 #ifndef ACCEL_SERVICE_H_
 #define ACCEL_SERVICE_H_
 
+#include <stddef.h>
 #include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
 #include <zephyr/types.h>
 
 #ifdef __cplusplus
@@ -31,7 +34,7 @@ extern "C" {
 #define TIMESTAMP_CHAR_UUID_VAL                                                \
   BT_UUID_128_ENCODE(0x12340002, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
 
-/* Sampling Rate Characteristic UUID: 12340003-... (READ) */
+/* Sampling Rate Characteristic UUID: 12340003-... (READ | WRITE) */
 #define SAMPLE_RATE_CHAR_UUID_VAL                                              \
   BT_UUID_128_ENCODE(0x12340003, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
 
@@ -43,6 +46,39 @@ extern "C" {
 #define OPERATING_MODE_CHAR_UUID_VAL                                           \
   BT_UUID_128_ENCODE(0x12340005, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
 
+/* Channel Mask Characteristic UUID: 12340006-... (READ | WRITE) */
+#define CHANNEL_MASK_CHAR_UUID_VAL                                             \
+  BT_UUID_128_ENCODE(0x12340006, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
+
+/* L2CAP PSM Characteristic UUID: 12340007-... (READ, if L2CAP_STREAM) */
+#define L2CAP_PSM_CHAR_UUID_VAL                                                \
+  BT_UUID_128_ENCODE(0x12340007, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
+
+/* Link Profile Characteristic UUID: 12340008-... (READ) */
+#define LINK_PROFILE_CHAR_UUID_VAL                                             \
+  BT_UUID_128_ENCODE(0x12340008, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
+
+/* History Characteristic UUID: 12340009-... (NOTIFY, if FLASH_LOG) */
+#define HISTORY_CHAR_UUID_VAL                                                  \
+  BT_UUID_128_ENCODE(0x12340009, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
+
+/* Retransmit Request Characteristic UUID: 1234000A-... (WRITE, if RETX) */
+#define RETX_CHAR_UUID_VAL                                                     \
+  BT_UUID_128_ENCODE(0x1234000A, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
+
+/* Spectrum Characteristic UUID: 1234000B-... (NOTIFY, if SPECTRUM) */
+#define SPECTRUM_CHAR_UUID_VAL                                                 \
+  BT_UUID_128_ENCODE(0x1234000B, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
+
+/* Features Characteristic UUID: 1234000C-... (READ | NOTIFY, if FEATURES) */
+#define FEATURES_CHAR_UUID_VAL                                                 \
+  BT_UUID_128_ENCODE(0x1234000C, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
+
+/* Trigger Characteristic UUID: 1234000D-... (READ | WRITE | NOTIFY),
+ * if TRIGGER */
+#define TRIGGER_CHAR_UUID_VAL                                                  \
+  BT_UUID_128_ENCODE(0x1234000D, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
+
 #define ACCEL_SERVICE_UUID BT_UUID_DECLARE_128(ACCEL_SERVICE_UUID_VAL)
 #define ACCEL_DATA_CHAR_UUID BT_UUID_DECLARE_128(ACCEL_DATA_CHAR_UUID_VAL)
 #define TIMESTAMP_CHAR_UUID BT_UUID_DECLARE_128(TIMESTAMP_CHAR_UUID_VAL)
@@ -50,6 +86,14 @@ extern "C" {
 #define SENSOR_META_CHAR_UUID BT_UUID_DECLARE_128(SENSOR_META_CHAR_UUID_VAL)
 #define OPERATING_MODE_CHAR_UUID                                               \
   BT_UUID_DECLARE_128(OPERATING_MODE_CHAR_UUID_VAL)
+#define CHANNEL_MASK_CHAR_UUID BT_UUID_DECLARE_128(CHANNEL_MASK_CHAR_UUID_VAL)
+#define L2CAP_PSM_CHAR_UUID BT_UUID_DECLARE_128(L2CAP_PSM_CHAR_UUID_VAL)
+#define LINK_PROFILE_CHAR_UUID BT_UUID_DECLARE_128(LINK_PROFILE_CHAR_UUID_VAL)
+#define HISTORY_CHAR_UUID BT_UUID_DECLARE_128(HISTORY_CHAR_UUID_VAL)
+#define RETX_CHAR_UUID BT_UUID_DECLARE_128(RETX_CHAR_UUID_VAL)
+#define SPECTRUM_CHAR_UUID BT_UUID_DECLARE_128(SPECTRUM_CHAR_UUID_VAL)
+#define FEATURES_CHAR_UUID BT_UUID_DECLARE_128(FEATURES_CHAR_UUID_VAL)
+#define TRIGGER_CHAR_UUID BT_UUID_DECLARE_128(TRIGGER_CHAR_UUID_VAL)
 
 /*============================================================================
  * Operating Modes
@@ -79,37 +123,183 @@ typedef struct __attribute__((packed)) {
 
 #define ACCEL_SAMPLE_SIZE sizeof(accel_sample_t) /* 10 */
 
+/*============================================================================
+ * Channel Mask
+ *
+ * Bit i selects the i-th 16-bit output register of the MPU6050 starting at
+ * ACCEL_XOUT_H, so bit order is also register (and packed data) order.
+ * ACCEL_CH_ACCEL_XYZ is sent in the Rev 3 layout, anything else packed.
+ *===========================================================================*/
+
+#define ACCEL_CH_AX BIT(0)
+#define ACCEL_CH_AY BIT(1)
+#define ACCEL_CH_AZ BIT(2)
+#define ACCEL_CH_TEMP BIT(3)
+#define ACCEL_CH_GX BIT(4)
+#define ACCEL_CH_GY BIT(5)
+#define ACCEL_CH_GZ BIT(6)
+
+#define ACCEL_CH_COUNT 7
+#define ACCEL_CH_ALL 0x7F
+#define ACCEL_CH_ACCEL_XYZ (ACCEL_CH_AX | ACCEL_CH_AY | ACCEL_CH_AZ)
+#define ACCEL_CH_GYRO_XYZ (ACCEL_CH_GX | ACCEL_CH_GY | ACCEL_CH_GZ)
+
+/**
+ * @brief Channel mask write handler, supplied by the application
+ * @param mask Requested ACCEL_CH_* mask
+ * @return 0 if the request was accepted (applied asynchronously),
+ *         -EINVAL if the mask is not supported, other negative errno on
+ *         failure
+ */
+typedef int (*accel_service_chmask_cb_t)(uint8_t mask);
+
 /*============================================================================
  * Packet Format (243 bytes)
  *
  * Per architecture Rev 3:
  * - 24 samples per packet (24 × 10 = 240 bytes)
- * - 1 byte header (burst_id)
+ * - 1 byte header (burst_id; ACCEL_BURST_ID_RETX marks a packet sent again
+ *   on request, see the retransmit characteristic below)
  * - 2 bytes CRC16
  * - Fits in BLE MTU (244 bytes)
+ *
+ * Packed layout (ACCEL_BURST_ID_PACKED set in burst_id):
+ * - Header describes the samples: channel mask, count, rate, first counter
+ *   and first timestamp. Counters are consecutive within a packet and
+ *   sample i was taken at base_timestamp_ms + i * 1000 / rate_hz.
+ * - Data is sample-major, each sample holding the masked channels in bit
+ *   order as int16 little-endian (2 bytes per set bit, no padding).
+ * - 116 single-channel, 38 three-channel or 16 seven-channel samples fit.
+ *
+ * v4 layout (CONFIG_ACCEL_PACKET_V4; ACCEL_BURST_ID_PACKED set, and
+ * ACCEL_PACKED_V4 set in the first payload byte):
+ * - The packed layout with a wide header: 32-bit first counter and the
+ *   first sample's time in µs of device uptime (wraps after ~71.6 min), so
+ *   no per-sample counter or timestamp is needed at a fixed ODR.
+ * - Used for every channel mask, accelerometer-only included: 38 XYZ
+ *   triplets per packet instead of 24 Rev 3 samples.
+ * - With CONFIG_ACCEL_CODEC, ACCEL_RATE_CODED is set in rate_hz and data[]
+ *   holds the lossless coding described in accel_codec.h instead, as many
+ *   samples as fit (at most 255). Each packet decodes on its own.
  *===========================================================================*/
 
 #define SAMPLES_PER_PACKET 24
 #define PACKET_PAYLOAD_SIZE (SAMPLES_PER_PACKET * ACCEL_SAMPLE_SIZE) /* 240 */
 
+#define ACCEL_BURST_ID_PACKED 0x80 /* burst_id flag: packed layout */
+#define ACCEL_BURST_ID_RETX 0x40   /* burst_id flag: retransmitted */
+#define ACCEL_BURST_ID_MASK 0x3F   /* burst_id sequence bits */
+
+#define PACKED_HEADER_SIZE 8
+#define PACKED_DATA_SIZE (PACKET_PAYLOAD_SIZE - PACKED_HEADER_SIZE) /* 232 */
+
 typedef struct __attribute__((packed)) {
-  uint8_t burst_id;                           /* 1 byte - burst sequence */
-  accel_sample_t samples[SAMPLES_PER_PACKET]; /* 240 bytes */
-  uint16_t crc16;                             /* 2 bytes - integrity check */
-} accel_packet_t;                             /* TOTAL = 243 bytes */
+  uint8_t channel_mask;       /* ACCEL_CH_* bits present in each sample */
+  uint8_t sample_count;       /* Valid samples in data[] */
+  uint16_t rate_hz;           /* Sampling rate the samples were taken at */
+  uint16_t base_counter;      /* sample_counter of the first sample */
+  uint16_t base_timestamp_ms; /* rel_timestamp_ms of the first sample */
+  uint8_t data[PACKED_DATA_SIZE];
+} accel_packed_payload_t; /* TOTAL = 240 bytes */
+
+#define ACCEL_PACKED_V4 0x80     /* channel_mask flag: v4 header */
+#define ACCEL_RATE_CODED 0x8000  /* v4 rate_hz flag: data[] is coded */
+
+#define V4_HEADER_SIZE 12
+#define V4_DATA_SIZE (PACKET_PAYLOAD_SIZE - V4_HEADER_SIZE) /* 228 */
+
+typedef struct __attribute__((packed)) {
+  uint8_t channel_mask;       /* ACCEL_CH_* bits, plus ACCEL_PACKED_V4 */
+  uint8_t sample_count;       /* Valid samples in data[] */
+  uint16_t rate_hz;           /* Sampling rate the samples were taken at */
+  uint32_t base_counter;      /* Sample counter of the first sample */
+  uint32_t base_timestamp_us; /* Device uptime of the first sample (µs) */
+  uint8_t data[V4_DATA_SIZE];
+} accel_v4_payload_t; /* TOTAL = 240 bytes */
+
+typedef struct __attribute__((packed)) {
+  uint8_t burst_id; /* 1 byte - burst sequence (+ ACCEL_BURST_ID_PACKED) */
+  union {
+    accel_sample_t samples[SAMPLES_PER_PACKET]; /* 240 bytes */
+    accel_packed_payload_t packed;              /* 240 bytes */
+    accel_v4_payload_t v4;                      /* 240 bytes */
+  };
+  uint16_t crc16; /* 2 bytes - integrity check */
+} accel_packet_t; /* TOTAL = 243 bytes */
 
 #define ACCEL_PACKET_SIZE sizeof(accel_packet_t) /* 243 */
 
+/**
+ * @brief First counter, sample count and counter mask of a packet's samples
+ *
+ * Counters are compared modulo each layout's own width: 16 bits for Rev 3
+ * and packed packets, 32 bits for v4.
+ */
+static inline void accel_packet_span(const accel_packet_t *pkt,
+                                     uint32_t *first, uint16_t *count,
+                                     uint32_t *mask) {
+  if (!(pkt->burst_id & ACCEL_BURST_ID_PACKED)) {
+    *first = pkt->samples[0].sample_counter;
+    *count = SAMPLES_PER_PACKET;
+    *mask = UINT16_MAX;
+  } else if (pkt->v4.channel_mask & ACCEL_PACKED_V4) {
+    *first = pkt->v4.base_counter;
+    *count = pkt->v4.sample_count;
+    *mask = UINT32_MAX;
+  } else {
+    *first = pkt->packed.base_counter;
+    *count = pkt->packed.sample_count;
+    *mask = UINT16_MAX;
+  }
+}
+
+/*============================================================================
+ * Coalesced Notifications
+ *
+ * With CONFIG_BT_GATT_NOTIFY_MULTIPLE and a peer that supports it, several
+ * packets (and a timestamp update) share one ATT_MULTIPLE_HANDLE_VALUE_NTF:
+ * 1 opcode byte, then handle (2) + length (2) + value per entry. An ATT MTU
+ * of 503 fits two packets plus the timestamp.
+ *===========================================================================*/
+
+#define ACCEL_MULTI_ENTRY_HDR 4 /* Handle + length */
+#define ACCEL_MULTI_TS_SIZE (ACCEL_MULTI_ENTRY_HDR + sizeof(uint32_t))
+#define ACCEL_NOTIFY_PACKETS_MAX 4 /* Packets per accel_service_notify_packets */
+
 /*============================================================================
  * Ring Buffer Configuration
  *
  * 1024 samples = 1.024 seconds @ 1kHz (FFT-friendly)
  * 43 packets per burst (ceil(1024/24))
+ * The ring holds whole packets: 64 slots cover 1024 Rev 3 samples
  *===========================================================================*/
 
 #define RING_BUFFER_SAMPLES 1024
 #define RING_BUFFER_MASK (RING_BUFFER_SAMPLES - 1) /* 0x3FF */
 #define PACKETS_PER_BURST 43                       /* ceil(1024/24) */
+#define PACKET_RING_SLOTS 64 /* Power of two >= PACKETS_PER_BURST */
+
+/*============================================================================
+ * Sampling Rate
+ *
+ * uint16 little-endian, in Hz. The MPU6050 runs at 1 kHz / (1 + SMPLRT_DIV)
+ * with the DLPF enabled, so only integer divisors of 1000 are accepted.
+ * With CONFIG_ACCEL_DECIMATE this is the rate sent, and read back as such:
+ * the sensor may run up to CONFIG_ACCEL_DECIMATE_MAX_FACTOR times faster,
+ * filtered down on the device.
+ *===========================================================================*/
+
+#define SAMPLING_RATE_MAX_HZ 1000
+#define SAMPLING_RATE_MIN_HZ 4 /* SMPLRT_DIV = 249 */
+
+/**
+ * @brief Sampling rate write handler, supplied by the application
+ * @param rate_hz Requested rate in Hz
+ * @return 0 if the request was accepted (applied asynchronously),
+ *         -EINVAL if the rate is not supported, other negative errno on
+ *         failure
+ */
+typedef int (*accel_service_rate_cb_t)(uint16_t rate_hz);
 
 /*============================================================================
  * Sensor Metadata (TEDS-like)
@@ -121,6 +311,199 @@ typedef struct __attribute__((packed)) {
   char unit[8];
 } sensor_metadata_t;
 
+/*============================================================================
+ * Retransmit Request
+ *
+ * Written by a central that found a gap in the sample counters: uint32
+ * first missing counter, then uint16 sample count, little-endian (6 bytes).
+ * Rev 3 and packed packets match on the low 16 bits of the counter. Retained
+ * packets holding any of the samples are sent again on the data
+ * characteristic with ACCEL_BURST_ID_RETX set.
+ *===========================================================================*/
+
+#define RETX_REQUEST_SIZE 6
+
+/**
+ * @brief Retransmit request handler, supplied by the application
+ * @param conn Central that asked, and the one to resend to
+ * @param first_counter Sample counter of the first missing sample
+ * @param count Missing samples
+ * @return 0 if queued, -EINVAL if the range is empty, other negative errno
+ *         if the request cannot be taken now
+ */
+typedef int (*accel_service_retx_cb_t)(struct bt_conn *conn,
+                                       uint32_t first_counter,
+                                       uint16_t count);
+
+/*============================================================================
+ * Spectrum (CONFIG_ACCEL_SPECTRUM)
+ *
+ * One Hann-windowed ACCEL_SPECTRUM_N point real FFT per accelerometer axis
+ * in the channel mask, over consecutive non-overlapping blocks of samples.
+ * Bin k is at k * rate_hz / ACCEL_SPECTRUM_N Hz. Values are sinusoid
+ * amplitudes in raw counts (window gain removed; bin 0 is the mean), times
+ * 2^shift: each axis of a block uses the largest shift that keeps its
+ * maximum within 16 bits.
+ *
+ * Full spectrum: ACCEL_SPECTRUM_BINS bins (DC up to just below Nyquist) per
+ * axis, in notifications of up to ACCEL_SPECTRUM_CHUNK_BINS starting at
+ * first_bin. Needs an ATT MTU of 240 or more.
+ * Peaks (ACCEL_SPECTRUM_PEAKS set in axis): the strongest local maxima,
+ * strongest first, one notification per axis. Frequency and amplitude are
+ * interpolated between bins.
+ *
+ * All fields little-endian.
+ *===========================================================================*/
+
+#define ACCEL_SPECTRUM_N RING_BUFFER_SAMPLES  /* Samples per FFT block */
+#define ACCEL_SPECTRUM_BINS (ACCEL_SPECTRUM_N / 2)
+#define ACCEL_SPECTRUM_CHUNK_BINS 112 /* Per notification */
+#define ACCEL_SPECTRUM_PEAKS_MAX 32   /* Per notification */
+
+#define ACCEL_SPECTRUM_AXIS_MASK 0x03 /* axis: 0-2 = X, Y, Z */
+#define ACCEL_SPECTRUM_PEAKS 0x80     /* axis: peaks instead of bins */
+
+typedef struct __attribute__((packed)) {
+  uint16_t freq_chz;  /* 0.01 Hz */
+  uint16_t amplitude; /* Counts * 2^shift */
+} accel_spectrum_peak_t;
+
+typedef struct __attribute__((packed)) {
+  uint8_t axis;          /* Axis index | ACCEL_SPECTRUM_PEAKS */
+  uint8_t shift;         /* Values are scaled by 2^shift */
+  uint8_t count;         /* Bins or peaks that follow */
+  uint16_t block;        /* Block sequence number, wraps */
+  uint16_t rate_hz;      /* Sampling rate of the block */
+  uint16_t first_bin;    /* Bin of bins[0], 0 for peaks */
+  uint32_t base_counter; /* Sample counter of the block's first sample */
+  union {
+    uint16_t bins[ACCEL_SPECTRUM_CHUNK_BINS];
+    accel_spectrum_peak_t peaks[ACCEL_SPECTRUM_PEAKS_MAX];
+  };
+} accel_spectrum_t; /* 13-byte header + up to 224 bytes */
+
+#define ACCEL_SPECTRUM_HDR_SIZE offsetof(accel_spectrum_t, bins)
+
+/*============================================================================
+ * Features (CONFIG_ACCEL_FEATURES)
+ *
+ * One record per window of CONFIG_ACCEL_FEATURES_WINDOW_MS, computed on the
+ * device from every sample read, whether or not it is streamed. It carries
+ * one accel_feature_axis_t per accelerometer axis in the channel mask, in
+ * X, Y, Z order. Values are in raw counts unless noted; rms and peak are
+ * taken about the window mean, so gravity drops out. Band RMS comes from a
+ * 2nd-order band-pass per band, 0xFFFF if the band is not below Nyquist.
+ *
+ * Notified at the end of each window and readable (latest record) at any
+ * time. All fields little-endian.
+ *===========================================================================*/
+
+#define ACCEL_FEATURE_BANDS 3
+#define ACCEL_FEATURE_BAND_EDGES_HZ {2, 8, 20, 44} /* Contiguous bands */
+#define ACCEL_FEATURE_NA 0xFFFF
+
+typedef struct __attribute__((packed)) {
+  int16_t mean;
+  int16_t min;
+  int16_t max;
+  uint16_t rms;       /* Standard deviation */
+  uint16_t peak;      /* Largest deviation from the mean */
+  uint16_t crest_q8;  /* peak / rms, Q8.8 */
+  int16_t skew_q8;    /* Skewness, Q8.8 */
+  uint16_t kurt_q8;   /* Kurtosis (3 = Gaussian), Q8.8 */
+  uint16_t crossings; /* Crossings of the running mean */
+  uint16_t band_rms[ACCEL_FEATURE_BANDS];
+} accel_feature_axis_t; /* TOTAL = 24 bytes */
+
+typedef struct __attribute__((packed)) {
+  uint16_t window;       /* Window sequence number, wraps */
+  uint32_t base_counter; /* Sample counter of the first sample */
+  uint16_t samples;      /* Samples in the window */
+  uint16_t rate_hz;      /* Sampling rate of the window */
+  uint8_t axes;          /* ACCEL_CH_AX/AY/AZ: one entry per bit set */
+  uint8_t bands;         /* ACCEL_FEATURE_BANDS */
+  accel_feature_axis_t axis[3];
+} accel_features_t; /* 12-byte header + 24 bytes per axis */
+
+#define ACCEL_FEATURES_HDR_SIZE offsetof(accel_features_t, axis)
+
+/*============================================================================
+ * Event Trigger (CONFIG_ACCEL_TRIGGER)
+ *
+ * Written by a central to arm event-triggered capture, read back as in
+ * effect, little-endian. While armed, the packet ring only keeps the last
+ * pre_ms of packets and nothing is sent. When the condition holds on any
+ * watched axis, a trigger_event_t is notified on this characteristic, then
+ * the packets from pre_ms before the trigger sample to post_ms after it go
+ * out as usual on the data characteristic (or L2CAP). Another event during
+ * a capture extends it. Conditions, with dc a 1 s moving average of the
+ * axis (gravity):
+ * - TRIGGER_LEVEL: |x - dc| >= threshold
+ * - TRIGGER_SLOPE: |x[n] - x[n - 1]| >= threshold (counts per sample)
+ * - TRIGGER_RMS: RMS of x - dc over window_ms (exponentially weighted)
+ *   >= threshold
+ * - TRIGGER_BAND: as TRIGGER_RMS, of x band-passed to band_lo_hz-band_hi_hz
+ * A condition must clear before it fires again. TRIGGER_OFF streams
+ * everything, as without the trigger.
+ *===========================================================================*/
+
+typedef enum {
+  TRIGGER_OFF = 0x00,
+  TRIGGER_LEVEL = 0x01,
+  TRIGGER_SLOPE = 0x02,
+  TRIGGER_RMS = 0x03,
+  TRIGGER_BAND = 0x04,
+} trigger_type_t;
+
+#define TRIGGER_PRE_MAX_MS 1000 /* Pre-trigger history the ring can hold */
+
+typedef struct __attribute__((packed)) {
+  uint8_t type;        /* trigger_type_t */
+  uint8_t axes;        /* ACCEL_CH_AX/AY/AZ watched */
+  uint16_t threshold;  /* Raw counts */
+  uint16_t pre_ms;     /* History sent before the trigger sample */
+  uint16_t post_ms;    /* Samples sent after it */
+  uint16_t window_ms;  /* TRIGGER_RMS and TRIGGER_BAND averaging */
+  uint16_t band_lo_hz; /* TRIGGER_BAND only */
+  uint16_t band_hi_hz; /* TRIGGER_BAND only, below Nyquist */
+} trigger_config_t;    /* TOTAL = 14 bytes */
+
+/* Notified when a capture starts or is extended. Rev 3 and packed packets
+ * carry the low 16 bits of these counters. */
+typedef struct __attribute__((packed)) {
+  uint32_t trigger_counter; /* Sample that met the condition */
+  uint32_t first_counter;   /* First sample of the capture */
+  uint32_t end_counter;     /* One past its last sample */
+} trigger_event_t;          /* TOTAL = 12 bytes */
+
+/**
+ * @brief Trigger configuration handler, supplied by the application
+ * @param cfg Configuration written by a central
+ * @return 0 if applied, -EINVAL if it is not valid, other negative errno on
+ *         failure
+ */
+typedef int (*accel_service_trigger_cb_t)(const trigger_config_t *cfg);
+
+/*============================================================================
+ * Link Profile
+ *
+ * Kept per connection: each central reads the parameters of its own link.
+ *===========================================================================*/
+
+/* Negotiated link parameters, little-endian as read by the central */
+typedef struct __attribute__((packed)) {
+  uint8_t tx_phy;          /* BT_GAP_LE_PHY_* */
+  uint8_t rx_phy;          /* BT_GAP_LE_PHY_* */
+  uint16_t tx_max_len;     /* LL payload octets (27-251) */
+  uint16_t rx_max_len;     /* LL payload octets (27-251) */
+  uint16_t tx_max_time_us; /* LL TX time per packet */
+  uint16_t interval;       /* 1.25 ms units */
+  uint16_t latency;        /* Connection events */
+  uint16_t timeout;        /* 10 ms units */
+  uint16_t att_mtu;        /* Negotiated ATT MTU */
+  uint8_t param_set;       /* Granted fallback set, 0xFF = none */
+} link_profile_t;          /* TOTAL = 19 bytes */
+
 /*============================================================================
  * API Functions
  *===========================================================================*/
@@ -140,6 +523,97 @@ int accel_service_init(void);
 int accel_service_notify_packet(struct bt_conn *conn,
                                 const accel_packet_t *packet);
 
+/**
+ * @brief Send a burst packet and report when the stack is done with it
+ *
+ * func runs once the notification has been sent, or dropped on disconnect;
+ * it is not called if this returns an error.
+ * @param conn Connection object (NULL for all connections)
+ * @param packet Pointer to packet structure (copied before return)
+ * @param func Completion callback, called from the BT stack
+ * @param user_data Passed to func
+ * @return 0 on success, negative errno on failure
+ */
+int accel_service_notify_packet_cb(struct bt_conn *conn,
+                                   const accel_packet_t *packet,
+                                   bt_gatt_complete_func_t func,
+                                   void *user_data);
+
+/**
+ * @brief Send consecutive burst packets, coalesced when the peer allows it
+ *
+ * Sent as one ATT_MULTIPLE_HANDLE_VALUE_NTF per MTU worth of entries if the
+ * peer enabled multiple notifications, as single notifications otherwise.
+ * All entries share func and user_data (required for coalescing), so func
+ * runs once per PDU actually sent: once or up to count + 1 times.
+ * @param conn Connection to send on (not NULL)
+ * @param packets First of count packets, contiguous (copied before return)
+ * @param count 1 to ACCEL_NOTIFY_PACKETS_MAX
+ * @param with_timestamp Append a timestamp update if it is subscribed
+ * @param func Completion callback, called from the BT stack
+ * @param user_data Passed to func
+ * @return 0 on success, negative errno on failure
+ */
+int accel_service_notify_packets(struct bt_conn *conn,
+                                 const accel_packet_t *packets, size_t count,
+                                 bool with_timestamp,
+                                 bt_gatt_complete_func_t func,
+                                 void *user_data);
+
+/**
+ * @brief Send a packet from the flash log on the history characteristic
+ *
+ * Same packet layout as the data characteristic. func follows the rules of
+ * accel_service_notify_packet_cb().
+ * @param conn Connection object (NULL for all connections)
+ * @param packet Pointer to packet structure (copied before return)
+ * @param func Completion callback, called from the BT stack
+ * @param user_data Passed to func
+ * @return 0 on success, negative errno on failure
+ */
+int accel_service_notify_history(struct bt_conn *conn,
+                                 const accel_packet_t *packet,
+                                 bt_gatt_complete_func_t func,
+                                 void *user_data);
+
+/**
+ * @brief Send one part of a spectrum on the spectrum characteristic
+ * @param conn Connection object (NULL for all connections)
+ * @param msg Header and values (copied before return)
+ * @param len ACCEL_SPECTRUM_HDR_SIZE plus the bytes of msg->count entries
+ * @return 0 on success, negative errno on failure
+ */
+int accel_service_notify_spectrum(struct bt_conn *conn,
+                                  const accel_spectrum_t *msg, uint16_t len);
+
+/**
+ * @brief Publish a feature record
+ *
+ * Kept for reads of the features characteristic and notified to every
+ * subscribed central.
+ * @param rec Record (copied before return)
+ * @param len ACCEL_FEATURES_HDR_SIZE plus 24 bytes per axis in rec->axes
+ * @return 0 on success, -ENOTCONN if nobody is subscribed, negative errno
+ *         on failure
+ */
+int accel_service_publish_features(const accel_features_t *rec, uint16_t len);
+
+/**
+ * @brief Announce a capture on the trigger characteristic
+ * @param conn Connection object (NULL for all connections)
+ * @param event Trigger and capture counters
+ * @return 0 on success, negative errno on failure
+ */
+int accel_service_notify_trigger(struct bt_conn *conn,
+                                 const trigger_event_t *event);
+
+/**
+ * @brief Packets one coalesced PDU holds at a connection's MTU
+ * @param conn Connection object
+ * @return 1 to ACCEL_NOTIFY_PACKETS_MAX (1 without NOTIFY_MULTIPLE)
+ */
+uint16_t accel_service_packets_per_pdu(struct bt_conn *conn);
+
 /**
  * @brief Send timestamp notification
  * @param conn Connection object (NULL for all connections)
@@ -149,16 +623,25 @@ int accel_service_notify_packet(struct bt_conn *conn,
 int accel_service_notify_timestamp(struct bt_conn *conn, uint32_t uptime_ms);
 
 /**
- * @brief Check if notifications are enabled for acceleration data
- * @return true if enabled, false otherwise
+ * @brief Check if a central enabled notifications for acceleration data
+ * @param conn Connection object
+ * @return true if enabled on conn, false otherwise (or for NULL)
  */
-bool accel_service_data_notify_enabled(void);
+bool accel_service_data_notify_enabled(struct bt_conn *conn);
 
 /**
- * @brief Set the current connection reference
+ * @brief Check if a central wants the flash log sent back
  * @param conn Connection object
+ * @return true if history notifications are enabled on conn
  */
-void accel_service_set_conn(struct bt_conn *conn);
+bool accel_service_history_notify_enabled(struct bt_conn *conn);
+
+/**
+ * @brief Check if a central wants spectra
+ * @param conn Connection object, or NULL for any central
+ * @return true if spectrum notifications are enabled
+ */
+bool accel_service_spectrum_notify_enabled(struct bt_conn *conn);
 
 /**
  * @brief Get current operating mode
@@ -174,6 +657,62 @@ operating_mode_t accel_service_get_mode(void);
  */
 int accel_service_set_mode(operating_mode_t mode, bool external_power_detected);
 
+/**
+ * @brief Register the handler for writes to the sampling rate characteristic
+ * @param cb Handler, or NULL to make the characteristic reject writes
+ */
+void accel_service_set_rate_cb(accel_service_rate_cb_t cb);
+
+/**
+ * @brief Publish the sampling rate currently in effect
+ * @param rate_hz Effective sampling rate in Hz
+ */
+void accel_service_set_sampling_rate(uint16_t rate_hz);
+
+/**
+ * @brief Register the handler for writes to the channel mask characteristic
+ * @param cb Handler, or NULL to make the characteristic reject writes
+ */
+void accel_service_set_chmask_cb(accel_service_chmask_cb_t cb);
+
+/**
+ * @brief Publish the channel mask currently in effect
+ * @param mask Effective ACCEL_CH_* mask
+ */
+void accel_service_set_channel_mask(uint8_t mask);
+
+/**
+ * @brief Register the handler for writes to the retransmit characteristic
+ * @param cb Handler, or NULL to make the characteristic reject writes
+ */
+void accel_service_set_retx_cb(accel_service_retx_cb_t cb);
+
+/**
+ * @brief Register the handler for writes to the trigger characteristic
+ * @param cb Handler, or NULL to make the characteristic reject writes
+ */
+void accel_service_set_trigger_cb(accel_service_trigger_cb_t cb);
+
+/**
+ * @brief Publish the trigger configuration currently in effect
+ * @param cfg Configuration (copied)
+ */
+void accel_service_set_trigger_config(const trigger_config_t *cfg);
+
+/**
+ * @brief Publish the PSM of the L2CAP stream (CONFIG_ACCEL_L2CAP_STREAM)
+ * @param psm Dynamic PSM the stream listens on, read as uint16 LE
+ */
+void accel_service_set_l2cap_psm(uint16_t psm);
+
+/**
+ * @brief Publish the negotiated link profile of a connection
+ * @param conn Connection the parameters belong to
+ * @param profile Current link parameters (copied)
+ */
+void accel_service_set_link_profile(struct bt_conn *conn,
+                                    const link_profile_t *profile);
+
 /**
  * @brief Update external power state for mode switching permission
  * @param detected true if USB/external power is present
@@ -0,0 +1,306 @@
+/**
+ * @file acq_dppi.c
+ * @brief Hardware-triggered MPU6050 acquisition (TIMER + DPPI + TWIM EasyDMA)
+ *
+ * Signal chain (no CPU involvement per sample):
+ *
+ *   TIMER1 COMPARE0 --DPPI--> TWIM STARTTX   (1 byte: start register)
+ *   TWIM LASTTX -> STARTRX, LASTRX -> STOP   (shorts: 6-byte read)
+ *   TWIM STOPPED    --DPPI--> TIMER2 COUNT
+ *   TIMER2 COMPARE0 (N samples) -> IRQ       (one wakeup per block)
+ *
+ * RXD.LIST = ArrayList advances RXD.PTR by one frame after every read, so
+ * the two halves of acq_buf fill back-to-back (each BLOCK_SAMPLES frames of
+ * the current frame size). The block IRQ only has to rewind RXD.PTR after
+ * the second half, with a full sample period to do it.
+ */
+
+#include <hal/nrf_timer.h>
+#include <hal/nrf_twim.h>
+#include <helpers/nrfx_gppi.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/irq.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "acq_dppi.h"
+
+LOG_MODULE_REGISTER(acq_dppi, LOG_LEVEL_INF);
+
+/*============================================================================
+ * Configuration
+ *===========================================================================*/
+
+#define BLOCK_SAMPLES CONFIG_ACCEL_DPPI_BLOCK_SAMPLES
+#define BLOCK_BYTES_MAX (BLOCK_SAMPLES * ACQ_DPPI_FRAME_MAX)
+
+/* TWIM shared with the Zephyr I2C driver (i2c1 in the overlay) */
+#define ACQ_TWIM ((NRF_TWIM_Type *)DT_REG_ADDR(DT_NODELABEL(i2c1)))
+
+/* Reserved for this backend: 1 MHz sample pacing and sample counting */
+#define PACING_TIMER NRF_TIMER1
+#define COUNT_TIMER NRF_TIMER2
+#define COUNT_TIMER_IRQn TIMER2_IRQn
+#define COUNT_TIMER_IRQ_PRIO 1
+
+#define PACING_TIMER_PRESCALER 4 /* 16 MHz / 2^4 = 1 MHz, 1 tick = 1 µs */
+
+/*============================================================================
+ * State Variables
+ *===========================================================================*/
+
+/* EasyDMA can only reach RAM: the TX register byte must not be const */
+static uint8_t tx_reg;
+static uint8_t twim_addr;
+static uint8_t frame_bytes;
+static uint8_t acq_buf[2 * BLOCK_BYTES_MAX] __aligned(4);
+
+static uint32_t period_us;
+static uint8_t ch_trigger; /* TIMER1 COMPARE0 -> TWIM STARTTX */
+static uint8_t ch_count;   /* TWIM STOPPED -> TIMER2 COUNT */
+static bool initialized = false;
+static volatile bool running = false;
+
+/* Blocks are numbered by the ISR as the hardware completes them, from boot
+ * and across restarts, so the reader sees any it missed as a gap */
+static volatile uint8_t filling_half = 0;
+static volatile uint8_t ready_half = 0;
+static volatile uint32_t ready_seq = 0;    /* Newest completed block */
+static volatile uint32_t next_seq = 0;     /* Next block to complete */
+static volatile uint32_t released_seq = 0; /* Blocks before it are free */
+static volatile bool wake_requested = false;
+static uint32_t start_seq = 0;     /* First block since start */
+static uint64_t start_us = 0;      /* Uptime of the first sample */
+static uint32_t overrun_count = 0;
+
+K_SEM_DEFINE(acq_block_sem, 0, 1);
+
+/*============================================================================
+ * Block-Complete ISR
+ *===========================================================================*/
+
+static void count_timer_isr(const void *arg) {
+  ARG_UNUSED(arg);
+
+  if (!nrf_timer_event_check(COUNT_TIMER, NRF_TIMER_EVENT_COMPARE0)) {
+    return;
+  }
+  nrf_timer_event_clear(COUNT_TIMER, NRF_TIMER_EVENT_COMPARE0);
+
+  uint8_t done = filling_half;
+  filling_half ^= 1;
+  if (filling_half == 0) {
+    /* List pointer ran off the end of half 1 - rewind to half 0 */
+    nrf_twim_rx_buffer_set(ACQ_TWIM, acq_buf, frame_bytes);
+  }
+
+  uint32_t seq = next_seq++;
+
+  if ((int32_t)(seq - released_seq) > 0) {
+    /* Previous block not released (still read, or never taken): the half
+     * it occupies is being refilled from now on */
+    overrun_count++;
+  }
+  ready_half = done;
+  ready_seq = seq;
+  k_sem_give(&acq_block_sem);
+}
+
+/*============================================================================
+ * Peripheral Programming
+ *===========================================================================*/
+
+static void program_twim(void) {
+  nrf_twim_int_disable(ACQ_TWIM, NRF_TWIM_ALL_INTS_MASK);
+  nrf_twim_address_set(ACQ_TWIM, twim_addr);
+
+  nrf_twim_tx_buffer_set(ACQ_TWIM, &tx_reg, sizeof(tx_reg));
+  nrf_twim_tx_list_disable(ACQ_TWIM); /* Same register byte every time */
+  nrf_twim_rx_buffer_set(ACQ_TWIM, acq_buf, frame_bytes);
+  nrf_twim_rx_list_enable(ACQ_TWIM); /* RXD.PTR += MAXCNT per read */
+
+  nrf_twim_shorts_set(ACQ_TWIM, NRF_TWIM_SHORT_LASTTX_STARTRX_MASK |
+                                    NRF_TWIM_SHORT_LASTRX_STOP_MASK);
+  nrf_twim_event_clear(ACQ_TWIM, NRF_TWIM_EVENT_STOPPED);
+  nrf_twim_event_clear(ACQ_TWIM, NRF_TWIM_EVENT_ERROR);
+  nrf_twim_enable(ACQ_TWIM);
+}
+
+static void release_twim(void) {
+  /* Leave the peripheral as the I2C driver expects to find it */
+  nrf_twim_shorts_set(ACQ_TWIM, 0);
+  nrf_twim_tx_list_disable(ACQ_TWIM);
+  nrf_twim_rx_list_disable(ACQ_TWIM);
+  nrf_twim_event_clear(ACQ_TWIM, NRF_TWIM_EVENT_STOPPED);
+  nrf_twim_event_clear(ACQ_TWIM, NRF_TWIM_EVENT_ERROR);
+}
+
+static void program_timers(void) {
+  nrf_timer_task_trigger(PACING_TIMER, NRF_TIMER_TASK_STOP);
+  nrf_timer_task_trigger(PACING_TIMER, NRF_TIMER_TASK_CLEAR);
+  nrf_timer_mode_set(PACING_TIMER, NRF_TIMER_MODE_TIMER);
+  nrf_timer_bit_width_set(PACING_TIMER, NRF_TIMER_BIT_WIDTH_32);
+  nrf_timer_prescaler_set(PACING_TIMER, PACING_TIMER_PRESCALER);
+  nrf_timer_cc_set(PACING_TIMER, NRF_TIMER_CC_CHANNEL0, period_us);
+  nrf_timer_shorts_enable(PACING_TIMER, NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK);
+
+  nrf_timer_task_trigger(COUNT_TIMER, NRF_TIMER_TASK_STOP);
+  nrf_timer_task_trigger(COUNT_TIMER, NRF_TIMER_TASK_CLEAR);
+  nrf_timer_mode_set(COUNT_TIMER, NRF_TIMER_MODE_COUNTER);
+  nrf_timer_bit_width_set(COUNT_TIMER, NRF_TIMER_BIT_WIDTH_16);
+  nrf_timer_cc_set(COUNT_TIMER, NRF_TIMER_CC_CHANNEL0, BLOCK_SAMPLES);
+  nrf_timer_shorts_enable(COUNT_TIMER, NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK);
+  nrf_timer_event_clear(COUNT_TIMER, NRF_TIMER_EVENT_COMPARE0);
+  nrf_timer_int_enable(COUNT_TIMER, NRF_TIMER_INT_COMPARE0_MASK);
+}
+
+/*============================================================================
+ * API Implementation
+ *===========================================================================*/
+
+int acq_dppi_init(uint8_t i2c_addr, uint8_t start_reg, uint8_t frame_size,
+                  uint32_t sample_period_us) {
+  if (initialized) {
+    return -EALREADY;
+  }
+  if (frame_size == 0 || frame_size > ACQ_DPPI_FRAME_MAX) {
+    return -EINVAL;
+  }
+
+  twim_addr = i2c_addr;
+  tx_reg = start_reg;
+  frame_bytes = frame_size;
+  period_us = sample_period_us;
+
+  if (nrfx_gppi_channel_alloc(&ch_trigger) != NRFX_SUCCESS ||
+      nrfx_gppi_channel_alloc(&ch_count) != NRFX_SUCCESS) {
+    LOG_ERR("No free DPPI channels");
+    return -EBUSY;
+  }
+
+  nrfx_gppi_channel_endpoints_setup(
+      ch_trigger,
+      nrf_timer_event_address_get(PACING_TIMER, NRF_TIMER_EVENT_COMPARE0),
+      nrf_twim_task_address_get(ACQ_TWIM, NRF_TWIM_TASK_STARTTX));
+  nrfx_gppi_channel_endpoints_setup(
+      ch_count, nrf_twim_event_address_get(ACQ_TWIM, NRF_TWIM_EVENT_STOPPED),
+      nrf_timer_task_address_get(COUNT_TIMER, NRF_TIMER_TASK_COUNT));
+
+  IRQ_CONNECT(COUNT_TIMER_IRQn, COUNT_TIMER_IRQ_PRIO, count_timer_isr, NULL,
+              0);
+  irq_enable(COUNT_TIMER_IRQn);
+
+  initialized = true;
+  LOG_INF("DPPI acquisition ready: %u us period, %u-sample blocks of %u bytes",
+          period_us, BLOCK_SAMPLES, frame_bytes);
+  return 0;
+}
+
+int acq_dppi_start(void) {
+  if (!initialized) {
+    return -EINVAL;
+  }
+  if (running) {
+    return -EALREADY;
+  }
+
+  filling_half = 0;
+  start_seq = next_seq;
+  released_seq = next_seq;
+  k_sem_reset(&acq_block_sem);
+
+  program_twim();
+  program_timers();
+  nrfx_gppi_channels_enable(BIT(ch_trigger) | BIT(ch_count));
+
+  nrf_timer_task_trigger(COUNT_TIMER, NRF_TIMER_TASK_START);
+  nrf_timer_task_trigger(PACING_TIMER, NRF_TIMER_TASK_START);
+
+  /* First read is triggered one period after the pacing timer starts */
+  start_us = k_ticks_to_us_floor64(k_uptime_ticks()) + period_us;
+  running = true;
+  return 0;
+}
+
+void acq_dppi_stop(void) {
+  if (!running) {
+    return;
+  }
+  running = false;
+
+  nrf_timer_task_trigger(PACING_TIMER, NRF_TIMER_TASK_STOP);
+  nrfx_gppi_channels_disable(BIT(ch_trigger) | BIT(ch_count));
+
+  /* Let an in-flight read finish before giving the TWIM back */
+  k_busy_wait(2 * ACQ_DPPI_FRAME_MAX * 25 + 50);
+
+  nrf_timer_task_trigger(COUNT_TIMER, NRF_TIMER_TASK_STOP);
+  nrf_timer_int_disable(COUNT_TIMER, NRF_TIMER_INT_COMPARE0_MASK);
+  release_twim();
+}
+
+int acq_dppi_set_period(uint32_t sample_period_us) {
+  if (running) {
+    return -EBUSY;
+  }
+
+  period_us = sample_period_us;
+  return 0;
+}
+
+int acq_dppi_set_frame(uint8_t start_reg, uint8_t frame_size) {
+  if (running) {
+    return -EBUSY;
+  }
+  if (frame_size == 0 || frame_size > ACQ_DPPI_FRAME_MAX) {
+    return -EINVAL;
+  }
+
+  tx_reg = start_reg;
+  frame_bytes = frame_size;
+  return 0;
+}
+
+void acq_dppi_wake(void) {
+  wake_requested = true;
+  k_sem_give(&acq_block_sem);
+}
+
+int acq_dppi_wait_block(const uint8_t **block, uint64_t *first_sample_us,
+                        uint32_t *seq) {
+  /* Idle until sampling starts, then watch for a stalled transfer chain */
+  k_timeout_t timeout =
+      running ? K_USEC(2 * BLOCK_SAMPLES * period_us) : K_FOREVER;
+
+  if (k_sem_take(&acq_block_sem, timeout) != 0) {
+    LOG_WRN("DPPI acquisition stalled, restarting");
+    acq_dppi_stop();
+    acq_dppi_start();
+    return -EIO;
+  }
+
+  if (wake_requested) {
+    wake_requested = false;
+    return -EAGAIN;
+  }
+
+  /* Half and number of the same block, even if another completes now */
+  unsigned int key = irq_lock();
+  uint8_t half = ready_half;
+  uint32_t n = ready_seq;
+
+  irq_unlock(key);
+
+  *block = &acq_buf[half * BLOCK_SAMPLES * frame_bytes];
+  *first_sample_us =
+      start_us + (uint64_t)(n - start_seq) * BLOCK_SAMPLES * period_us;
+  *seq = n;
+  return 0;
+}
+
+void acq_dppi_release_block(uint32_t seq) {
+  /* Only ever moves forward: a newer block's state is left alone */
+  released_seq = seq + 1;
+}
+
+uint32_t acq_dppi_overruns(void) { return overrun_count; }
@@ -0,0 +1,112 @@
+/**
+ * @file acq_dppi.h
+ * @brief Hardware-triggered MPU6050 acquisition (TIMER + DPPI + TWIM EasyDMA)
+ *
+ * A TIMER compare starts a pre-programmed TWIM read through DPPI for every
+ * sample. EasyDMA array-list mode writes the 6-byte frames back-to-back into
+ * a double-buffered RAM block, and the CPU only wakes once per block.
+ */
+
+#ifndef ACQ_DPPI_H_
+#define ACQ_DPPI_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest raw frame (ACCEL_XOUT_H..GYRO_ZOUT_L), big-endian as read */
+#define ACQ_DPPI_FRAME_MAX 14
+
+/**
+ * @brief Claim the TIMER/DPPI resources and program the TWIM transfer
+ * @param i2c_addr 7-bit I2C address of the MPU6050
+ * @param start_reg First register of each read (e.g. ACCEL_XOUT_H)
+ * @param frame_size Bytes per read, at most ACQ_DPPI_FRAME_MAX
+ * @param sample_period_us Sampling period driven by the pacing TIMER
+ * @return 0 on success, negative errno on failure
+ */
+int acq_dppi_init(uint8_t i2c_addr, uint8_t start_reg, uint8_t frame_size,
+                  uint32_t sample_period_us);
+
+/**
+ * @brief Start hardware-paced sampling
+ *
+ * Takes over the TWIM peripheral from the Zephyr I2C driver until
+ * acq_dppi_stop() is called. No other I2C traffic may be issued meanwhile.
+ * @return 0 on success, negative errno on failure
+ */
+int acq_dppi_start(void);
+
+/**
+ * @brief Stop sampling and hand the TWIM peripheral back to the I2C driver
+ */
+void acq_dppi_stop(void);
+
+/**
+ * @brief Change the sampling period
+ *
+ * Only allowed while stopped; takes effect on the next acq_dppi_start().
+ * @param sample_period_us New sampling period driven by the pacing TIMER
+ * @return 0 on success, -EBUSY while sampling is running
+ */
+int acq_dppi_set_period(uint32_t sample_period_us);
+
+/**
+ * @brief Change the register window read for each sample
+ *
+ * Only allowed while stopped; takes effect on the next acq_dppi_start().
+ * @param start_reg First register of each read
+ * @param frame_size Bytes per read, at most ACQ_DPPI_FRAME_MAX
+ * @return 0 on success, -EBUSY while sampling is running, -EINVAL if
+ *         frame_size is out of range
+ */
+int acq_dppi_set_frame(uint8_t start_reg, uint8_t frame_size);
+
+/**
+ * @brief Make a pending acq_dppi_wait_block() return -EAGAIN
+ *
+ * Lets another thread hand control back to the reader (e.g. to reconfigure
+ * the sensor) without waiting for the next block.
+ */
+void acq_dppi_wake(void);
+
+/**
+ * @brief Wait for the next completed block of samples
+ *
+ * Blocks until sampling is running and a block completes. If no block
+ * arrives within two block periods the transfer chain is assumed stalled
+ * (e.g. a NACK), sampling is restarted and -EIO is returned.
+ *
+ * Only the newest completed block is returned. Blocks the hardware finished
+ * while the reader was busy are skipped; they show up as a jump in seq.
+ *
+ * @param block Set to CONFIG_ACCEL_DPPI_BLOCK_SAMPLES back-to-back frames of
+ *              frame_size bytes, valid until acq_dppi_release_block()
+ * @param first_sample_us Set to the uptime (µs) of the block's first sample,
+ *                        derived from the TIMER pacing, not from wakeup time
+ * @param seq Set to the block's number, counted from boot across restarts
+ * @return 0 on success, -EIO after a stall restart, -EAGAIN after
+ *         acq_dppi_wake()
+ */
+int acq_dppi_wait_block(const uint8_t **block, uint64_t *first_sample_us,
+                        uint32_t *seq);
+
+/**
+ * @brief Return the block obtained from acq_dppi_wait_block()
+ * @param seq Its number
+ */
+void acq_dppi_release_block(uint32_t seq);
+
+/**
+ * @brief Blocks overwritten before the reader released them
+ */
+uint32_t acq_dppi_overruns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ACQ_DPPI_H_ */
@@ -0,0 +1,82 @@
+/**
+ * @file bandpass.h
+ * @brief RBJ band-pass biquad shared by the feature and trigger filters
+ *
+ * Constant 0 dB peak gain, centred on the geometric mean of the band edges
+ * with Q = f0 / bandwidth, normalised so that b1 = 0 and b2 = -b0. Run in
+ * transposed direct form II, one float sample at a time.
+ */
+
+#ifndef BANDPASS_H_
+#define BANDPASS_H_
+
+#include <math.h>
+#include <stdbool.h>
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bandpass {
+  float b0;
+  float a1;
+  float a2;
+};
+
+struct bandpass_state {
+  float z1;
+  float z2;
+};
+
+/**
+ * @brief Design the filter for a band at a sample rate
+ * @param f Filter
+ * @param lo_hz Lower band edge, above 0
+ * @param hi_hz Upper band edge, above lo_hz
+ * @param rate_hz Sample rate
+ * @return false if the band reaches Nyquist (the filter is still set)
+ */
+static inline bool bandpass_design(struct bandpass *f, uint16_t lo_hz,
+                                   uint16_t hi_hz, uint16_t rate_hz) {
+  float lo = lo_hz;
+  float hi = hi_hz;
+  float f0 = sqrtf(lo * hi);
+  float w0 = 2.0f * (float)M_PI * f0 / rate_hz;
+  float alpha = sinf(w0) * (hi - lo) / (2.0f * f0);
+  float a0 = 1.0f + alpha;
+
+  f->b0 = alpha / a0;
+  f->a1 = -2.0f * cosf(w0) / a0;
+  f->a2 = (1.0f - alpha) / a0;
+  return 2U * hi_hz < rate_hz;
+}
+
+/**
+ * @brief State of a filter that has seen x forever, so it starts without a
+ *        step response
+ */
+static inline void bandpass_rest(const struct bandpass *f,
+                                 struct bandpass_state *s, float x) {
+  s->z1 = -f->b0 * x;
+  s->z2 = s->z1;
+}
+
+/**
+ * @brief Filter one sample
+ * @return Output sample
+ */
+static inline float bandpass_step(const struct bandpass *f,
+                                  struct bandpass_state *s, float x) {
+  float y = f->b0 * x + s->z1;
+
+  s->z1 = -f->a1 * y + s->z2;
+  s->z2 = -f->b0 * x - f->a2 * y;
+  return y;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BANDPASS_H_ */
@@ -0,0 +1,50 @@
+/**
+ * @file conn_tune.h
+ * @brief Link-layer throughput negotiation after connect
+ *
+ * Once a central connects: ATT MTU exchange, data length extension (251
+ * bytes), 2M PHY, then the preferred connection interval, walking down a
+ * list of fallback parameter sets if the central does not grant one. Each
+ * connection is tuned on its own. The controller's connection event length
+ * is set at init. The resulting link profile is published through the Link
+ * Profile characteristic, which every central reads for its own link.
+ */
+
+#ifndef CONN_TUNE_H_
+#define CONN_TUNE_H_
+
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Connection event length requested from the controller (µs) */
+#define CONN_TUNE_EVENT_LEN_US 7500
+
+/* Time the central gets to apply a parameter set before the next is tried */
+#define CONN_TUNE_PARAM_TIMEOUT_MS 5000
+
+/**
+ * @brief ATT MTU exchange result handler
+ * @param conn Connection the MTU applies to
+ * @param mtu Negotiated ATT MTU (23 if the exchange failed)
+ */
+typedef void (*conn_tune_mtu_cb_t)(struct bt_conn *conn, uint16_t mtu);
+
+/**
+ * @brief Configure the controller and start tuning every new connection
+ *
+ * Call after bt_enable(), before advertising.
+ * @param mtu_cb Called when the MTU exchange completes, or NULL
+ * @return 0 on success, negative errno on failure (tuning still runs, with
+ *         the controller's default event length)
+ */
+int conn_tune_init(conn_tune_mtu_cb_t mtu_cb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONN_TUNE_H_ */
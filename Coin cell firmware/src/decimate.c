@@ -0,0 +1,219 @@
+/**
+ * @file decimate.c
+ * @brief Multi-stage polyphase FIR decimator ahead of the packet ring
+ *
+ * Both tables are Kaiser-windowed sinc lowpasses (beta 6.1) cut at half the
+ * stage output rate, rounded to Q15 with the centre tap adjusted for unity
+ * gain at DC. The x2 stage is a half-band filter, so every other tap is
+ * zero. The sum of |taps| stays below 2^16, which keeps any 16-bit input
+ * within the 32-bit accumulator.
+ *
+ * Each stage keeps a circular history per channel and only runs its dot
+ * product when an output is due, once per factor inputs: the work of one
+ * polyphase branch per input.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "decimate.h"
+
+LOG_MODULE_REGISTER(decimate, LOG_LEVEL_INF);
+
+/*============================================================================
+ * Coefficients
+ *===========================================================================*/
+
+/* x2: pass to 0.2 fs, stop from 0.3 fs (-63 dB) */
+static const int16_t taps_x2[] = {
+    -6, 0, 22, 0, -52, 0, 104, 0, -184, 0, 306, 0, -483, 0, 745, 0, -1145, 0,
+    1826, 0, -3315, 0, 10376, 16380, 10376, 0, -3315, 0, 1826, 0, -1145, 0, 745,
+    0, -483, 0, 306, 0, -184, 0, 104, 0, -52, 0, 22, 0, -6,
+};
+
+/* x5: pass to 0.08 fs, stop from 0.12 fs (-64 dB) */
+static const int16_t taps_x5[] = {
+    -2, -4, -5, -4, 0, 6, 11, 13, 10, 0, -13, -24, -27, -19, 0, 24, 44, 49, 34,
+    0, -42, -75, -83, -57, 0, 68, 121, 132, 89, 0, -106, -187, -203, -136, 0,
+    161, 282, 306, 206, 0, -243, -427, -465, -313, 0, 376, 669, 739, 507, 0,
+    -640, -1180, -1365, -994, 0, 1514, 3284, 4946, 6127, 6560, 6127, 4946, 3284,
+    1514, 0, -994, -1365, -1180, -640, 0, 507, 739, 669, 376, 0, -313, -465,
+    -427, -243, 0, 206, 306, 282, 161, 0, -136, -203, -187, -106, 0, 89, 132,
+    121, 68, 0, -57, -83, -75, -42, 0, 34, 49, 44, 24, 0, -19, -27, -24, -13, 0,
+    10, 13, 11, 6, 0, -4, -5, -4, -2,
+};
+
+#define DECIMATE_TAPS_MAX ARRAY_SIZE(taps_x5)
+
+/*============================================================================
+ * State Variables (reader thread only)
+ *===========================================================================*/
+
+struct decim_stage {
+  const int16_t *taps;
+  uint8_t n_taps;
+  uint8_t factor;
+  uint8_t phase; /* Inputs since the last output */
+  uint8_t pos;   /* Next history slot, the oldest sample */
+  int16_t hist[DECIMATE_CHANNELS_MAX][DECIMATE_TAPS_MAX];
+};
+
+static struct decim_stage stages[DECIMATE_STAGES_MAX];
+static uint8_t stage_count = 0;
+static uint8_t channel_count = 0;
+static bool primed = false; /* Histories hold a frame */
+
+/*============================================================================
+ * Helpers
+ *===========================================================================*/
+
+/* Stages of 5 and 2 making up factor, 0 if it is not a product of them */
+static uint8_t factor_stages(uint16_t factor, uint8_t *factors) {
+  static const uint8_t stage_factors[] = {5, 2}; /* Cut the rate early */
+  uint8_t n = 0;
+
+  for (size_t i = 0; i < ARRAY_SIZE(stage_factors); i++) {
+    uint8_t f = stage_factors[i];
+
+    while (factor % f == 0 && n < DECIMATE_STAGES_MAX) {
+      if (factors) {
+        factors[n] = f;
+      }
+      n++;
+      factor /= f;
+    }
+  }
+  return factor == 1 ? n : 0;
+}
+
+/* Start every history on one frame, as if it had always been there */
+static void stages_prime(const int16_t *v) {
+  for (uint8_t s = 0; s < stage_count; s++) {
+    for (uint8_t c = 0; c < channel_count; c++) {
+      for (uint8_t k = 0; k < stages[s].n_taps; k++) {
+        stages[s].hist[c][k] = v[c];
+      }
+    }
+  }
+  primed = true;
+}
+
+static int16_t stage_dot(const struct decim_stage *st, const int16_t *x) {
+  /* Linear phase: the taps are symmetric, so they apply oldest-first */
+  const int16_t *h = st->taps;
+  uint8_t split = st->n_taps - st->pos;
+  int32_t acc = 1 << 14; /* Round to nearest */
+  uint8_t k;
+
+  for (k = 0; k < split; k++) {
+    acc += h[k] * x[st->pos + k];
+  }
+  for (; k < st->n_taps; k++) {
+    acc += h[k] * x[k - split];
+  }
+
+  acc >>= 15;
+  return (int16_t)CLAMP(acc, INT16_MIN, INT16_MAX);
+}
+
+/* Take in one frame; true with the decimated frame in v when one is due */
+static bool stage_push(struct decim_stage *st, int16_t *v) {
+  for (uint8_t c = 0; c < channel_count; c++) {
+    st->hist[c][st->pos] = v[c];
+  }
+  st->pos = (st->pos + 1 == st->n_taps) ? 0 : st->pos + 1;
+
+  if (++st->phase < st->factor) {
+    return false;
+  }
+  st->phase = 0;
+
+  for (uint8_t c = 0; c < channel_count; c++) {
+    v[c] = stage_dot(st, st->hist[c]);
+  }
+  return true;
+}
+
+/*============================================================================
+ * API Implementation
+ *===========================================================================*/
+
+uint16_t decimate_factor(uint16_t rate_hz, uint16_t base_hz) {
+  for (uint16_t d = CONFIG_ACCEL_DECIMATE_MAX_FACTOR; d > 1; d--) {
+    uint32_t sensor_hz = (uint32_t)rate_hz * d;
+
+    if (sensor_hz <= base_hz && base_hz % sensor_hz == 0 &&
+        factor_stages(d, NULL) > 0) {
+      return d;
+    }
+  }
+  return 1;
+}
+
+void decimate_configure(uint16_t factor, uint8_t channels) {
+  uint8_t factors[DECIMATE_STAGES_MAX];
+
+  stage_count = factor_stages(factor, factors);
+  channel_count = MIN(channels, DECIMATE_CHANNELS_MAX);
+  primed = false;
+
+  for (uint8_t s = 0; s < stage_count; s++) {
+    struct decim_stage *st = &stages[s];
+
+    st->factor = factors[s];
+    st->taps = (st->factor == 5) ? taps_x5 : taps_x2;
+    st->n_taps = (st->factor == 5) ? ARRAY_SIZE(taps_x5) : ARRAY_SIZE(taps_x2);
+    st->phase = 0;
+    st->pos = 0;
+  }
+
+  if (factor > 1) {
+    LOG_INF("Decimating by %u in %u stages, %u channels, delay %u samples",
+            factor, stage_count, channel_count, decimate_delay());
+  }
+}
+
+bool decimate_push(const uint8_t *raw, uint8_t *out) {
+  int16_t v[DECIMATE_CHANNELS_MAX];
+
+  for (uint8_t c = 0; c < channel_count; c++) {
+    v[c] = (int16_t)sys_get_be16(&raw[2 * c]);
+  }
+  if (!primed) {
+    stages_prime(v);
+  }
+
+  for (uint8_t s = 0; s < stage_count; s++) {
+    if (!stage_push(&stages[s], v)) {
+      return false;
+    }
+  }
+
+  for (uint8_t c = 0; c < channel_count; c++) {
+    sys_put_be16((uint16_t)v[c], &out[2 * c]);
+  }
+  return true;
+}
+
+uint32_t decimate_skip(uint32_t n) {
+  for (uint8_t s = 0; s < stage_count; s++) {
+    struct decim_stage *st = &stages[s];
+    uint32_t phase = st->phase + n;
+
+    st->phase = phase % st->factor;
+    n = phase / st->factor;
+  }
+  return n;
+}
+
+uint32_t decimate_delay(void) {
+  uint32_t delay = 0;
+  uint32_t scale = 1; /* Sensor samples per stage input */
+
+  for (uint8_t s = 0; s < stage_count; s++) {
+    delay += (stages[s].n_taps - 1) / 2 * scale;
+    scale *= stages[s].factor;
+  }
+  return delay;
+}
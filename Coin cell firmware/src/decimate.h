@@ -0,0 +1,75 @@
+/**
+ * @file decimate.h
+ * @brief Multi-stage polyphase FIR decimator ahead of the packet ring
+ *
+ * With CONFIG_ACCEL_DECIMATE the MPU6050 runs faster than the rate written to
+ * the sampling rate characteristic, and the reader thread passes each raw
+ * frame through decimate_push(). Stages of 2 and 5, each a linear-phase
+ * lowpass with a Q15 coefficient table fixed at build time, bring it down
+ * to the written rate; only the samples kept are computed. Passband is flat
+ * (0.01 dB) to 0.4 x the output rate, and everything from 0.6 x is down by
+ * at least 60 dB, so aliases only land in the top of the band.
+ */
+
+#ifndef DECIMATE_H_
+#define DECIMATE_H_
+
+#include <stdbool.h>
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DECIMATE_STAGES_MAX 3   /* Up to 5 x 5 x 5 */
+#define DECIMATE_CHANNELS_MAX 7 /* ACCEL_CH_COUNT */
+
+/**
+ * @brief Decimation factor for an output rate
+ *
+ * The largest factor up to CONFIG_ACCEL_DECIMATE_MAX_FACTOR, made of at most
+ * DECIMATE_STAGES_MAX stages, that keeps the sensor rate a divisor of
+ * base_hz.
+ * @param rate_hz Output rate in Hz
+ * @param base_hz Sensor rate divider base
+ * @return Sensor samples per output sample, 1 if none fits
+ */
+uint16_t decimate_factor(uint16_t rate_hz, uint16_t base_hz);
+
+/**
+ * @brief Restart the filters for a factor and frame layout (reader thread)
+ * @param factor From decimate_factor()
+ * @param channels 16-bit channels in each raw frame
+ */
+void decimate_configure(uint16_t factor, uint8_t channels);
+
+/**
+ * @brief Filter one raw frame (reader thread)
+ * @param raw Big-endian frame at the sensor rate
+ * @param out Set to the decimated frame, same layout, when one is due
+ * @return true if out was written
+ */
+bool decimate_push(const uint8_t *raw, uint8_t *out);
+
+/**
+ * @brief Account for sensor frames that were never read (reader thread)
+ *
+ * Keeps the output on its grid: the filters carry on as if the frames had
+ * not existed.
+ * @param n Frames lost
+ * @return Output samples they would have produced
+ */
+uint32_t decimate_skip(uint32_t n);
+
+/**
+ * @brief Group delay of the configured chain
+ * @return Delay in sensor samples: an output describes the input that many
+ *         frames before the one completing it
+ */
+uint32_t decimate_delay(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DECIMATE_H_ */
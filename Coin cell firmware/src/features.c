@@ -0,0 +1,257 @@
+/**
+ * @file features.c
+ * @brief Per-window vibration features of the accelerometer axes
+ *
+ * Moments use the one-pass update of Welford, extended to the 3rd and 4th
+ * central moments (Terriberry), so no sample is stored. The band-pass
+ * filters are the RBJ biquads of bandpass.h, shared with the trigger; their
+ * state carries over from one window to the next.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "bandpass.h"
+#include "features.h"
+
+LOG_MODULE_REGISTER(features, LOG_LEVEL_INF);
+
+/*============================================================================
+ * Configuration
+ *===========================================================================*/
+
+#define FEATURES_AXES 3 /* Accelerometer X, Y, Z */
+#define FEATURES_BANDS ACCEL_FEATURE_BANDS
+#define FEATURES_QUEUE_DEPTH 2 /* Records waiting for the workqueue */
+
+static const uint16_t band_edges_hz[FEATURES_BANDS + 1] =
+    ACCEL_FEATURE_BAND_EDGES_HZ;
+
+/*============================================================================
+ * State Variables (reader thread only)
+ *===========================================================================*/
+
+struct axis_state {
+  float mean;
+  float m2; /* Sums of powers of deviations from the mean */
+  float m3;
+  float m4;
+  int16_t min;
+  int16_t max;
+  uint16_t crossings;
+  bool above; /* Last sample above the running mean */
+  struct bandpass_state band[FEATURES_BANDS];
+  float band_sq[FEATURES_BANDS]; /* Sum of squared filter outputs */
+};
+
+static struct axis_state axes_state[FEATURES_AXES];
+static struct bandpass bands[FEATURES_BANDS];
+static bool band_valid[FEATURES_BANDS];
+
+static uint8_t window_axes = 0;
+static uint16_t window_rate_hz = 0;
+static uint16_t window_samples = 0; /* Samples per window at window_rate_hz */
+static uint16_t window_count = 0;   /* Samples so far */
+static uint16_t window_seq = 0;
+static uint32_t window_base_counter = 0;
+static uint32_t records_dropped = 0;
+
+/*============================================================================
+ * Publishing (system workqueue)
+ *===========================================================================*/
+
+struct features_msg {
+  accel_features_t rec;
+  uint16_t len;
+};
+
+K_MSGQ_DEFINE(features_queue, sizeof(struct features_msg),
+              FEATURES_QUEUE_DEPTH, 2);
+
+static void publish_work_fn(struct k_work *work) {
+  struct features_msg msg;
+
+  ARG_UNUSED(work);
+
+  while (k_msgq_get(&features_queue, &msg, K_NO_WAIT) == 0) {
+    int err = accel_service_publish_features(&msg.rec, msg.len);
+
+    if (err && err != -ENOTCONN) {
+      LOG_WRN("Features %u not sent (err %d)", msg.rec.window, err);
+    }
+  }
+}
+
+static K_WORK_DEFINE(publish_work, publish_work_fn);
+
+/*============================================================================
+ * Helpers
+ *===========================================================================*/
+
+static uint16_t sat_u16(float v) {
+  v += 0.5f;
+  return v <= 0.0f ? 0 : (v >= UINT16_MAX ? UINT16_MAX : (uint16_t)v);
+}
+
+static int16_t sat_i16(float v) {
+  v = roundf(v);
+  return v <= INT16_MIN ? INT16_MIN : (v >= INT16_MAX ? INT16_MAX : (int16_t)v);
+}
+
+/* Filters for the rate; bands not below Nyquist are left out */
+static void bands_design(uint16_t rate_hz) {
+  for (size_t b = 0; b < FEATURES_BANDS; b++) {
+    band_valid[b] = bandpass_design(&bands[b], band_edges_hz[b],
+                                    band_edges_hz[b + 1], rate_hz);
+  }
+}
+
+/* Start a window; the filters keep running unless restart is set */
+static void window_open(uint32_t counter, bool restart) {
+  for (size_t a = 0; a < FEATURES_AXES; a++) {
+    struct axis_state *s = &axes_state[a];
+
+    s->mean = 0.0f;
+    s->m2 = 0.0f;
+    s->m3 = 0.0f;
+    s->m4 = 0.0f;
+    s->min = INT16_MAX;
+    s->max = INT16_MIN;
+    s->crossings = 0;
+    for (size_t b = 0; b < FEATURES_BANDS; b++) {
+      s->band_sq[b] = 0.0f;
+      if (restart) {
+        s->band[b] = (struct bandpass_state){0};
+      }
+    }
+  }
+  window_count = 0;
+  window_base_counter = counter;
+}
+
+static void axis_update(struct axis_state *s, int16_t sample, float n,
+                        float inv_n) {
+  float x = sample;
+  float delta = x - s->mean;
+  float delta_n = delta * inv_n;
+  float delta_n2 = delta_n * delta_n;
+  float term1 = delta * delta_n * (n - 1.0f);
+
+  /* m4 and m3 need the previous m2 and m3 */
+  s->mean += delta_n;
+  s->m4 += term1 * delta_n2 * (n * n - 3.0f * n + 3.0f) +
+           6.0f * delta_n2 * s->m2 - 4.0f * delta_n * s->m3;
+  s->m3 += term1 * delta_n * (n - 2.0f) - 3.0f * delta_n * s->m2;
+  s->m2 += term1;
+
+  s->min = MIN(s->min, sample);
+  s->max = MAX(s->max, sample);
+
+  bool above = x > s->mean;
+
+  if (n > 1.0f && above != s->above && s->crossings < UINT16_MAX) {
+    s->crossings++;
+  }
+  s->above = above;
+
+  for (size_t b = 0; b < FEATURES_BANDS; b++) {
+    float y = bandpass_step(&bands[b], &s->band[b], x);
+
+    s->band_sq[b] += y * y;
+  }
+}
+
+static void axis_reduce(const struct axis_state *s, float n,
+                        accel_feature_axis_t *out) {
+  float rms = sqrtf(s->m2 / n);
+  float peak = MAX(s->max - s->mean, s->mean - s->min);
+
+  out->mean = sat_i16(s->mean);
+  out->min = s->min;
+  out->max = s->max;
+  out->rms = sat_u16(rms);
+  out->peak = sat_u16(peak);
+  out->crossings = s->crossings;
+
+  if (s->m2 > 0.0f) {
+    out->crest_q8 = sat_u16(peak / rms * 256.0f);
+    out->skew_q8 = sat_i16(sqrtf(n) * s->m3 / (s->m2 * sqrtf(s->m2)) * 256.0f);
+    out->kurt_q8 = sat_u16(n * s->m4 / (s->m2 * s->m2) * 256.0f);
+  } else {
+    /* Constant signal */
+    out->crest_q8 = 0;
+    out->skew_q8 = 0;
+    out->kurt_q8 = 0;
+  }
+
+  for (size_t b = 0; b < FEATURES_BANDS; b++) {
+    out->band_rms[b] = band_valid[b] ? sat_u16(sqrtf(s->band_sq[b] / n))
+                                     : ACCEL_FEATURE_NA;
+  }
+}
+
+/* Reduce the window to a record and queue it for publishing */
+static void window_close(void) {
+  struct features_msg msg;
+  float n = window_count;
+  uint8_t entries = 0;
+
+  msg.rec.window = window_seq++;
+  msg.rec.base_counter = window_base_counter;
+  msg.rec.samples = window_count;
+  msg.rec.rate_hz = window_rate_hz;
+  msg.rec.axes = window_axes;
+  msg.rec.bands = FEATURES_BANDS;
+
+  for (uint8_t a = 0; a < FEATURES_AXES; a++) {
+    if (window_axes & BIT(a)) {
+      axis_reduce(&axes_state[a], n, &msg.rec.axis[entries++]);
+    }
+  }
+  msg.len = ACCEL_FEATURES_HDR_SIZE + entries * sizeof(accel_feature_axis_t);
+
+  if (k_msgq_put(&features_queue, &msg, K_NO_WAIT)) {
+    records_dropped++;
+    LOG_WRN("Features %u dropped, publishing is behind (%u total)",
+            msg.rec.window, records_dropped);
+    return;
+  }
+  k_work_submit(&publish_work);
+}
+
+/*============================================================================
+ * API Implementation
+ *===========================================================================*/
+
+void features_push(const int16_t xyz[3], uint8_t axes, uint16_t rate_hz,
+                   uint32_t counter) {
+  if (axes != window_axes || rate_hz != window_rate_hz) {
+    window_axes = axes;
+    window_rate_hz = rate_hz;
+    window_samples = (uint16_t)MAX(
+        (uint32_t)rate_hz * CONFIG_ACCEL_FEATURES_WINDOW_MS / 1000U, 2U);
+    bands_design(rate_hz);
+    window_open(counter, true);
+  } else if (window_count == 0) {
+    window_open(counter, false);
+  }
+  if (axes == 0) {
+    return;
+  }
+
+  float n = (float)++window_count;
+  float inv_n = 1.0f / n;
+
+  for (uint8_t a = 0; a < FEATURES_AXES; a++) {
+    if (axes & BIT(a)) {
+      axis_update(&axes_state[a], xyz[a], n, inv_n);
+    }
+  }
+
+  if (window_count == window_samples) {
+    window_close();
+    window_count = 0;
+  }
+}
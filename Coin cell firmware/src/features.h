@@ -0,0 +1,42 @@
+/**
+ * @file features.h
+ * @brief Per-window vibration features of the accelerometer axes
+ *
+ * The reader thread hands every sample it reads to features_push(), next to
+ * (not instead of) packing it for streaming. Running sums are updated per
+ * sample: Welford mean and central moments up to the 4th, min/max, mean
+ * crossings and the energy out of a few IIR band-pass filters. When a window
+ * of CONFIG_ACCEL_FEATURES_WINDOW_MS is complete they are reduced to an
+ * accel_features_t (layout in accel_service.h), published from the system
+ * workqueue on the features characteristic.
+ */
+
+#ifndef FEATURES_H_
+#define FEATURES_H_
+
+#include <zephyr/types.h>
+
+#include "accel_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Add one sample to the current window
+ *
+ * Reader thread only. A change of axes or rate restarts the window and the
+ * filters.
+ * @param xyz Accelerometer X, Y and Z in raw counts (unused axes ignored)
+ * @param axes ACCEL_CH_AX/AY/AZ bits to analyse, 0 to skip the sample
+ * @param rate_hz Sampling rate of the sample
+ * @param counter Sample counter of the sample
+ */
+void features_push(const int16_t xyz[3], uint8_t axes, uint16_t rate_hz,
+                   uint32_t counter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FEATURES_H_ */
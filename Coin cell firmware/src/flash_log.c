@@ -0,0 +1,283 @@
+/**
+ * @file flash_log.c
+ * @brief Store-and-forward packet log on internal flash
+ *
+ * Records are numbered by a 32-bit sequence number that only grows; record n
+ * lives in slot n % FLASH_LOG_PAGE_RECORDS of page (n / records) % pages.
+ * Every slot on flash carries its number, so after a reset the newest page
+ * is simply the one with the highest first number, and a slot that does not
+ * carry the number expected (failed write, or whatever the partition held
+ * before) is skipped instead of sent.
+ *
+ * Records reach flash a page at a time: up to FLASH_LOG_PAGE_RECORDS - 1 of
+ * them (4 KB) sit in page_buf in RAM, and a reset or power loss before the
+ * page fills loses them.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/storage/flash_map.h>
+
+#include "flash_log.h"
+
+LOG_MODULE_REGISTER(flash_log, LOG_LEVEL_INF);
+
+/*============================================================================
+ * Record Layout
+ *===========================================================================*/
+
+#define FLASH_LOG_MAGIC 0x474F4C41U /* "ALOG" */
+
+struct flash_log_record {
+  uint32_t magic;
+  uint32_t seq;
+  accel_packet_t packet;
+  uint8_t reserved[FLASH_LOG_RECORD_SIZE - 8 - sizeof(accel_packet_t)];
+} __attribute__((packed));
+
+BUILD_ASSERT(sizeof(struct flash_log_record) == FLASH_LOG_RECORD_SIZE,
+             "Record must fill its slot exactly");
+BUILD_ASSERT(FLASH_LOG_PAGE_SIZE % FLASH_LOG_RECORD_SIZE == 0,
+             "Records must not straddle pages");
+
+/*============================================================================
+ * State
+ *===========================================================================*/
+
+static const struct flash_area *log_fa;
+static uint32_t log_pages = 0; /* 0 until flash_log_init() succeeds */
+
+/* The page being filled: records [head_seq - head_seq % records, head_seq) */
+static struct flash_log_record page_buf[FLASH_LOG_PAGE_RECORDS] __aligned(4);
+static uint32_t head_seq = 0; /* Next number to append */
+static uint32_t tail_seq = 0; /* Oldest number not sent, may be stale */
+#if defined(CONFIG_SETTINGS)
+static uint32_t saved_tail_seq = 0;
+#endif
+
+static uint32_t flushed_seq(void) {
+  return head_seq - head_seq % FLASH_LOG_PAGE_RECORDS;
+}
+
+/* Oldest number still on flash: everything one lap behind was erased */
+static uint32_t oldest_seq(void) {
+  uint32_t lap = log_pages * FLASH_LOG_PAGE_RECORDS;
+  uint32_t flushed = flushed_seq();
+
+  return flushed > lap ? flushed - lap : 0;
+}
+
+static uint32_t log_tail(void) {
+  return CLAMP(tail_seq, oldest_seq(), head_seq);
+}
+
+static off_t record_offset(uint32_t seq) {
+  uint32_t page = (seq / FLASH_LOG_PAGE_RECORDS) % log_pages;
+
+  return (off_t)page * FLASH_LOG_PAGE_SIZE +
+         (seq % FLASH_LOG_PAGE_RECORDS) * FLASH_LOG_RECORD_SIZE;
+}
+
+/*============================================================================
+ * Flash Access
+ *===========================================================================*/
+
+/* Erase the page page_buf belongs on and write it in one go */
+static int page_write(uint32_t first_seq) {
+  off_t off = record_offset(first_seq);
+  int err;
+
+  err = flash_area_erase(log_fa, off, FLASH_LOG_PAGE_SIZE);
+  if (err) {
+    return err;
+  }
+  return flash_area_write(log_fa, off, page_buf, FLASH_LOG_PAGE_SIZE);
+}
+
+/* Find the newest written page. Returns false if there is none. */
+static bool log_scan(uint32_t *newest) {
+  bool found = false;
+
+  for (uint32_t page = 0; page < log_pages; page++) {
+    uint32_t hdr[2];
+
+    if (flash_area_read(log_fa, (off_t)page * FLASH_LOG_PAGE_SIZE, hdr,
+                        sizeof(hdr))) {
+      continue;
+    }
+    if (hdr[0] != FLASH_LOG_MAGIC || hdr[1] % FLASH_LOG_PAGE_RECORDS ||
+        (hdr[1] / FLASH_LOG_PAGE_RECORDS) % log_pages != page) {
+      continue;
+    }
+    if (!found || hdr[1] > *newest) {
+      *newest = hdr[1];
+      found = true;
+    }
+  }
+  return found;
+}
+
+/*============================================================================
+ * API Implementation
+ *===========================================================================*/
+
+int flash_log_init(void) {
+  struct flash_pages_info info;
+  uint32_t newest;
+  int err;
+
+  err = flash_area_open(FIXED_PARTITION_ID(accel_log), &log_fa);
+  if (err) {
+    LOG_ERR("accel_log partition not found (err %d)", err);
+    return err;
+  }
+
+  err = flash_get_page_info_by_offs(flash_area_get_device(log_fa),
+                                    log_fa->fa_off, &info);
+  if (err || info.size != FLASH_LOG_PAGE_SIZE ||
+      log_fa->fa_off % FLASH_LOG_PAGE_SIZE ||
+      log_fa->fa_size < 2 * FLASH_LOG_PAGE_SIZE) {
+    LOG_ERR("accel_log must be 2+ aligned %u-byte pages", FLASH_LOG_PAGE_SIZE);
+    flash_area_close(log_fa);
+    return -EINVAL;
+  }
+
+  log_pages = log_fa->fa_size / FLASH_LOG_PAGE_SIZE;
+  head_seq = log_scan(&newest) ? newest + FLASH_LOG_PAGE_RECORDS : 0;
+  tail_seq = log_tail(); /* A stored tail may be past an erased partition */
+
+  LOG_INF("Flash log: %u pages (%u packets), resuming at record %u",
+          log_pages, log_pages * FLASH_LOG_PAGE_RECORDS, head_seq);
+  return 0;
+}
+
+int flash_log_append(const accel_packet_t *packets, size_t count) {
+  int ret = 0;
+
+  if (log_pages == 0) {
+    return -ENODEV;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    struct flash_log_record *rec =
+        &page_buf[head_seq % FLASH_LOG_PAGE_RECORDS];
+
+    rec->magic = FLASH_LOG_MAGIC;
+    rec->seq = head_seq;
+    memcpy(&rec->packet, &packets[i], sizeof(rec->packet));
+    memset(rec->reserved, 0xFF, sizeof(rec->reserved));
+    head_seq++;
+
+    if (head_seq % FLASH_LOG_PAGE_RECORDS == 0) {
+      int err = page_write(head_seq - FLASH_LOG_PAGE_RECORDS);
+
+      if (err) {
+        LOG_WRN("Flash log page write failed (err %d)", err);
+        ret = err;
+      }
+    }
+  }
+  return ret;
+}
+
+uint32_t flash_log_pending(void) {
+  if (log_pages == 0) {
+    return 0;
+  }
+  return head_seq - log_tail();
+}
+
+int flash_log_peek(accel_packet_t *packet) {
+  if (log_pages == 0) {
+    return -ENOENT;
+  }
+
+  for (uint32_t seq = log_tail(); seq < head_seq; seq++) {
+    struct flash_log_record *rec = &page_buf[seq % FLASH_LOG_PAGE_RECORDS];
+    uint32_t hdr[2];
+    int err;
+
+    tail_seq = seq;
+
+    /* Still in RAM */
+    if (seq >= flushed_seq()) {
+      memcpy(packet, &rec->packet, sizeof(*packet));
+      return 0;
+    }
+
+    err = flash_area_read(log_fa, record_offset(seq), hdr, sizeof(hdr));
+    if (err) {
+      return err;
+    }
+    if (hdr[0] != FLASH_LOG_MAGIC || hdr[1] != seq) {
+      continue; /* Never written: skip it */
+    }
+    return flash_area_read(log_fa, record_offset(seq) + sizeof(hdr), packet,
+                           sizeof(*packet));
+  }
+
+  tail_seq = head_seq;
+  return -ENOENT;
+}
+
+void flash_log_consume(void) {
+  if (log_tail() < head_seq) {
+    tail_seq = log_tail() + 1;
+  }
+}
+
+void flash_log_save(void) {
+#if defined(CONFIG_SETTINGS)
+  uint32_t tail = log_tail();
+
+  if (tail == saved_tail_seq) {
+    return;
+  }
+
+  int err = settings_save_one("accel_log/tail", &tail, sizeof(tail));
+
+  if (err) {
+    LOG_WRN("Failed to persist flash log position (err %d)", err);
+    return;
+  }
+  saved_tail_seq = tail;
+#endif
+}
+
+/*============================================================================
+ * Settings
+ *===========================================================================*/
+
+#if defined(CONFIG_SETTINGS)
+static int flash_log_settings_set(const char *name, size_t len,
+                                  settings_read_cb read_cb, void *cb_arg) {
+  const char *next;
+  uint32_t tail;
+  int rc;
+
+  if (settings_name_steq(name, "tail", &next) && !next) {
+    if (len != sizeof(tail)) {
+      return -EINVAL;
+    }
+
+    rc = read_cb(cb_arg, &tail, sizeof(tail));
+    if (rc < 0) {
+      return rc;
+    }
+
+    /* Checked against the log by flash_log_init() */
+    tail_seq = tail;
+    saved_tail_seq = tail;
+    return 0;
+  }
+
+  return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(accel_log, "accel_log", NULL,
+                               flash_log_settings_set, NULL, NULL);
+#endif
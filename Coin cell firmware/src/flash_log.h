@@ -0,0 +1,81 @@
+/**
+ * @file flash_log.h
+ * @brief Store-and-forward packet log on internal flash
+ *
+ * A circular log of complete accel_packet_t (CRC included) on the accel_log
+ * partition (pm.yml.accel_log). Packets the central could not take are
+ * appended while it is away and sent back through the history characteristic
+ * once it returns; when the partition is full the oldest page is overwritten.
+ *
+ * Records are batched in RAM and written one whole flash page at a time
+ * (erase + write of an aligned page), so each page costs a single erase per
+ * pass over the partition. The up to FLASH_LOG_PAGE_RECORDS - 1 records of
+ * the unwritten page are lost on reset.
+ *
+ * Not thread safe: only the burst controller thread calls into it.
+ */
+
+#ifndef FLASH_LOG_H_
+#define FLASH_LOG_H_
+
+#include <zephyr/types.h>
+
+#include "accel_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLASH_LOG_PAGE_SIZE 4096  /* nRF5340 flash page */
+#define FLASH_LOG_RECORD_SIZE 256 /* Sequence number + packet, padded */
+#define FLASH_LOG_PAGE_RECORDS (FLASH_LOG_PAGE_SIZE / FLASH_LOG_RECORD_SIZE)
+
+/**
+ * @brief Open the partition and find where the last run stopped writing
+ *
+ * The oldest unsent record is restored from settings ("accel_log/tail"),
+ * so call this after settings_load().
+ * @return 0 on success, negative errno on failure
+ */
+int flash_log_init(void);
+
+/**
+ * @brief Append packets, writing out each page as it fills
+ * @param packets First of count packets
+ * @param count Packets to append
+ * @return 0 on success, negative errno if a page write failed (the page's
+ *         records are dropped)
+ */
+int flash_log_append(const accel_packet_t *packets, size_t count);
+
+/**
+ * @brief Records not yet sent back
+ * @return Count, oldest overwritten records excluded
+ */
+uint32_t flash_log_pending(void);
+
+/**
+ * @brief Copy the oldest unsent record
+ * @param packet Destination
+ * @return 0 on success, -ENOENT if nothing is pending, negative errno on a
+ *         flash read error
+ */
+int flash_log_peek(accel_packet_t *packet);
+
+/**
+ * @brief Mark the record returned by flash_log_peek() as sent
+ */
+void flash_log_consume(void);
+
+/**
+ * @brief Persist the sent position so a reset does not send records again
+ *
+ * One settings write: call when a backfill finishes, not per record.
+ */
+void flash_log_save(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_LOG_H_ */
@@ -0,0 +1,220 @@
+/**
+ * @file l2cap_stream.c
+ * @brief Burst streaming over an L2CAP connection-oriented channel
+ *
+ * One channel per connection. A central connects to the PSM read from the
+ * L2CAP PSM characteristic; from then on the burst controller hands whole
+ * runs of ring packets for that central to l2cap_stream_send() instead of
+ * notifying them.
+ *
+ * Flow control is the LE credit-based mode's own: the stack segments each
+ * SDU to the peer's MPS and only sends a K-frame when the peer has granted
+ * a credit. An SDU buffer is freed once its last segment went out. Every
+ * channel may have SDU_BUF_COUNT of them queued, so how far a sender runs
+ * ahead of the link is bounded per central, and a slow one never holds the
+ * buffers a fast one needs.
+ */
+
+#include <string.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/l2cap.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net_buf.h>
+
+#include "accel_service.h"
+#include "l2cap_stream.h"
+
+LOG_MODULE_REGISTER(l2cap_stream, LOG_LEVEL_INF);
+
+/*============================================================================
+ * Configuration
+ *===========================================================================*/
+
+#define SDU_BUF_COUNT 2 /* Per channel: one on air, one being filled */
+
+static void sdu_destroy(struct net_buf *buf);
+
+NET_BUF_POOL_FIXED_DEFINE(sdu_pool, SDU_BUF_COUNT * CONFIG_BT_MAX_CONN,
+                          BT_L2CAP_SDU_BUF_SIZE(L2CAP_STREAM_SDU_MAX), 8,
+                          sdu_destroy);
+
+/*============================================================================
+ * State Variables
+ *===========================================================================*/
+
+/* Indexed by bt_conn_index() */
+struct stream {
+  struct bt_l2cap_le_chan chan;
+  atomic_t busy;        /* Handed to the stack */
+  atomic_t ready;       /* Connected, usable for TX */
+  struct k_sem sdu_sem; /* SDU buffers this channel may still queue */
+};
+
+static struct stream streams[CONFIG_BT_MAX_CONN];
+static l2cap_stream_sent_cb_t sent_handler = NULL;
+
+/* Open stream of conn, or NULL */
+static struct stream *stream_get(struct bt_conn *conn) {
+  struct stream *st;
+
+  if (!conn) {
+    return NULL;
+  }
+  st = &streams[bt_conn_index(conn)];
+  if (!atomic_get(&st->ready) || st->chan.chan.conn != conn) {
+    return NULL;
+  }
+  return st;
+}
+
+/* BT stack context: an SDU left the stack, its channel may queue another */
+static void sdu_destroy(struct net_buf *buf) {
+  struct stream *st = &streams[*(uint8_t *)net_buf_user_data(buf)];
+
+  net_buf_destroy(buf);
+  k_sem_give(&st->sdu_sem);
+  if (sent_handler) {
+    sent_handler();
+  }
+}
+
+/*============================================================================
+ * Channel Callbacks
+ *===========================================================================*/
+
+static void stream_connected(struct bt_l2cap_chan *chan) {
+  struct bt_l2cap_le_chan *le_chan = BT_L2CAP_LE_CHAN(chan);
+  struct stream *st = CONTAINER_OF(le_chan, struct stream, chan);
+
+  LOG_INF("L2CAP stream connected: tx mtu %u, mps %u", le_chan->tx.mtu,
+          le_chan->tx.mps);
+
+  if (le_chan->tx.mtu < ACCEL_PACKET_SIZE) {
+    LOG_WRN("Peer MTU %u below one packet, not streaming", le_chan->tx.mtu);
+    return;
+  }
+  atomic_set(&st->ready, 1);
+}
+
+static void stream_disconnected(struct bt_l2cap_chan *chan) {
+  struct stream *st =
+      CONTAINER_OF(BT_L2CAP_LE_CHAN(chan), struct stream, chan);
+
+  LOG_INF("L2CAP stream disconnected");
+  atomic_set(&st->ready, 0);
+  atomic_set(&st->busy, 0);
+}
+
+static int stream_recv(struct bt_l2cap_chan *chan, struct net_buf *buf) {
+  ARG_UNUSED(chan);
+
+  /* TX-only stream: anything the central sends is dropped */
+  LOG_DBG("Ignoring %u bytes from central", buf->len);
+  return 0;
+}
+
+static const struct bt_l2cap_chan_ops stream_ops = {
+    .connected = stream_connected,
+    .disconnected = stream_disconnected,
+    .recv = stream_recv,
+};
+
+static int stream_accept(struct bt_conn *conn, struct bt_l2cap_server *server,
+                         struct bt_l2cap_chan **chan) {
+  ARG_UNUSED(server);
+
+  struct stream *st = &streams[bt_conn_index(conn)];
+
+  if (!atomic_cas(&st->busy, 0, 1)) {
+    LOG_WRN("L2CAP stream already open on this connection");
+    return -ENOMEM;
+  }
+
+  /* Late frees from an earlier channel only top the limit up again */
+  memset(&st->chan, 0, sizeof(st->chan));
+  st->chan.chan.ops = &stream_ops;
+  k_sem_init(&st->sdu_sem, SDU_BUF_COUNT, SDU_BUF_COUNT);
+  *chan = &st->chan.chan;
+  return 0;
+}
+
+/* psm = 0: the stack allocates one from the dynamic range */
+static struct bt_l2cap_server stream_server = {
+    .sec_level = BT_SECURITY_L1,
+    .accept = stream_accept,
+};
+
+/*============================================================================
+ * API Implementation
+ *===========================================================================*/
+
+int l2cap_stream_init(l2cap_stream_sent_cb_t sent_cb) {
+  int err;
+
+  sent_handler = sent_cb;
+  err = bt_l2cap_server_register(&stream_server);
+  if (err) {
+    LOG_ERR("L2CAP server register failed (err %d)", err);
+    return err;
+  }
+
+  accel_service_set_l2cap_psm(stream_server.psm);
+  LOG_INF("L2CAP stream on PSM 0x%04x, up to %u packets per SDU",
+          stream_server.psm, L2CAP_STREAM_SDU_PACKETS);
+  return 0;
+}
+
+bool l2cap_stream_ready(struct bt_conn *conn) {
+  return stream_get(conn) != NULL;
+}
+
+uint16_t l2cap_stream_sdu_packets(struct bt_conn *conn) {
+  struct stream *st = stream_get(conn);
+
+  if (!st) {
+    return 0;
+  }
+
+  return CLAMP(st->chan.tx.mtu / ACCEL_PACKET_SIZE, 1,
+               L2CAP_STREAM_SDU_PACKETS);
+}
+
+int l2cap_stream_send(struct bt_conn *conn, const accel_packet_t *packets,
+                      size_t count, k_timeout_t timeout) {
+  struct stream *st = stream_get(conn);
+  struct net_buf *buf;
+  int err;
+
+  if (!st) {
+    return -ENOTCONN;
+  }
+  if (count == 0 || count > l2cap_stream_sdu_packets(conn)) {
+    return -EINVAL;
+  }
+
+  /* Blocks while both of this channel's SDUs are still queued: this is the
+   * back-pressure */
+  if (k_sem_take(&st->sdu_sem, timeout) != 0) {
+    return -EAGAIN;
+  }
+
+  /* Never waits: the pool holds every channel's share */
+  buf = net_buf_alloc(&sdu_pool, K_NO_WAIT);
+  if (!buf) {
+    k_sem_give(&st->sdu_sem);
+    return -EAGAIN;
+  }
+  *(uint8_t *)net_buf_user_data(buf) = bt_conn_index(conn);
+
+  net_buf_reserve(buf, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
+  net_buf_add_mem(buf, packets, count * ACCEL_PACKET_SIZE);
+
+  err = bt_l2cap_chan_send(&st->chan.chan, buf);
+  if (err < 0) {
+    /* Not queued: the buffer is still ours (and gives the slot back) */
+    net_buf_unref(buf);
+    return err;
+  }
+  return 0;
+}
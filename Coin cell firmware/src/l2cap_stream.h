@@ -0,0 +1,81 @@
+/**
+ * @file l2cap_stream.h
+ * @brief Burst streaming over an L2CAP connection-oriented channel
+ *
+ * An LE credit-based channel on a dynamically allocated PSM, published
+ * through the read-only L2CAP PSM characteristic. Each SDU carries several
+ * complete accel_packet_t back-to-back (same layout and CRC as the GATT
+ * notifications); the stack segments it to the peer's MPS and spends the
+ * peer's credits. Each connection may open its own channel; the GATT
+ * service keeps working alongside them.
+ */
+
+#ifndef L2CAP_STREAM_H_
+#define L2CAP_STREAM_H_
+
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/kernel.h>
+#include <zephyr/types.h>
+
+#include "accel_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest SDU sent, in packets */
+#define L2CAP_STREAM_SDU_PACKETS CONFIG_ACCEL_L2CAP_SDU_PACKETS
+#define L2CAP_STREAM_SDU_MAX (L2CAP_STREAM_SDU_PACKETS * ACCEL_PACKET_SIZE)
+
+/**
+ * @brief SDU buffer freed handler (BT stack context)
+ *
+ * The channel it belonged to may queue another SDU.
+ */
+typedef void (*l2cap_stream_sent_cb_t)(void);
+
+/**
+ * @brief Register the L2CAP server and publish its PSM
+ *
+ * Call after bt_enable().
+ * @param sent_cb Called each time an SDU buffer is freed, or NULL
+ * @return 0 on success, negative errno on failure
+ */
+int l2cap_stream_init(l2cap_stream_sent_cb_t sent_cb);
+
+/**
+ * @brief Check if a central has its channel open
+ * @param conn Connection of the central
+ * @return true if its bursts should go over L2CAP
+ */
+bool l2cap_stream_ready(struct bt_conn *conn);
+
+/**
+ * @brief Packets one SDU may carry on a central's channel
+ * @param conn Connection of the central
+ * @return 1 to L2CAP_STREAM_SDU_PACKETS (limited by the peer's MTU), or 0
+ *         if the channel is closed
+ */
+uint16_t l2cap_stream_sdu_packets(struct bt_conn *conn);
+
+/**
+ * @brief Send packets as one SDU on a central's channel
+ *
+ * Copies the packets into an SDU buffer, waiting up to timeout for one of
+ * the channel's earlier SDUs to be freed; the packets can be reused once
+ * this returns.
+ * @param conn Connection of the central
+ * @param packets First of count packets, contiguous
+ * @param count 1 to l2cap_stream_sdu_packets(conn)
+ * @param timeout How long to wait for a free SDU buffer
+ * @return 0 on success, -EAGAIN if no buffer freed up in time, -ENOTCONN if
+ *         the channel is closed, other negative errno on failure
+ */
+int l2cap_stream_send(struct bt_conn *conn, const accel_packet_t *packets,
+                      size_t count, k_timeout_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* L2CAP_STREAM_H_ */
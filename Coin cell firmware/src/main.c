@@ -3,25 +3,78 @@
  * @brief Coin-Cell Wireless Accelerometer Firmware
  *
  * Architecture: Rev 3
- * - ISR-driven 1 kHz sampling with minimal work in ISR
+ * - ISR-driven sampling with minimal work in ISR
+ *   (1 kHz default, rate writable over BLE and kept in settings)
+ * - Any subset of accel/temp/gyro channels from one burst read (channel mask)
  * - High-priority reader thread for I2C reads
- * - Ring buffer for 1024 samples
+ *   (or MPU6050 FIFO drained at a watermark, CONFIG_ACCEL_ACQ_FIFO)
+ *   (or MPU6050 DATA_RDY interrupt instead of the tick, CONFIG_ACCEL_ACQ_DRDY)
+ *   (or TIMER + DPPI triggered TWIM EasyDMA blocks, CONFIG_ACCEL_ACQ_DPPI)
+ * - Lock-free SPSC ring of ready-to-send packets, CRC built per sample
  * - Burst transmission every ~1 second (coin-cell mode)
  * - Continuous streaming (lab mode with external power)
+ * - Optional L2CAP CoC stream for native centrals (CONFIG_ACCEL_L2CAP_STREAM)
+ * - Up to CONFIG_BT_MAX_CONN centrals at once, each reading at its own pace
+ * - Optional connectionless broadcast on a periodic advertising train
+ *   (CONFIG_ACCEL_PA_STREAM)
+ * - Optional on-device FFT spectra instead of raw samples
+ *   (CONFIG_ACCEL_SPECTRUM)
+ * - Optional per-window vibration features (RMS, peak, crest factor,
+ *   kurtosis, band RMS) alongside the stream (CONFIG_ACCEL_FEATURES)
+ * - Optional event-triggered capture: only a pre/post window around each
+ *   level, slope, RMS or band-energy event is sent (CONFIG_ACCEL_TRIGGER)
+ * - Optional FIR decimation from a faster sensor rate to the rate sent
+ *   (CONFIG_ACCEL_DECIMATE)
  */
 
 #include <dk_buttons_and_leds.h>
+#include <string.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/gatt.h>
+#include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/settings/settings.h>
 #include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/crc.h>
 
 #include "accel_service.h"
+#include "conn_tune.h"
+#if defined(CONFIG_ACCEL_CODEC)
+#include "accel_codec.h"
+#endif
+#include "spsc_ring.h"
+#if defined(CONFIG_ACCEL_ACQ_DPPI)
+#include "acq_dppi.h"
+#endif
+#if defined(CONFIG_ACCEL_L2CAP_STREAM)
+#include "l2cap_stream.h"
+#endif
+#if defined(CONFIG_ACCEL_PA_STREAM)
+#include "pa_stream.h"
+#endif
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+#include "flash_log.h"
+#endif
+#if defined(CONFIG_ACCEL_RETX)
+#include "retx.h"
+#endif
+#if defined(CONFIG_ACCEL_SPECTRUM)
+#include "spectrum.h"
+#endif
+#if defined(CONFIG_ACCEL_FEATURES)
+#include "features.h"
+#endif
+#if defined(CONFIG_ACCEL_TRIGGER)
+#include "trigger.h"
+#endif
+#if defined(CONFIG_ACCEL_DECIMATE)
+#include "decimate.h"
+#endif
 
 /* Coin-cell mode: reduce logging to save power */
 #ifdef CONFIG_COINCELL_MODE
@@ -34,21 +87,148 @@ LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
  * Configuration
  *===========================================================================*/
 
-#define SAMPLE_FREQ_HZ 1000
-#define SAMPLE_PERIOD_US (1000000 / SAMPLE_FREQ_HZ) /* 1000 µs */
+#define SAMPLE_FREQ_HZ SAMPLING_RATE_MAX_HZ /* Default until settings load */
+#define MPU6050_GYRO_RATE_HZ 1000 /* Divider base with the DLPF enabled */
 
 /* MPU6050 Registers */
 #define MPU6050_ADDR 0x68
 #define MPU6050_ACCEL_XOUT_H 0x3B
 #define MPU6050_PWR_MGMT_1 0x6B
+#define MPU6050_PWR_MGMT_2 0x6C
 #define MPU6050_SMPLRT_DIV 0x19
 #define MPU6050_CONFIG 0x1A
 #define MPU6050_ACCEL_CONFIG 0x1C
+#define MPU6050_FIFO_EN 0x23
+#define MPU6050_INT_PIN_CFG 0x37
+#define MPU6050_INT_ENABLE 0x38
+#define MPU6050_USER_CTRL 0x6A
+#define MPU6050_FIFO_COUNTH 0x72
+#define MPU6050_FIFO_R_W 0x74
+
+/* MPU6050 register bits */
+#define MPU6050_FIFO_EN_TEMP 0x80         /* FIFO_EN: queue TEMP_OUT */
+#define MPU6050_FIFO_EN_XG 0x40           /* FIFO_EN: queue GYRO_XOUT */
+#define MPU6050_FIFO_EN_YG 0x20           /* FIFO_EN: queue GYRO_YOUT */
+#define MPU6050_FIFO_EN_ZG 0x10           /* FIFO_EN: queue GYRO_ZOUT */
+#define MPU6050_FIFO_EN_ACCEL 0x08        /* FIFO_EN: queue ACCEL_*OUT */
+#define MPU6050_USER_CTRL_FIFO_EN 0x40    /* USER_CTRL: enable FIFO */
+#define MPU6050_USER_CTRL_FIFO_RESET 0x04 /* USER_CTRL: flush FIFO */
+#define MPU6050_INT_PIN_CFG_RD_CLEAR 0x10 /* INT_PIN_CFG: clear on any read */
+#define MPU6050_INT_ENABLE_DATA_RDY 0x01  /* INT_ENABLE: DATA_RDY_EN */
+
+/* CONFIG.DLPF_CFG and its accelerometer bandwidth */
+#define MPU6050_DLPF_184HZ 1
+#define MPU6050_DLPF_94HZ 2
+#define MPU6050_DLPF_44HZ 3
+#define MPU6050_DLPF_21HZ 4
+#define MPU6050_DLPF_10HZ 5
+#define MPU6050_DLPF_5HZ 6
+
+/* One raw sample: ACCEL_XOUT_H..GYRO_ZOUT_L at most, big-endian */
+#define RAW_FRAME_MAX (ACCEL_CH_COUNT * 2) /* 14 */
+
+/* MPU6050 FIFO geometry */
+#define MPU6050_FIFO_SIZE 1024
 
 /* Burst mode timing */
-#define SAMPLES_BEFORE_BURST                                                   \
-  250 /* 250 samples = ~0.25s latency (Compromise: Safe & Fast) */
-#define INTER_PACKET_DELAY_MS 15 /* Spread bursts to let I2C work in gaps */
+#define BURST_WINDOW_MS                                                        \
+  250 /* ~0.25s latency at any rate (Compromise: Safe & Fast) */
+
+/*============================================================================
+ * Sampling Configuration
+ *
+ * Everything derived from the output data rate and channel mask. Changed at
+ * runtime only by the reader thread (sampling_reconfigure), which owns the
+ * sensor bus.
+ *===========================================================================*/
+
+struct sampling_cfg {
+  uint16_t rate_hz;              /* Samples sent per second */
+  uint16_t decim;                /* Sensor samples per sample sent */
+  uint32_t period_us;            /* Sensor sample period */
+  uint8_t smplrt_div;            /* ODR = 1 kHz / (1 + SMPLRT_DIV) */
+  uint8_t dlpf_cfg;              /* Keeps the bandwidth below Nyquist */
+  uint8_t channel_mask;          /* ACCEL_CH_* channels transmitted */
+  uint8_t captured;              /* Channels in each raw frame, bit order */
+  uint8_t start_reg;             /* First register of each burst read */
+  uint8_t frame_size;            /* Raw frame bytes (2 per captured bit) */
+  uint16_t samples_per_packet;   /* Packet capacity for the mask */
+  uint16_t samples_before_burst; /* BURST_WINDOW_MS worth of samples */
+};
+
+static struct sampling_cfg sampling;
+
+/* Rate and mask requested over BLE, picked up by the reader thread
+ * (0 = none) */
+static atomic_t requested_rate_hz = ATOMIC_INIT(0);
+static atomic_t requested_mask = ATOMIC_INIT(0);
+
+static bool sampling_rate_valid(uint16_t rate_hz) {
+  return rate_hz >= SAMPLING_RATE_MIN_HZ && rate_hz <= SAMPLING_RATE_MAX_HZ &&
+         (MPU6050_GYRO_RATE_HZ % rate_hz) == 0;
+}
+
+static bool channel_mask_valid(uint8_t mask) {
+  return mask != 0 && (mask & ~ACCEL_CH_ALL) == 0;
+}
+
+static void sampling_cfg_compute(uint16_t rate_hz, uint8_t mask,
+                                 struct sampling_cfg *cfg) {
+  cfg->rate_hz = rate_hz;
+  cfg->channel_mask = mask;
+
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
+  /* FIFO_EN queues the accelerometer as one XYZ block, the rest per channel */
+  cfg->captured = (mask & ACCEL_CH_ACCEL_XYZ) ? (mask | ACCEL_CH_ACCEL_XYZ)
+                                              : mask;
+  cfg->start_reg = MPU6050_FIFO_R_W;
+#else
+  /* One burst read spanning the first to the last selected register */
+  uint8_t first = find_lsb_set(mask) - 1;
+  uint8_t last = find_msb_set(mask) - 1;
+
+  cfg->captured = GENMASK(last, first);
+  cfg->start_reg = MPU6050_ACCEL_XOUT_H + 2 * first;
+#endif
+  cfg->frame_size = 2 * POPCOUNT(cfg->captured);
+#if defined(CONFIG_ACCEL_PACKET_V4)
+  cfg->samples_per_packet = V4_DATA_SIZE / (2 * POPCOUNT(mask));
+#else
+  cfg->samples_per_packet = (mask == ACCEL_CH_ACCEL_XYZ)
+                                ? SAMPLES_PER_PACKET
+                                : PACKED_DATA_SIZE / (2 * POPCOUNT(mask));
+#endif
+
+  /* The decimator filters the sensor rate down to rate_hz */
+  cfg->decim = 1;
+#if defined(CONFIG_ACCEL_DECIMATE)
+  cfg->decim = decimate_factor(rate_hz, MPU6050_GYRO_RATE_HZ);
+#endif
+  uint32_t sensor_hz = (uint32_t)rate_hz * cfg->decim;
+
+  cfg->period_us = 1000000U / sensor_hz;
+  cfg->smplrt_div = (uint8_t)(MPU6050_GYRO_RATE_HZ / sensor_hz - 1);
+
+  /* Widest bandwidth that stays below half the ODR, 44 Hz at most unless the
+   * decimator does the band limiting */
+  if (cfg->decim > 1 && sensor_hz > 2 * 184) {
+    cfg->dlpf_cfg = MPU6050_DLPF_184HZ;
+  } else if (cfg->decim > 1 && sensor_hz > 2 * 94) {
+    cfg->dlpf_cfg = MPU6050_DLPF_94HZ;
+  } else if (sensor_hz > 2 * 44) {
+    cfg->dlpf_cfg = MPU6050_DLPF_44HZ;
+  } else if (sensor_hz > 2 * 21) {
+    cfg->dlpf_cfg = MPU6050_DLPF_21HZ;
+  } else if (sensor_hz > 2 * 10) {
+    cfg->dlpf_cfg = MPU6050_DLPF_10HZ;
+  } else {
+    cfg->dlpf_cfg = MPU6050_DLPF_5HZ;
+  }
+
+  /* Keep the burst latency constant, but always fill at least one packet */
+  cfg->samples_before_burst = MAX((uint32_t)rate_hz * BURST_WINDOW_MS / 1000U,
+                                  cfg->samples_per_packet);
+}
 
 /*============================================================================
  * Hardware Devices
@@ -56,18 +236,52 @@ LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
 static const struct device *i2c_dev;
 
+#if defined(CONFIG_ACCEL_ACQ_DRDY)
+/* MPU6050 INT pin, configured as DATA_RDY */
+static const struct gpio_dt_spec mpu6050_int =
+    GPIO_DT_SPEC_GET(DT_NODELABEL(mpu6050), int_gpios);
+static struct gpio_callback mpu6050_int_cb;
+#endif
+
 /*============================================================================
- * Ring Buffer (Shared between ISR/Thread and Burst Controller)
+ * Packet Ring (Reader thread produces, Burst Controller consumes)
+ *
+ * Slots are complete accel_packet_t, CRC included. The reader thread formats
+ * each sample straight into the open slot and commits it once closed, so the
+ * burst controller only has to notify.
  *===========================================================================*/
 
-static accel_sample_t ring_buffer[RING_BUFFER_SAMPLES];
-/* Spinlock to protect ring buffer indices from race conditions */
-static struct k_spinlock buffer_lock;
-static volatile uint16_t write_idx = 0;
-static volatile uint16_t read_idx = 0;
-static volatile uint16_t sample_counter = 0;
+/* Lock-free: only the reader thread pushes, only the burst controller pops */
+SPSC_RING_DEFINE(packet_ring, accel_packet_t, PACKET_RING_SLOTS);
+
+/* The slot being filled. Reader thread only. */
+struct packet_writer {
+  accel_packet_t *pkt; /* Reserved ring slot, NULL if none is open */
+  uint8_t *out;        /* Where the next sample goes */
+  uint16_t crc;        /* Running CRC16 of every byte before out */
+  uint16_t count;      /* Samples written */
+  uint16_t cap;        /* Samples that fit in this layout */
+  bool rev3;           /* Rev 3 samples, else packed or v4 */
+  uint32_t base_counter;
+  uint8_t channel_mask; /* sampling.channel_mask when opened */
+  uint16_t rate_hz;     /* sampling.rate_hz when opened */
+#if defined(CONFIG_ACCEL_CODEC)
+  struct accel_codec codec; /* Fills data[]; CRC is taken at close */
+#endif
+};
+
+static struct packet_writer writer;
+static uint8_t burst_seq = 0;       /* burst_id stamped on opened packets */
+static uint16_t window_packets = 0; /* Committed since the last burst signal */
+static volatile uint32_t sample_counter = 0; /* Rev 3 sends the low 16 bits */
 static volatile uint32_t burst_start_ms = 0;
 
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
+/* Sensor-clock position of the next FIFO frame (µs of uptime). Anchored when
+ * the FIFO is (re)started, then advanced by one ODR period per frame. */
+static uint64_t fifo_clock_us = 0;
+#endif
+
 /* Flag to pause sampling during heavy BLE activity (Coin-Cell only) */
 static volatile bool sampling_paused = false;
 
@@ -79,7 +293,13 @@ static volatile bool sampling_paused = false;
 K_SEM_DEFINE(sample_ready_sem, 0, K_SEM_MAX_LIMIT);
 K_SEM_DEFINE(burst_ready_sem, 0, K_SEM_MAX_LIMIT);
 
+/* Wakes a burst waiting on the link: given on every TX completion or freed
+ * SDU, and with every burst signal so a new window never waits for a slow
+ * central */
+K_SEM_DEFINE(tx_complete_sem, 0, K_SEM_MAX_LIMIT);
+
 static volatile uint16_t pending_timestamp_ms = 0;
+static volatile uint32_t pending_timestamp_us = 0; /* Uptime, low 32 bits */
 
 /*============================================================================
  * Statistics
@@ -91,14 +311,244 @@ static volatile uint32_t samples_overflowed =
 static uint32_t total_bursts = 0;
 static uint32_t packets_sent = 0;
 static uint32_t packets_failed = 0;
+static uint32_t packets_skipped = 0; /* Passed over for a lagging central */
+#if defined(CONFIG_ACCEL_RETX)
+static uint32_t packets_resent = 0; /* Retransmitted on request */
+#endif
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+static uint32_t packets_logged = 0; /* Stored while nobody listened */
+static uint32_t history_sent = 0;   /* Sent back from the log */
+#endif
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
+static uint32_t fifo_drains = 0;    /* Reader wakeups that moved data */
+static uint32_t fifo_overflows = 0; /* Sensor FIFO wrapped, frames lost */
+#endif
+#if defined(CONFIG_ACCEL_ACQ_DRDY)
+static uint32_t drdy_missed = 0; /* Conversions overwritten before read */
+
+/* DATA_RDY edges seen in the current drift window, and the RTC ticks of the
+ * first and last edge. Written from the GPIO ISR, consumed by diagnostics. */
+static struct k_spinlock drdy_lock;
+static uint32_t drdy_window_edges = 0;
+static int64_t drdy_window_first_ticks = 0;
+static int64_t drdy_window_last_ticks = 0;
+static int32_t drdy_drift_ppm = 0; /* Sensor ODR vs RTC, + = sensor fast */
+#endif
+
+/*============================================================================
+ * Subscribers
+ *
+ * One per connection slot (CONFIG_BT_MAX_CONN), indexed by bt_conn_index().
+ * Each central reads the packet ring through its own cursor, with its own
+ * TX credits, MTU and link estimate, so a slow one never holds back the
+ * others. Packets are built once: the stack copies every central's sends
+ * from the same ring slot, and a slot goes back to the reader thread once
+ * the last reading cursor has passed it. The ring tail is simply the lowest
+ * cursor, which keeps track of the readers left on each slot without a
+ * count per slot.
+ *
+ * The connection callbacks only fill in a slot and mark it joining or
+ * leaving; the burst controller, which owns the cursors, does the rest.
+ *===========================================================================*/
 
 /* MTU tracking - need >= 246 for 243-byte packets */
-static volatile bool mtu_ready = false;
-static volatile uint16_t current_mtu = 23; /* Default BLE MTU */
 #define REQUIRED_MTU 246 /* 243 payload + 3 ATT header (opcode + handle) */
 
+/* TX credits per central (see TX Pacing). The stack's TX contexts are shared
+ * by all connections: each central gets its own share, so it never holds
+ * one another central is waiting for. */
+#define TX_DEPTH_MIN 2
+#define TX_DEPTH_MAX (CONFIG_BT_CONN_TX_MAX / CONFIG_BT_MAX_CONN)
+
+BUILD_ASSERT(TX_DEPTH_MAX >= TX_DEPTH_MIN,
+             "CONFIG_BT_CONN_TX_MAX too small for CONFIG_BT_MAX_CONN");
+
+#define LINK_PPE_SHIFT 4 /* Packets per event, Q4 fixed point */
+#define LINK_PPE_INIT (1 << LINK_PPE_SHIFT) /* Until measured: 1 per event */
+
+enum subscriber_state {
+  SUB_FREE,    /* No connection */
+  SUB_JOINING, /* Connected, not yet taken in by the burst controller */
+  SUB_ACTIVE,
+  SUB_LEAVING, /* Disconnected, conn not yet released */
+};
+
+struct subscriber {
+  atomic_t state;       /* enum subscriber_state */
+  struct bt_conn *conn; /* Referenced unless SUB_FREE */
+  volatile bool mtu_ready;
+  volatile uint16_t mtu;
+  volatile uint16_t conn_interval_ms; /* Rounded up; 0 until connected */
+  atomic_t link_ppe_q4; /* Measured packets per connection event (Q4) */
+
+  /* TX credits */
+  atomic_t tx_in_flight;
+  atomic_t tx_depth;
+  uint32_t tx_sent_ms[TX_DEPTH_MAX]; /* Send time, by sequence number */
+  atomic_t tx_pending[TX_DEPTH_MAX]; /* seq + 1 until credited, or 0 */
+  uint32_t tx_seq;
+
+  /* Burst controller only */
+  bool reading;        /* Holds the ring slots from cursor on */
+  bool in_burst;       /* Sending up to burst_end */
+  bool aborted;        /* The burst was cut short */
+  uint32_t cursor;     /* Next ring index to send */
+  uint32_t burst_end;  /* Ring index the burst sends up to */
+  uint16_t burst_sent; /* Packets sent since the burst started */
+  uint32_t burst_start_ms;
+  uint32_t last_tx_ms; /* Last send, or the burst start */
+};
+
+static struct subscriber subscribers[CONFIG_BT_MAX_CONN];
+static atomic_t conn_count = ATOMIC_INIT(0);
+
+static struct subscriber *subscriber_get(struct bt_conn *conn) {
+  return &subscribers[bt_conn_index(conn)];
+}
+
+static uint8_t subscriber_index(const struct subscriber *s) {
+  return (uint8_t)(s - subscribers);
+}
+
+/* Native centrals on the L2CAP stream take priority over GATT */
+static bool subscriber_l2cap(const struct subscriber *s) {
+#if defined(CONFIG_ACCEL_L2CAP_STREAM)
+  return l2cap_stream_ready(s->conn);
+#else
+  ARG_UNUSED(s);
+  return false;
+#endif
+}
+
+/* True if s takes live data now, over L2CAP or notifications */
+static bool subscriber_streaming(const struct subscriber *s) {
+  if (atomic_get(&s->state) != SUB_ACTIVE) {
+    return false;
+  }
+  return subscriber_l2cap(s) ||
+         (s->mtu_ready && accel_service_data_notify_enabled(s->conn));
+}
+
+/*============================================================================
+ * Adaptive Burst Sizing
+ *
+ * A burst has to finish before the reader thread fills the ring space that
+ * was free when it started. With N packets queued, the link draining C
+ * packets/s and the sensor producing P packets/s, that is
+ * N / C < (slots - N) / P, i.e. N < slots * C / (C + P).
+ *
+ * C is the packets per connection event measured over past bursts, over the
+ * interval reported by le_param_updated. A slow central shrinks the window;
+ * a fast one stretches it in coin-cell mode, so the radio sleeps longer
+ * between bursts. Lab mode keeps BURST_WINDOW_MS as the upper bound. With
+ * several centrals reading, slots only free up as fast as the slowest one
+ * sends, so that is the C the window is sized for.
+ *===========================================================================*/
+
+#define BURST_RING_MARGIN 2 /* The open slot, plus one packet of slack */
+#define BURST_SLOTS (PACKET_RING_SLOTS - BURST_RING_MARGIN)
+
+/* Packets in the window being filled, 0 = recompute. Written by the reader
+ * thread only. */
+static uint16_t burst_window_packets = 0;
+
+/* One central's drain rate in packets/s (Q4), 0 if not connected */
+static uint32_t subscriber_rate_q4(const struct subscriber *s) {
+  uint16_t interval_ms = s->conn_interval_ms;
+
+  if (interval_ms == 0) {
+    return 0;
+  }
+  return (uint32_t)atomic_get(&s->link_ppe_q4) * 1000U / interval_ms;
+}
+
+/* Ring drain rate in packets/s (Q4) for the reader thread's window sizing.
+ * Which centrals read the ring is burst controller state, so the controller
+ * works it out and hands it over here. */
+static atomic_t link_rate_q4 = ATOMIC_INIT(0);
+
+/* Publish the slowest reading central's rate, 0 if none is. Burst
+ * controller, whenever who reads or a link estimate changes. */
+static void link_rate_publish(void) {
+  uint32_t c = 0;
+
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    const struct subscriber *s = &subscribers[i];
+    uint32_t rate;
+
+    if (!s->reading) {
+      continue;
+    }
+    rate = subscriber_rate_q4(s);
+    if (rate > 0 && (c == 0 || rate < c)) {
+      c = rate;
+    }
+  }
+  atomic_set(&link_rate_q4, (atomic_val_t)c);
+}
+
+/* Sensor fill rate in packets/s (Q4) */
+static uint32_t fill_rate_q4(void) {
+  return ((uint32_t)sampling.rate_hz << LINK_PPE_SHIFT) /
+         sampling.samples_per_packet;
+}
+
+/* Packets to collect before the next burst. Reader thread, per window. */
+static uint16_t burst_window_compute(void) {
+  uint32_t lab = DIV_ROUND_UP(sampling.samples_before_burst,
+                              sampling.samples_per_packet);
+  uint32_t c = (uint32_t)atomic_get(&link_rate_q4);
+  uint32_t n;
+
+  if (c == 0) {
+    /* Nothing to measure against; bursts are drained anyway */
+    n = lab;
+  } else {
+    n = BURST_SLOTS * c / (c + fill_rate_q4());
+    if (accel_service_get_mode() != MODE_COINCELL_BURST) {
+      n = MIN(n, lab);
+    }
+  }
+  return (uint16_t)CLAMP(n, 1U, BURST_SLOTS);
+}
+
+/* Packets one burst to s may send: those queued, plus what the sensor adds
+ * while they go out. Burst controller. */
+static uint16_t burst_packet_count(const struct subscriber *s,
+                                   uint16_t queued) {
+  uint32_t c = subscriber_rate_q4(s);
+  uint32_t n = queued;
+
+  if (c > 0) {
+    n += DIV_ROUND_UP(queued * fill_rate_q4(), c);
+  }
+  return (uint16_t)CLAMP(n, 1U, PACKET_RING_SLOTS);
+}
+
+/* Fold one burst into the packets-per-event estimate. Bursts shorter than an
+ * interval only prove a lower bound, and are counted as one interval. */
+static void link_capacity_update(struct subscriber *s, uint16_t sent,
+                                 uint32_t elapsed_ms) {
+  uint16_t interval_ms = s->conn_interval_ms;
+
+  if (interval_ms == 0 || sent < 2) {
+    return;
+  }
+
+  uint32_t sample = ((uint32_t)sent << LINK_PPE_SHIFT) * interval_ms /
+                    MAX(elapsed_ms, interval_ms);
+  uint32_t ppe = atomic_get(&s->link_ppe_q4);
+
+  /* EWMA, 1/4 weight on the new burst */
+  atomic_set(&s->link_ppe_q4, MAX((3 * ppe + sample) / 4, 1U));
+  link_rate_publish();
+}
+
 /*============================================================================
  * Timer ISR - Minimal work, deterministic timing
+ *
+ * Timer mode: fires once per sample.
+ * FIFO mode: fires once per watermark; the sensor paces the samples.
  *===========================================================================*/
 
 static void sample_timer_handler(struct k_timer *timer) {
@@ -109,8 +559,11 @@ static void sample_timer_handler(struct k_timer *timer) {
     return;
   }
 
+#if !defined(CONFIG_ACCEL_ACQ_FIFO)
   /* Capture timestamp BEFORE any variable latency */
+  pending_timestamp_us = (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
   pending_timestamp_ms = (uint16_t)(k_uptime_get_32() - burst_start_ms);
+#endif
 
   /* Signal reader thread - NO I2C work here! */
   k_sem_give(&sample_ready_sem);
@@ -118,6 +571,66 @@ static void sample_timer_handler(struct k_timer *timer) {
 
 K_TIMER_DEFINE(sample_timer, sample_timer_handler, NULL);
 
+#if defined(CONFIG_ACCEL_ACQ_DRDY)
+/*============================================================================
+ * MPU6050 DATA_RDY ISR - replaces the timer tick in DRDY mode
+ *
+ * Same minimal work as sample_timer_handler, plus the edge bookkeeping the
+ * drift statistic needs.
+ *===========================================================================*/
+
+static void mpu6050_drdy_handler(const struct device *port,
+                                 struct gpio_callback *cb,
+                                 gpio_port_pins_t pins) {
+  ARG_UNUSED(port);
+  ARG_UNUSED(cb);
+  ARG_UNUSED(pins);
+
+  int64_t now_ticks = k_uptime_ticks();
+
+  k_spinlock_key_t key = k_spin_lock(&drdy_lock);
+  if (drdy_window_edges == 0) {
+    drdy_window_first_ticks = now_ticks;
+  }
+  drdy_window_last_ticks = now_ticks;
+  drdy_window_edges++;
+  k_spin_unlock(&drdy_lock, key);
+
+  if (sampling_paused) {
+    return;
+  }
+
+  /* Capture timestamp BEFORE any variable latency */
+  pending_timestamp_us = (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+  pending_timestamp_ms = (uint16_t)(k_uptime_get_32() - burst_start_ms);
+
+  /* Signal reader thread - NO I2C work here! */
+  k_sem_give(&sample_ready_sem);
+}
+
+/*
+ * Close the current drift window and update drdy_drift_ppm.
+ *
+ * N edges span (N - 1) sensor periods. Comparing that nominal span with the
+ * RTC span between the first and last edge gives the ODR error in ppm.
+ */
+static void drdy_update_drift(void) {
+  k_spinlock_key_t key = k_spin_lock(&drdy_lock);
+  uint32_t edges = drdy_window_edges;
+  int64_t span_ticks = drdy_window_last_ticks - drdy_window_first_ticks;
+  drdy_window_edges = 0;
+  k_spin_unlock(&drdy_lock, key);
+
+  if (edges < 2 || span_ticks <= 0) {
+    return;
+  }
+
+  int64_t rtc_us = (int64_t)k_ticks_to_us_floor64(span_ticks);
+  int64_t sensor_us = (int64_t)(edges - 1) * sampling.period_us;
+  drdy_drift_ppm = (int32_t)(((rtc_us - sensor_us) * 1000000LL) / rtc_us);
+}
+#endif /* CONFIG_ACCEL_ACQ_DRDY */
+
 /*============================================================================
  * Diagnostics Timer
  *===========================================================================*/
@@ -125,6 +638,25 @@ K_TIMER_DEFINE(sample_timer, sample_timer_handler, NULL);
 static void diagnostics_timer_handler(struct k_timer *timer) {
   LOG_INF("STATS: Samples=%u | Dropped=%u | Pkts Sent=%u | Failed=%u",
           total_samples, samples_overflowed, packets_sent, packets_failed);
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
+  LOG_INF("FIFO: Drains=%u | Overflows=%u", fifo_drains, fifo_overflows);
+#endif
+#if defined(CONFIG_ACCEL_ACQ_DRDY)
+  drdy_update_drift();
+  LOG_INF("DRDY: Missed=%u | ODR drift vs RTC=%d ppm", drdy_missed,
+          drdy_drift_ppm);
+#endif
+#if defined(CONFIG_ACCEL_ACQ_DPPI)
+  LOG_INF("DPPI: Block overruns=%u", acq_dppi_overruns());
+#endif
+  LOG_INF("LINK: Centrals=%u | Skipped=%u", (uint32_t)atomic_get(&conn_count),
+          packets_skipped);
+#if defined(CONFIG_ACCEL_RETX)
+  LOG_INF("RETX: Resent=%u", packets_resent);
+#endif
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+  LOG_INF("LOG: Stored=%u | Sent back=%u", packets_logged, history_sent);
+#endif
 }
 
 K_TIMER_DEFINE(diagnostics_timer, diagnostics_timer_handler, NULL);
@@ -136,197 +668,1446 @@ K_TIMER_DEFINE(diagnostics_timer, diagnostics_timer_handler, NULL);
  * Runs at priority 0 (highest) to minimize latency after ISR signal.
  *===========================================================================*/
 
-static void sample_reader_thread_fn(void *p1, void *p2, void *p3) {
-  ARG_UNUSED(p1);
-  ARG_UNUSED(p2);
-  ARG_UNUSED(p3);
+/* Reserve a ring slot and write the header for a packet starting with the
+ * current sample. Returns false if the ring is full. */
+static bool packet_open(uint16_t timestamp_ms, uint32_t timestamp_us) {
+  accel_packet_t *pkt;
 
-  uint8_t raw_data[6];
-  int ret;
+  if (spsc_ring_reserve(&packet_ring, (void **)&pkt, 1) == 0) {
+    return false;
+  }
 
-  LOG_INF("Sample reader thread started");
+  writer.pkt = pkt;
+  writer.count = 0;
+  writer.cap = sampling.samples_per_packet;
+  writer.base_counter = sample_counter;
+  writer.channel_mask = sampling.channel_mask;
+  writer.rate_hz = sampling.rate_hz;
+  writer.rev3 = !IS_ENABLED(CONFIG_ACCEL_PACKET_V4) &&
+                writer.channel_mask == ACCEL_CH_ACCEL_XYZ;
+
+  if (writer.rev3) {
+    pkt->burst_id = burst_seq & ACCEL_BURST_ID_MASK;
+    writer.out = (uint8_t *)pkt->samples;
+  } else if (IS_ENABLED(CONFIG_ACCEL_PACKET_V4)) {
+    accel_v4_payload_t *v4 = &pkt->v4;
+
+    /* Header assumes a full packet; packet_close() redoes it otherwise */
+    pkt->burst_id = (burst_seq & ACCEL_BURST_ID_MASK) | ACCEL_BURST_ID_PACKED;
+    v4->channel_mask = writer.channel_mask | ACCEL_PACKED_V4;
+    v4->sample_count = (uint8_t)writer.cap;
+    v4->rate_hz = writer.rate_hz;
+    v4->base_counter = writer.base_counter;
+    v4->base_timestamp_us = timestamp_us;
+    writer.out = v4->data;
+#if defined(CONFIG_ACCEL_CODEC)
+    /* Capacity depends on the data: the codec says when it is full */
+    writer.cap = ACCEL_CODEC_SAMPLES_MAX;
+    v4->rate_hz |= ACCEL_RATE_CODED;
+    accel_codec_begin(&writer.codec, v4->data, sizeof(v4->data),
+                      POPCOUNT(writer.channel_mask));
+#endif
+  } else {
+    accel_packed_payload_t *pp = &pkt->packed;
+
+    /* Header assumes a full packet; packet_close() redoes it otherwise */
+    pkt->burst_id = (burst_seq & ACCEL_BURST_ID_MASK) | ACCEL_BURST_ID_PACKED;
+    pp->channel_mask = writer.channel_mask;
+    pp->sample_count = (uint8_t)writer.cap;
+    pp->rate_hz = writer.rate_hz;
+    pp->base_counter = (uint16_t)writer.base_counter;
+    pp->base_timestamp_ms = timestamp_ms;
+    writer.out = pp->data;
+  }
 
-  while (1) {
-    /* Wait for ISR signal */
-    k_sem_take(&sample_ready_sem, K_FOREVER);
+  writer.crc = crc16_ccitt(0xFFFF, (const uint8_t *)pkt,
+                           writer.out - (uint8_t *)pkt);
+  return true;
+}
 
-    /* Capture timestamp locally to avoid race with ISR */
-    uint16_t local_timestamp = pending_timestamp_ms;
+/*
+ * Finish the open packet and hand it to the burst controller.
+ *
+ * Full packets only need the padding folded into the CRC. A packet cut short
+ * by a mask or rate change, or a counter gap, goes out in the packed (or v4)
+ * layout with its real sample count, so its CRC is recomputed from scratch.
+ * So does every coded packet.
+ */
+static void packet_close(void) {
+  accel_packet_t *pkt = writer.pkt;
+  accel_packed_payload_t *pp = &pkt->packed;
+  uint8_t *data_end = (uint8_t *)&pkt->crc16; /* Packed and v4 data alike */
 
-    /* Ring buffer overflow protection: drop sample if full */
-    uint16_t samples_pending = write_idx - read_idx;
-    if (samples_pending >= RING_BUFFER_SAMPLES) {
-      samples_overflowed++;
-      continue; /* Drop THIS sample - never block ISR/sampling */
+#if defined(CONFIG_ACCEL_CODEC)
+  writer.out = pkt->v4.data + accel_codec_finish(&writer.codec);
+#endif
+
+  if (writer.count == writer.cap && !IS_ENABLED(CONFIG_ACCEL_CODEC)) {
+    if (!writer.rev3) {
+      size_t pad = data_end - writer.out;
+
+      memset(writer.out, 0, pad);
+      writer.crc = crc16_ccitt(writer.crc, writer.out, pad);
+    }
+    pkt->crc16 = writer.crc;
+  } else {
+    if (writer.rev3) {
+      /* Rev 3 needs all 24 samples: repack what we have (via the stack, the
+       * two layouts overlap) */
+      uint8_t xyz[(SAMPLES_PER_PACKET - 1) * 6];
+      uint16_t base_timestamp_ms = pkt->samples[0].rel_timestamp_ms;
+
+      for (uint16_t s = 0; s < writer.count; s++) {
+        sys_put_le16((uint16_t)pkt->samples[s].accel_x, &xyz[s * 6]);
+        sys_put_le16((uint16_t)pkt->samples[s].accel_y, &xyz[s * 6 + 2]);
+        sys_put_le16((uint16_t)pkt->samples[s].accel_z, &xyz[s * 6 + 4]);
+      }
+      pkt->burst_id |= ACCEL_BURST_ID_PACKED;
+      pp->channel_mask = ACCEL_CH_ACCEL_XYZ;
+      pp->rate_hz = writer.rate_hz;
+      pp->base_counter = (uint16_t)writer.base_counter;
+      pp->base_timestamp_ms = base_timestamp_ms;
+      memcpy(pp->data, xyz, writer.count * 6);
+      writer.out = pp->data + writer.count * 6;
+    }
+    if (IS_ENABLED(CONFIG_ACCEL_PACKET_V4)) {
+      pkt->v4.sample_count = (uint8_t)writer.count;
+    } else {
+      pp->sample_count = (uint8_t)writer.count;
     }
+    memset(writer.out, 0, data_end - writer.out);
+    pkt->crc16 = crc16_ccitt(0xFFFF, (const uint8_t *)pkt,
+                             ACCEL_PACKET_SIZE - 2);
+  }
 
-    /* Read accelerometer data via I2C - this takes ~300µs */
-    ret = i2c_burst_read(i2c_dev, MPU6050_ADDR, MPU6050_ACCEL_XOUT_H, raw_data,
-                         6);
-    if (ret < 0) {
-      LOG_WRN("I2C read failed: %d", ret);
-      continue;
+  spsc_ring_commit(&packet_ring, 1);
+  writer.pkt = NULL;
+
+  /* One signal per burst window; packets opened after it get the next id.
+   * Counted in slots: a packet cut short takes one all the same. */
+  if (burst_window_packets == 0) {
+    burst_window_packets = burst_window_compute();
+  }
+  if (++window_packets >= burst_window_packets) {
+    window_packets = 0;
+    burst_seq++;
+    k_sem_give(&burst_ready_sem);
+    k_sem_give(&tx_complete_sem);
+    burst_window_packets = burst_window_compute();
+  }
+}
+
+/* True if the next sample has somewhere to go */
+static bool packet_writer_ready(void) {
+  return writer.pkt != NULL || spsc_ring_free_space(&packet_ring) > 0;
+}
+
+#if defined(CONFIG_ACCEL_SPECTRUM) || defined(CONFIG_ACCEL_FEATURES) ||    \
+    defined(CONFIG_ACCEL_TRIGGER)
+/* Accelerometer X, Y, Z of one raw frame, 0 for axes not captured */
+static void raw_accel_xyz(const uint8_t *raw, int16_t xyz[3]) {
+  /* Accel bits are the lowest: each captured axis precedes other channels */
+  for (uint8_t c = 0; c < 3; c++) {
+    xyz[c] = 0;
+    if (sampling.captured & BIT(c)) {
+      xyz[c] = (int16_t)sys_get_be16(raw);
+      raw += 2;
     }
+  }
+}
+#endif
+
+#if defined(CONFIG_ACCEL_SPECTRUM)
+/* Hand the accelerometer axes of one raw frame to the FFT blocks */
+static void spectrum_feed(const uint8_t *raw) {
+  int16_t xyz[3];
+
+  raw_accel_xyz(raw, xyz);
+  spectrum_push(xyz, sampling.channel_mask & ACCEL_CH_ACCEL_XYZ,
+                sampling.rate_hz, sample_counter);
+}
+#endif
+
+#if defined(CONFIG_ACCEL_FEATURES)
+/* Update the window statistics with the accelerometer axes of one frame */
+static void features_feed(const uint8_t *raw) {
+  int16_t xyz[3];
+
+  raw_accel_xyz(raw, xyz);
+  features_push(xyz, sampling.channel_mask & ACCEL_CH_ACCEL_XYZ,
+                sampling.rate_hz, sample_counter);
+}
+#endif
+
+#if defined(CONFIG_ACCEL_TRIGGER)
+/* Run the trigger condition on the accelerometer axes of one frame */
+static void trigger_feed(const uint8_t *raw) {
+  int16_t xyz[3];
 
-    /* Pack sample into ring buffer - Protected by Spinlock */
-    k_spinlock_key_t key = k_spin_lock(&buffer_lock);
+  raw_accel_xyz(raw, xyz);
+  trigger_push(xyz, sampling.channel_mask & ACCEL_CH_ACCEL_XYZ,
+               sampling.rate_hz, sample_counter);
+}
+#endif
 
-    uint16_t idx = write_idx & RING_BUFFER_MASK;
-    ring_buffer[idx].sample_counter = sample_counter;
-    ring_buffer[idx].rel_timestamp_ms = local_timestamp;
-    ring_buffer[idx].accel_x = (int16_t)((raw_data[0] << 8) | raw_data[1]);
-    ring_buffer[idx].accel_y = (int16_t)((raw_data[2] << 8) | raw_data[3]);
-    ring_buffer[idx].accel_z = (int16_t)((raw_data[4] << 8) | raw_data[5]);
+/* Unpack one big-endian raw frame (sampling.captured layout) into the open
+ * packet, updating its CRC. timestamp_ms is relative to burst_start_ms (Rev 3
+ * and packed), timestamp_us the uptime (v4). Returns false if the ring was
+ * full and the sample was dropped. In spectrum mode the frame goes to the
+ * FFT instead and no packet is formed. The features and the trigger see
+ * every frame read. */
+static bool ring_push_sample(uint16_t timestamp_ms, uint32_t timestamp_us,
+                             const uint8_t *raw) {
+#if defined(CONFIG_ACCEL_FEATURES)
+  features_feed(raw);
+#endif
+#if defined(CONFIG_ACCEL_TRIGGER)
+  trigger_feed(raw);
+#endif
 
-    write_idx++;
+  if (IS_ENABLED(CONFIG_ACCEL_SPECTRUM)) {
+#if defined(CONFIG_ACCEL_SPECTRUM)
+    spectrum_feed(raw);
+#endif
     sample_counter++;
     total_samples++;
+    return true;
+  }
 
-    /* Check if buffer is full (time for burst) */
-    samples_pending = write_idx - read_idx;
-    k_spin_unlock(&buffer_lock, key);
+  /* A sample that cannot continue the open packet closes it */
+  if (writer.pkt &&
+      (writer.channel_mask != sampling.channel_mask ||
+       writer.rate_hz != sampling.rate_hz ||
+       sample_counter != writer.base_counter + writer.count)) {
+    packet_close();
+  }
+
+  /* Ring buffer overflow protection: drop sample if full */
+  if (!writer.pkt && !packet_open(timestamp_ms, timestamp_us)) {
+    samples_overflowed++;
+    return false; /* Drop THIS sample - never block ISR/sampling */
+  }
+
+  uint8_t *start = writer.out;
+
+  if (writer.rev3) {
+    accel_sample_t *smp = (accel_sample_t *)writer.out;
+
+    smp->sample_counter = (uint16_t)sample_counter;
+    smp->rel_timestamp_ms = timestamp_ms;
+    /* XYZ are always the first three captured channels */
+    smp->accel_x = (int16_t)sys_get_be16(&raw[0]);
+    smp->accel_y = (int16_t)sys_get_be16(&raw[2]);
+    smp->accel_z = (int16_t)sys_get_be16(&raw[4]);
+    writer.out += sizeof(*smp);
+  } else if (IS_ENABLED(CONFIG_ACCEL_CODEC)) {
+#if defined(CONFIG_ACCEL_CODEC)
+    int16_t vals[ACCEL_CH_COUNT];
+    uint8_t n = 0;
+
+    for (uint8_t c = 0; c < ACCEL_CH_COUNT; c++) {
+      if (!(sampling.captured & BIT(c))) {
+        continue;
+      }
+      if (writer.channel_mask & BIT(c)) {
+        vals[n++] = (int16_t)sys_get_be16(raw);
+      }
+      raw += 2;
+    }
 
-    if (samples_pending >= SAMPLES_BEFORE_BURST) {
-      k_sem_give(&burst_ready_sem);
+    /* Did not fit: it starts the next packet, where it always fits */
+    if (!accel_codec_put(&writer.codec, vals)) {
+      packet_close();
+      if (!packet_open(timestamp_ms, timestamp_us)) {
+        samples_overflowed++;
+        return false;
+      }
+      accel_codec_put(&writer.codec, vals);
     }
+#endif
+  } else {
+    for (uint8_t c = 0; c < ACCEL_CH_COUNT; c++) {
+      if (!(sampling.captured & BIT(c))) {
+        continue;
+      }
+      if (writer.channel_mask & BIT(c)) {
+        sys_put_le16(sys_get_be16(raw), writer.out);
+        writer.out += 2;
+      }
+      raw += 2;
+    }
+  }
+
+  /* Coded packets get their CRC at close */
+  if (!IS_ENABLED(CONFIG_ACCEL_CODEC)) {
+    writer.crc = crc16_ccitt(writer.crc, start, writer.out - start);
+  }
+  writer.count++;
+  sample_counter++;
+  total_samples++;
+
+  if (writer.count == writer.cap) {
+    packet_close();
   }
+  return true;
 }
 
-K_THREAD_DEFINE(sample_reader, 1024, sample_reader_thread_fn, NULL, NULL, NULL,
-                0, 0, 0); /* Priority 0 = highest */
+#if defined(CONFIG_ACCEL_ACQ_FIFO) || defined(CONFIG_ACCEL_ACQ_DPPI)
+/* Rev 3 timestamp of a sample taken at uptime sample_us. Frames buffered
+ * before burst_start_ms was last reset (on connect) would wrap to ~65 s:
+ * they are stamped 0 instead. */
+static uint16_t burst_offset_ms(uint64_t sample_us) {
+  int32_t offset = (int32_t)((uint32_t)(sample_us / 1000U) - burst_start_ms);
 
-/*============================================================================
- * Burst Controller Thread
- *
- * Waits for buffer to fill, then transmits all packets.
- * In coin-cell mode, this fires every ~1 second.
- * In lab mode, this fires more frequently (smaller batches).
- *===========================================================================*/
+  return (uint16_t)MAX(offset, 0);
+}
+#endif
 
-static accel_packet_t tx_packet; /* Static to avoid stack allocation */
+/* True if frames go through the decimator, which needs every one of them */
+static bool sampling_decimated(void) {
+  return IS_ENABLED(CONFIG_ACCEL_DECIMATE) && sampling.decim > 1;
+}
 
-static void burst_controller_thread_fn(void *p1, void *p2, void *p3) {
-  ARG_UNUSED(p1);
-  ARG_UNUSED(p2);
-  ARG_UNUSED(p3);
+/* Take one raw frame at the sensor rate. Decimated samples are stamped at
+ * the middle of the filter span that made them, the filter delay before the
+ * frame completing them. The delay (up to ~400 ms at factor 20) outlasts a
+ * burst window, so Rev 3 stamps that would fall before burst_start_ms are
+ * clamped to 0 like burst_offset_ms() does; the v4 stamp is absolute. */
+static void sample_push(uint16_t timestamp_ms, uint32_t timestamp_us,
+                        const uint8_t *raw) {
+  if (sampling_decimated()) {
+#if defined(CONFIG_ACCEL_DECIMATE)
+    uint8_t frame[RAW_FRAME_MAX];
+
+    if (!decimate_push(raw, frame)) {
+      return;
+    }
 
-  static uint8_t burst_id = 0;
-  int err;
+    uint32_t delay_us = decimate_delay() * sampling.period_us;
+    uint32_t delay_ms = delay_us / 1000U;
 
-  LOG_INF("Burst controller thread started");
+    ring_push_sample((timestamp_ms > delay_ms)
+                         ? (uint16_t)(timestamp_ms - delay_ms)
+                         : 0,
+                     timestamp_us - delay_us, frame);
+#endif
+    return;
+  }
+  ring_push_sample(timestamp_ms, timestamp_us, raw);
+}
 
-  while (1) {
-    /* Wait for buffer to fill */
-    k_sem_take(&burst_ready_sem, K_FOREVER);
+#if defined(CONFIG_ACCEL_ACQ_DRDY) || defined(CONFIG_ACCEL_ACQ_DPPI)
+/* Samples sent that n lost sensor frames would have made */
+static uint32_t samples_lost(uint32_t n) {
+#if defined(CONFIG_ACCEL_DECIMATE)
+  if (sampling_decimated()) {
+    return decimate_skip(n);
+  }
+#endif
+  return n;
+}
+#endif
 
-    if (!accel_service_data_notify_enabled()) {
-      /* Not connected or notifications not enabled - silently drain buffer */
-      read_idx = write_idx;
-      continue;
-    }
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
 
-    if (!mtu_ready) {
-      /* MTU exchange not complete yet - drain buffer and wait */
-      LOG_WRN("MTU not ready (current: %u, need: %u), draining %u samples",
-              current_mtu, REQUIRED_MTU, write_idx - read_idx);
-      read_idx = write_idx;
-      continue;
-    }
+#define FIFO_DRAIN_CHUNK_SAMPLES CONFIG_ACCEL_FIFO_DRAIN_CHUNK_SAMPLES
+
+/* Clock errors larger than this many periods are snapped, smaller ones are
+ * slewed out by 1/FIFO_CLOCK_SLEW per watermark */
+#define FIFO_CLOCK_SNAP_PERIODS 4
+#define FIFO_CLOCK_SLEW 8
+
+static int mpu6050_fifo_reset(void);
+
+/*
+ * Pull the sensor clock towards uptime. The newest of the frames in the
+ * FIFO was sampled during the last period, so the oldest sat about
+ * (frames - 1/2) periods before now. Read latency jitters that estimate, so
+ * small errors are only slewed; this is what tracks the MPU6050 oscillator,
+ * which can be a few percent off its nominal rate.
+ */
+static void fifo_clock_anchor(uint64_t now_us, uint16_t frames) {
+  int64_t period = sampling.period_us;
+  int64_t anchor = (int64_t)now_us - frames * period + period / 2;
+  int64_t err = anchor - (int64_t)fifo_clock_us;
+
+  if (err > FIFO_CLOCK_SNAP_PERIODS * period ||
+      err < -FIFO_CLOCK_SNAP_PERIODS * period) {
+    fifo_clock_us = (uint64_t)anchor;
+  } else {
+    fifo_clock_us = (uint64_t)((int64_t)fifo_clock_us + err / FIFO_CLOCK_SLEW);
+  }
+}
+
+/*
+ * Drain everything the MPU6050 FIFO currently holds.
+ *
+ * One 2-byte FIFO_COUNT read, then ceil(frames / chunk) burst reads of
+ * FIFO_R_W. Each frame is stamped from its position in the FIFO (one ODR
+ * period after the previous frame), not from when the I2C read happened,
+ * on a clock re-anchored to uptime at every watermark.
+ */
+static void fifo_drain(void) {
+  static uint8_t fifo_buf[FIFO_DRAIN_CHUNK_SAMPLES * RAW_FRAME_MAX];
+  uint8_t frame_size = sampling.frame_size;
+  uint8_t count_raw[2];
+  int ret;
+
+  /* Before the count read: every frame counted was sampled by now */
+  uint64_t now_us = k_ticks_to_us_floor64(k_uptime_ticks());
+
+  ret = i2c_burst_read(i2c_dev, MPU6050_ADDR, MPU6050_FIFO_COUNTH, count_raw,
+                       sizeof(count_raw));
+  if (ret < 0) {
+    LOG_WRN("FIFO count read failed: %d", ret);
+    return;
+  }
+
+  /* 1024 is rarely a multiple of the frame: more than the last whole frame
+   * means the FIFO wrapped */
+  uint16_t fifo_bytes = (count_raw[0] << 8) | count_raw[1];
+  if (fifo_bytes > MPU6050_FIFO_SIZE - (MPU6050_FIFO_SIZE % frame_size)) {
+    /* FIFO wrapped: frame alignment is lost, flush and re-anchor */
+    fifo_overflows++;
+    LOG_WRN("MPU6050 FIFO overflow (%u bytes), resetting", fifo_bytes);
+    mpu6050_fifo_reset();
+    return;
+  }
+
+  uint16_t frames = fifo_bytes / frame_size;
+  if (frames == 0) {
+    return;
+  }
+  fifo_drains++;
+  fifo_clock_anchor(now_us, frames);
+
+  while (frames > 0) {
+    uint16_t chunk = MIN(frames, FIFO_DRAIN_CHUNK_SAMPLES);
+
+    ret = i2c_burst_read(i2c_dev, MPU6050_ADDR, MPU6050_FIFO_R_W, fifo_buf,
+                         chunk * frame_size);
+    if (ret < 0) {
+      /* Partial frame reads would misalign the FIFO - start over */
+      LOG_WRN("FIFO read failed: %d", ret);
+      mpu6050_fifo_reset();
+      return;
+    }
+
+    for (uint16_t f = 0; f < chunk; f++) {
+      uint16_t ts_ms = burst_offset_ms(fifo_clock_us);
+      uint32_t ts_us = (uint32_t)fifo_clock_us;
+
+      fifo_clock_us += sampling.period_us;
+      sample_push(ts_ms, ts_us, &fifo_buf[f * frame_size]);
+    }
+    frames -= chunk;
+  }
+}
+
+#endif /* CONFIG_ACCEL_ACQ_FIFO */
+
+static void sampling_reconfigure(uint16_t rate_hz, uint8_t mask);
+
+/* Apply a rate or mask written over BLE, if any. Returns true if one was
+ * pending. */
+static bool sampling_check_request(void) {
+  uint16_t rate_hz = (uint16_t)atomic_set(&requested_rate_hz, 0);
+  uint8_t mask = (uint8_t)atomic_set(&requested_mask, 0);
+
+  if (rate_hz == 0 && mask == 0) {
+    return false;
+  }
+  sampling_reconfigure(rate_hz ? rate_hz : sampling.rate_hz,
+                       mask ? mask : sampling.channel_mask);
+  return true;
+}
+
+static void sample_reader_thread_fn(void *p1, void *p2, void *p3) {
+  ARG_UNUSED(p1);
+  ARG_UNUSED(p2);
+  ARG_UNUSED(p3);
+
+  LOG_INF("Sample reader thread started");
+
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
+  while (1) {
+    /* Wait for watermark tick */
+    k_sem_take(&sample_ready_sem, K_FOREVER);
+    if (sampling_check_request()) {
+      continue;
+    }
+    fifo_drain();
+  }
+#elif defined(CONFIG_ACCEL_ACQ_DPPI)
+  const uint8_t *block;
+  uint64_t sample_us;
+  uint32_t seq;
+  uint32_t expect_seq = 0;
+
+  while (1) {
+    /* Wait for a block of hardware-paced reads */
+    if (acq_dppi_wait_block(&block, &sample_us, &seq) != 0) {
+      sampling_check_request();
+      continue;
+    }
+
+    /* Blocks completed while this thread was busy were skipped: advance the
+     * counter past them so the receiver sees the gap, as for DRDY */
+    if (seq != expect_seq) {
+      sample_counter +=
+          samples_lost((seq - expect_seq) * CONFIG_ACCEL_DPPI_BLOCK_SAMPLES);
+    }
+    expect_seq = seq + 1;
+
+    for (uint16_t i = 0; i < CONFIG_ACCEL_DPPI_BLOCK_SAMPLES; i++) {
+      uint16_t ts_ms = burst_offset_ms(sample_us);
+      uint32_t ts_us = (uint32_t)sample_us;
+
+      sample_us += sampling.period_us;
+      sample_push(ts_ms, ts_us, &block[i * sampling.frame_size]);
+    }
+    acq_dppi_release_block(seq);
+  }
+#else
+  uint8_t raw_data[RAW_FRAME_MAX];
+  int ret;
+
+  while (1) {
+    /* Wait for ISR signal */
+    k_sem_take(&sample_ready_sem, K_FOREVER);
+    if (sampling_check_request()) {
+      continue;
+    }
+
+    /* Capture timestamp locally to avoid race with ISR */
+    uint16_t local_timestamp = pending_timestamp_ms;
+    uint32_t local_timestamp_us = pending_timestamp_us;
+
+#if defined(CONFIG_ACCEL_ACQ_DRDY)
+    /* Pending edges mean later conversions already overwrote the data
+     * registers: read once, and advance the counter past the lost frames so
+     * the receiver sees the gap instead of duplicates. */
+    unsigned int backlog = k_sem_count_get(&sample_ready_sem);
+    if (backlog > 0) {
+      k_sem_reset(&sample_ready_sem);
+      drdy_missed += backlog;
+      sample_counter += samples_lost(backlog);
+    }
+#endif
+
+    /* Skip the I2C transaction if the sample would be dropped anyway */
+    if (!packet_writer_ready() && !sampling_decimated()) {
+      samples_overflowed++;
+      continue;
+    }
+
+    /* Read the selected channels via I2C - ~300µs for accel XYZ */
+    ret = i2c_burst_read(i2c_dev, MPU6050_ADDR, sampling.start_reg, raw_data,
+                         sampling.frame_size);
+    if (ret < 0) {
+      LOG_WRN("I2C read failed: %d", ret);
+      continue;
+    }
+
+    sample_push(local_timestamp, local_timestamp_us, raw_data);
+  }
+#endif
+}
+
+K_THREAD_DEFINE(sample_reader, 1024, sample_reader_thread_fn, NULL, NULL, NULL,
+                0, 0, 0); /* Priority 0 = highest */
+
+/*============================================================================
+ * TX Pacing
+ *
+ * Credits, per central: one per send queued in the stack (a single packet,
+ * or a span coalesced into one multiple-notification PDU), returned by the
+ * first completion callback for it. Up to tx_depth sends are kept in flight,
+ * between TX_DEPTH_MIN and TX_DEPTH_MAX. A send completing within two
+ * connection intervals means the central drains every event, so the depth
+ * grows by one; slower completions mean packets are queueing in the
+ * controller, so it shrinks by one.
+ *
+ * Budget (coin-cell mode only): at most CONFIG_ACCEL_TX_BUDGET_PACKETS
+ * notifications start per CONFIG_ACCEL_TX_BUDGET_WINDOW_MS, whichever
+ * central they go to, which bounds the radio's average draw on the cell
+ * during a burst.
+ *===========================================================================*/
+
+#define TX_COMPLETE_TIMEOUT_MS 1000 /* Longer than any supervision timeout */
+
+/* Peak-current budget window */
+static int64_t tx_budget_start_ms = 0;
+static uint16_t tx_budget_used = 0;
+
+/* BT stack context: the packet left the stack (or was dropped) */
+static void tx_complete_cb(struct bt_conn *conn, void *user_data) {
+  struct subscriber *s = subscriber_get(conn);
+  uint32_t seq = POINTER_TO_UINT(user_data);
+
+  /* Uncoalesced spans complete once per packet: credit only the first.
+   * Also ignores late completions from a connection tx_reset() forgot. */
+  if (!atomic_cas(&s->tx_pending[seq % TX_DEPTH_MAX], seq + 1, 0)) {
+    return;
+  }
+
+  uint32_t latency_ms = k_uptime_get_32() - s->tx_sent_ms[seq % TX_DEPTH_MAX];
+  uint16_t interval_ms = s->conn_interval_ms;
+  atomic_val_t depth = atomic_get(&s->tx_depth);
+
+  if (interval_ms > 0) {
+    if (latency_ms <= 2U * interval_ms && depth < TX_DEPTH_MAX) {
+      atomic_cas(&s->tx_depth, depth, depth + 1);
+    } else if (latency_ms > 4U * interval_ms && depth > TX_DEPTH_MIN) {
+      atomic_cas(&s->tx_depth, depth, depth - 1);
+    }
+  }
+
+  atomic_dec(&s->tx_in_flight);
+  k_sem_give(&tx_complete_sem);
+}
+
+/* Forget in-flight packets of an old connection and start shallow again */
+static void tx_reset(struct subscriber *s) {
+  for (size_t i = 0; i < ARRAY_SIZE(s->tx_pending); i++) {
+    atomic_set(&s->tx_pending[i], 0);
+  }
+  atomic_set(&s->tx_in_flight, 0);
+  atomic_set(&s->tx_depth, TX_DEPTH_MIN);
+}
+
+static bool tx_credit_available(struct subscriber *s) {
+  return atomic_get(&s->tx_in_flight) < atomic_get(&s->tx_depth);
+}
+
+/* Wait for a credit. Returns false if completions stopped coming. */
+static bool tx_credit_take(struct subscriber *s) {
+  int64_t deadline_ms = k_uptime_get() + TX_COMPLETE_TIMEOUT_MS;
+
+  while (!tx_credit_available(s)) {
+    /* Other centrals' completions wake us too */
+    if (k_sem_take(&tx_complete_sem, K_TIMEOUT_ABS_MS(deadline_ms)) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Wait until the peak-current budget allows n more packets
+ * (n <= CONFIG_ACCEL_TX_BUDGET_PACKETS) */
+static void tx_budget_take(uint16_t n) {
+  int64_t now = k_uptime_get();
+
+  if (now - tx_budget_start_ms >= CONFIG_ACCEL_TX_BUDGET_WINDOW_MS) {
+    tx_budget_start_ms = now;
+    tx_budget_used = 0;
+  }
+  if (tx_budget_used + n > CONFIG_ACCEL_TX_BUDGET_PACKETS) {
+    tx_budget_start_ms += CONFIG_ACCEL_TX_BUDGET_WINDOW_MS;
+    tx_budget_used = 0;
+    k_sleep(K_TIMEOUT_ABS_MS(tx_budget_start_ms));
+  }
+  tx_budget_used += n;
+}
+
+/* Spend a credit on the next send. Returns its sequence number. */
+static uint32_t tx_track(struct subscriber *s) {
+  uint32_t seq = s->tx_seq++;
+
+  s->tx_sent_ms[seq % TX_DEPTH_MAX] = k_uptime_get_32();
+  atomic_set(&s->tx_pending[seq % TX_DEPTH_MAX], seq + 1);
+  atomic_inc(&s->tx_in_flight);
+  return seq;
+}
+
+/* The send failed. Entries already queued may still complete; forget the
+ * credit now. */
+static void tx_untrack(struct subscriber *s, uint32_t seq) {
+  if (atomic_cas(&s->tx_pending[seq % TX_DEPTH_MAX], seq + 1, 0)) {
+    atomic_dec(&s->tx_in_flight);
+  }
+}
+
+/* Queue n contiguous packets to s on one credit. The stack copies them
+ * before returning. */
+static int tx_send(struct subscriber *s, const accel_packet_t *pkts,
+                   uint16_t n, bool first) {
+  uint32_t seq = tx_track(s);
+  int err;
+
+  /* The first send of a burst also carries the timestamp update */
+  err = accel_service_notify_packets(s->conn, pkts, n, first, tx_complete_cb,
+                                     UINT_TO_POINTER(seq));
+  if (err) {
+    tx_untrack(s, seq);
+  }
+  return err;
+}
+
+/* Send n contiguous packets as one L2CAP SDU on s's channel (no GATT
+ * credits involved). Never waits: -EAGAIN while all its SDU buffers are
+ * queued. */
+static int burst_send_l2cap(struct subscriber *s, const accel_packet_t *pkts,
+                            uint16_t n) {
+#if defined(CONFIG_ACCEL_L2CAP_STREAM)
+  return l2cap_stream_send(s->conn, pkts, n, K_NO_WAIT);
+#else
+  ARG_UNUSED(s);
+  ARG_UNUSED(pkts);
+  ARG_UNUSED(n);
+  return -ENOTSUP;
+#endif
+}
+
+/* Packets per send to s on the given transport */
+static uint16_t burst_send_packets(const struct subscriber *s, bool l2cap) {
+#if defined(CONFIG_ACCEL_L2CAP_STREAM)
+  if (l2cap) {
+    return l2cap_stream_sdu_packets(s->conn);
+  }
+#endif
+  return accel_service_packets_per_pdu(s->conn);
+}
+
+#if defined(CONFIG_ACCEL_L2CAP_STREAM)
+/* BT stack context: an SDU buffer was freed */
+static void l2cap_sent(void) {
+  k_sem_give(&tx_complete_sem);
+}
+#endif
+
+#if defined(CONFIG_ACCEL_RETX)
+/*============================================================================
+ * Retransmission
+ *
+ * Requested packets go out between bursts on the data characteristic, on the
+ * same credits and budget as live data, and give way to the next burst. Each
+ * goes only to the central that asked for it.
+ *===========================================================================*/
+
+static accel_packet_t retx_pkt; /* Burst controller only */
+
+static void retx_serve(void) {
+  bool coincell = accel_service_get_mode() == MODE_COINCELL_BURST;
+  uint32_t sent = 0;
+  uint8_t index;
+
+  while (k_sem_count_get(&burst_ready_sem) == 0 &&
+         retx_next(&retx_pkt, &index)) {
+    struct subscriber *s = &subscribers[index];
+
+    /* Asked by a central that has left or stopped listening since */
+    if (atomic_get(&s->state) != SUB_ACTIVE || !s->mtu_ready ||
+        !accel_service_data_notify_enabled(s->conn)) {
+      continue;
+    }
+    if (coincell) {
+      tx_budget_take(1);
+    }
+    if (!tx_credit_take(s)) {
+      break;
+    }
+    if (tx_send(s, &retx_pkt, 1, false)) {
+      break; /* The central can ask again */
+    }
+    sent++;
+  }
+
+  if (sent > 0) {
+    packets_resent += sent;
+    LOG_INF("Retransmitted %u packets", sent);
+  }
+}
+#endif /* CONFIG_ACCEL_RETX */
+
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+/*============================================================================
+ * Store-and-Forward
+ *
+ * With no central reading, closed packets go to the flash log instead of
+ * being dropped. Once a central subscribes to the history characteristic the
+ * log is sent back between bursts, on the same credits and coin-cell budget
+ * as live data; it gives way as soon as the next burst is due, so live
+ * latency is unchanged and the backfill runs at whatever the link has left.
+ * There is one log, so it goes to the first subscribed central only.
+ *
+ * A packet counts as sent once the stack has it: the few still in flight
+ * when the link drops are not sent again.
+ *===========================================================================*/
+
+static accel_packet_t history_pkt; /* Burst controller only */
+
+/* Move everything in the ring to the flash log */
+static void history_store(void) {
+  accel_packet_t *pkt;
+  uint16_t n;
+
+  while ((n = spsc_ring_peek(&packet_ring, (void **)&pkt,
+                             PACKET_RING_SLOTS)) > 0) {
+    if (flash_log_append(pkt, n) == -ENODEV) {
+      spsc_ring_drain(&packet_ring); /* No partition: old behaviour */
+      return;
+    }
+    spsc_ring_consume(&packet_ring, n);
+    packets_logged += n;
+  }
+}
+
+/* The central to send the log to, or NULL */
+static struct subscriber *history_subscriber(void) {
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    struct subscriber *s = &subscribers[i];
+
+    if (atomic_get(&s->state) == SUB_ACTIVE && s->mtu_ready &&
+        accel_service_history_notify_enabled(s->conn)) {
+      return s;
+    }
+  }
+  return NULL;
+}
+
+/* Send logged packets until the log is empty or the next burst is due */
+static void history_backfill(void) {
+  bool coincell = accel_service_get_mode() == MODE_COINCELL_BURST;
+  struct subscriber *s = history_subscriber();
+  uint32_t sent = 0;
+
+  if (s == NULL) {
+    return;
+  }
+
+  while (k_sem_count_get(&burst_ready_sem) == 0 &&
+         accel_service_history_notify_enabled(s->conn) &&
+         flash_log_peek(&history_pkt) == 0) {
+    if (coincell) {
+      tx_budget_take(1);
+    }
+    if (!tx_credit_take(s)) {
+      break;
+    }
+
+    uint32_t seq = tx_track(s);
+    int err = accel_service_notify_history(s->conn, &history_pkt,
+                                           tx_complete_cb,
+                                           UINT_TO_POINTER(seq));
+
+    if (err) {
+      tx_untrack(s, seq);
+      LOG_WRN("History packet failed: %d", err);
+      break;
+    }
+    flash_log_consume();
+    sent++;
+  }
+
+  if (sent == 0) {
+    return;
+  }
+  history_sent += sent;
+
+  uint32_t pending = flash_log_pending();
+
+  LOG_INF("History: %u packets sent, %u left", sent, pending);
+  if (pending == 0) {
+    flash_log_save();
+  }
+}
+#endif /* CONFIG_ACCEL_FLASH_LOG */
+
+/*============================================================================
+ * Burst Controller Thread
+ *
+ * Waits for buffer to fill, then transmits all packets.
+ * In coin-cell mode, this fires every ~1 second.
+ * In lab mode, this fires more frequently (smaller batches).
+ *
+ * Each burst signal opens a burst for every central able to take live data,
+ * or extends the one it is still sending. Sends then go round-robin: every
+ * pass hands each central with a free credit (or SDU buffer) its next span,
+ * and the thread only sleeps when none of them can take one. A central so
+ * far behind the leading one that the reader thread would run out of slots
+ * skips ahead instead of stalling the others.
+ *===========================================================================*/
+
+enum burst_step {
+  STEP_SENT, /* Packets handed to the stack */
+  STEP_WAIT, /* Out of credits or SDU buffers for now */
+  STEP_DONE, /* Burst finished, or given up on */
+};
+
+#if defined(CONFIG_ACCEL_RETX)
+static uint32_t retx_retained_end = 0; /* Ring index retained up to */
+#endif
+
+/* Take in centrals that connected and release the ones that left */
+static void subscribers_update(void) {
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    struct subscriber *s = &subscribers[i];
+
+    switch (atomic_get(&s->state)) {
+    case SUB_JOINING:
+      tx_reset(s);
+      s->reading = false;
+      s->in_burst = false;
+      /* Fails if it already left again: released on the next pass */
+      atomic_cas(&s->state, SUB_JOINING, SUB_ACTIVE);
+      break;
+    case SUB_LEAVING:
+      s->reading = false;
+      s->in_burst = false;
+      bt_conn_unref(s->conn);
+      s->conn = NULL;
+      atomic_set(&s->state, SUB_FREE);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+/* Hand back the slots every reading central has passed. Returns false if
+ * none is reading. */
+static bool ring_release(void) {
+  uint32_t tail = packet_ring.tail;
+  uint32_t low = UINT32_MAX; /* Offsets from the tail */
+  uint32_t high = 0;
+
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    const struct subscriber *s = &subscribers[i];
+
+    if (s->reading) {
+      low = MIN(low, s->cursor - tail);
+      high = MAX(high, s->cursor - tail);
+    }
+  }
+  if (low == UINT32_MAX) {
+    return false;
+  }
+
+#if defined(CONFIG_ACCEL_RETX)
+  /* Sent or not, a central may ask for them again: retain each packet once,
+   * as soon as the leading central has passed it */
+  if ((int32_t)(retx_retained_end - tail) < 0) {
+    retx_retained_end = tail;
+  }
+  while ((int32_t)(tail + high - retx_retained_end) > 0) {
+    accel_packet_t *pkt;
+    uint16_t n = spsc_ring_peek_from(&packet_ring, retx_retained_end,
+                                     (void **)&pkt,
+                                     tail + high - retx_retained_end);
+
+    retx_retain(pkt, n);
+    retx_retained_end += n;
+  }
+#endif
+
+  /* The stack copied them: back to the reader thread */
+  spsc_ring_consume(&packet_ring, low);
+  return true;
+}
+
+/* Skip a central that lags so far behind the leading one that the reader
+ * thread would run out of slots for the next window. A central alone is
+ * never skipped. */
+static void ring_make_room(uint32_t head) {
+  /* Written by the reader thread; a stale value only skips less or more */
+  uint16_t window = MAX(burst_window_packets, 1U);
+  uint32_t keep = BURST_SLOTS - MIN(window, BURST_SLOTS);
+  uint32_t lead = UINT32_MAX;
+
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    if (subscribers[i].reading) {
+      lead = MIN(lead, head - subscribers[i].cursor);
+    }
+  }
+  if (lead == UINT32_MAX) {
+    return;
+  }
+  keep = MAX(keep, lead);
+
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    struct subscriber *s = &subscribers[i];
+    uint32_t behind = head - s->cursor;
+
+    if (!s->reading || behind <= keep) {
+      continue;
+    }
+    LOG_WRN("Central %u is %u packets behind, skipping %u", (uint32_t)i,
+            behind, behind - keep);
+    packets_skipped += behind - keep;
+    s->cursor = head - keep;
+    s->burst_end = s->cursor + burst_packet_count(s, keep);
+  }
+}
+
+#if defined(CONFIG_ACCEL_TRIGGER)
+/* Event-triggered capture. Between events the ring is trimmed to the last
+ * pre_ms of packets and no burst is opened, so the radio only keeps the
+ * connections alive. An event moves the centrals back to pre_ms before it
+ * and bursts run as usual, but stop at capture_limit, the first packet past
+ * post_ms after the last event. */
+static bool capture_active = false;  /* Waiting for the rest of the capture */
+static bool capture_limited = false; /* Bursts stop at capture_limit */
+static uint32_t capture_end = 0;     /* One past the last sample counter */
+static uint32_t capture_limit = 0;   /* Ring index past the capture */
+
+/* Counter a precedes b, both modulo mask + 1 */
+static bool counter_before(uint32_t a, uint32_t b, uint32_t mask) {
+  return ((a - b) & mask) > (mask >> 1);
+}
+
+/* Ring index of the first packet holding counter or a later sample, or
+ * with whole set, the first one starting at or after it. The head if no
+ * closed packet does yet. */
+static uint32_t capture_index(uint32_t counter, bool whole) {
+  uint32_t head = spsc_ring_head(&packet_ring);
+
+  for (uint32_t idx = packet_ring.tail; idx != head; idx++) {
+    const accel_packet_t *pkt = spsc_ring_slot(&packet_ring, idx);
+    uint32_t first;
+    uint16_t count;
+    uint32_t mask;
+
+    accel_packet_span(pkt, &first, &count, &mask);
+    if (!whole && count > 0) {
+      first += count - 1;
+    }
+    if (!counter_before(first, counter, mask)) {
+      return idx;
+    }
+  }
+  return head;
+}
+
+/* Move every reading central still before idx up to it and hand the slots
+ * back, or drop them if none is reading */
+static void capture_skip_to(uint32_t idx) {
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    struct subscriber *s = &subscribers[i];
+
+    if (s->reading && (int32_t)(idx - s->cursor) > 0) {
+      s->cursor = idx;
+    }
+  }
+#if defined(CONFIG_ACCEL_RETX)
+  /* Never sent: nothing to repair */
+  if ((int32_t)(idx - retx_retained_end) > 0) {
+    retx_retained_end = idx;
+  }
+#endif
+  if (!ring_release()) {
+    spsc_ring_consume(&packet_ring, idx - packet_ring.tail);
+  }
+}
+
+/* Bursts send nothing past the capture, however much arrives meanwhile */
+static void capture_clamp(uint32_t head) {
+  if (!capture_limited) {
+    return;
+  }
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    struct subscriber *s = &subscribers[i];
+
+    if (s->in_burst && (int32_t)(s->burst_end - head) > 0) {
+      s->burst_end = (int32_t)(head - s->cursor) > 0 ? head : s->cursor;
+    }
+  }
+}
+
+/* Take in the events of the last window and set what the bursts may send.
+ * Returns false to skip this window: nothing to send. */
+static bool capture_gate(void) {
+  trigger_config_t cfg;
+  uint32_t first;
+  uint32_t last;
+
+  trigger_get_config(&cfg);
+  if (cfg.type == TRIGGER_OFF) {
+    capture_active = false;
+    capture_limited = false;
+    return true;
+  }
+
+  /* Written by the reader thread; a stale value shifts the window slightly */
+  uint32_t rate_hz = sampling.rate_hz;
+  uint32_t pre = rate_hz * cfg.pre_ms / 1000U;
+  uint32_t post = rate_hz * cfg.post_ms / 1000U;
+
+  subscribers_update();
+
+  if (trigger_take(&first, &last)) {
+    trigger_event_t event = {
+        .trigger_counter = last,
+        .first_counter = first - pre,
+    };
+
+    if (!capture_active) {
+      uint32_t start = capture_index(first - pre, false);
+
+      /* Overlapping the previous capture, still being sent */
+      if (capture_limited && (int32_t)(capture_limit - start) > 0) {
+        start = capture_limit;
+      }
+      event.trigger_counter = first;
+      capture_skip_to(start);
+    } else {
+      event.first_counter = capture_end; /* Already announced before it */
+    }
+    capture_active = true;
+    capture_limited = true;
+    capture_end = last + 1 + post;
+    event.end_counter = capture_end;
+
+    LOG_INF("Trigger at sample %u, capturing %u-%u", event.trigger_counter,
+            event.first_counter, event.end_counter - 1);
+    accel_service_notify_trigger(NULL, &event);
+  }
+
+  if (capture_active) {
+    capture_limit = capture_index(capture_end, true);
+    /* A packet past the capture is closed: all of it is in the ring */
+    capture_active = capture_limit == spsc_ring_head(&packet_ring);
+    return true;
+  }
+
+  /* Finish sending the last capture before trimming under it */
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    if (subscribers[i].in_burst) {
+      return true;
+    }
+  }
+
+  /* Idle: keep the pre-trigger history, within what leaves the reader
+   * thread room for its next window */
+  uint32_t head = spsc_ring_head(&packet_ring);
+  uint16_t window = MAX(burst_window_packets, 1U);
+  uint32_t keep = BURST_SLOTS - MIN(window, BURST_SLOTS);
+  uint32_t idx = capture_index(sample_counter - pre, false);
+
+  if (head - idx > keep) {
+    idx = head - keep;
+  }
+  capture_skip_to(idx);
+  return false;
+}
+#endif
+
+/* Ring index the bursts send up to */
+static uint32_t burst_head(void) {
+#if defined(CONFIG_ACCEL_TRIGGER)
+  if (capture_limited) {
+    return capture_limit;
+  }
+#endif
+  return spsc_ring_head(&packet_ring);
+}
+
+/* Open (or extend) a burst for every central able to take live data.
+ * Returns false if none is. */
+static bool burst_open(void) {
+  uint32_t head = burst_head();
+  uint32_t now = k_uptime_get_32();
+  bool any = false;
+
+  subscribers_update();
+
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    struct subscriber *s = &subscribers[i];
+
+    if (!subscriber_streaming(s)) {
+      if (atomic_get(&s->state) == SUB_ACTIVE && !s->mtu_ready &&
+          accel_service_data_notify_enabled(s->conn)) {
+        LOG_WRN("Central %u: MTU not ready (current: %u, need: %u)",
+                (uint32_t)i, s->mtu, REQUIRED_MTU);
+      }
+      s->reading = false;
+      s->in_burst = false;
+      continue;
+    }
+
+    if (!s->reading) {
+      /* Starts with what the ring holds: the window just closed, unless
+       * another central is still sending older packets */
+      s->reading = true;
+      s->cursor = packet_ring.tail;
+    }
+    if (!s->in_burst) {
+      s->in_burst = true;
+      s->aborted = false;
+      s->burst_sent = 0;
+      s->burst_start_ms = now;
+      s->last_tx_ms = now;
+    }
+
+    uint32_t avail = (int32_t)(head - s->cursor) > 0 ? head - s->cursor : 0;
+
+    s->burst_end = s->cursor + burst_packet_count(s, avail);
+    any = true;
+  }
+
+  if (any) {
+    ring_make_room(spsc_ring_head(&packet_ring));
+#if defined(CONFIG_ACCEL_TRIGGER)
+    capture_clamp(head);
+#endif
+    ring_release();
+  }
+  link_rate_publish();
+  return any;
+}
+
+/* s is waiting on its link. Gives up on it after TX_COMPLETE_TIMEOUT_MS
+ * without progress. */
+static enum burst_step burst_stalled(struct subscriber *s) {
+  if (k_uptime_get_32() - s->last_tx_ms < TX_COMPLETE_TIMEOUT_MS) {
+    return STEP_WAIT;
+  }
+  LOG_WRN("Central %u: no TX completions for %u ms, aborting burst",
+          subscriber_index(s), TX_COMPLETE_TIMEOUT_MS);
+  s->aborted = true;
+  return STEP_DONE;
+}
+
+/* Hand s its next span of packets if it can take one */
+static enum burst_step burst_step(struct subscriber *s, bool coincell) {
+  accel_packet_t *pkt;
+  int err;
+
+  /* Re-check connection status before each send */
+  if (!subscriber_streaming(s)) {
+    LOG_WRN("Central %u lost mid-burst, aborting", subscriber_index(s));
+    s->aborted = true;
+    return STEP_DONE;
+  }
+  if ((int32_t)(s->burst_end - s->cursor) <= 0) {
+    return STEP_DONE;
+  }
+
+  bool l2cap = subscriber_l2cap(s);
+
+  /* GATT is paced by completions, not by a fixed delay */
+  if (!l2cap && !tx_credit_available(s)) {
+    return burst_stalled(s);
+  }
+
+  /* As many ready packets as one PDU (or SDU) holds, contiguous in the
+   * ring. Only closed packets are in it, CRC already filled in by the
+   * reader thread: just send them. */
+  uint16_t want = MIN(burst_send_packets(s, l2cap), s->burst_end - s->cursor);
+
+  if (coincell) {
+    want = MIN(want, CONFIG_ACCEL_TX_BUDGET_PACKETS);
+  }
+
+  uint16_t n =
+      spsc_ring_peek_from(&packet_ring, s->cursor, (void **)&pkt, want);
+
+  if (n == 0) {
+    return STEP_DONE;
+  }
+
+  /* Brownout protection: bound the radio's draw on the coin cell */
+  if (coincell) {
+    tx_budget_take(n);
+  }
+
+  if (l2cap) {
+    /* Paced by the channel's credits and SDU buffers */
+    err = burst_send_l2cap(s, pkt, n);
+    if (err == -EAGAIN) {
+      return burst_stalled(s);
+    }
+  } else {
+    err = tx_send(s, pkt, n, s->burst_sent == 0);
+  }
+  if (err == 0) {
+    packets_sent += n;
+  } else {
+    packets_failed += n;
+    LOG_WRN("Central %u: packets %u-%u failed: %d", subscriber_index(s),
+            s->burst_sent, s->burst_sent + n - 1, err);
+  }
+
+  s->cursor += n;
+  s->burst_sent += n;
+  s->last_tx_ms = k_uptime_get_32();
+  return STEP_SENT;
+}
+
+/* s is done: size its next bursts against what its link really sustained */
+static void burst_close(struct subscriber *s) {
+  uint32_t elapsed_ms = k_uptime_get_32() - s->burst_start_ms;
+
+  s->in_burst = false;
+  if (s->burst_sent == 0) {
+    return;
+  }
+  if (!s->aborted) {
+    link_capacity_update(s, s->burst_sent, elapsed_ms);
+  }
+
+  uint32_t ppe = (uint32_t)atomic_get(&s->link_ppe_q4);
+
+  LOG_INF("  Central %u: %u packets in %u ms, %u.%02u packets/event at %u ms",
+          subscriber_index(s), s->burst_sent, elapsed_ms,
+          ppe >> LINK_PPE_SHIFT, (ppe & 0xF) * 100U / 16U,
+          s->conn_interval_ms);
+}
+
+/* Send until every central finished its burst (returns true), or the next
+ * one is due first (returns false) */
+static bool burst_pump(void) {
+  bool coincell = accel_service_get_mode() == MODE_COINCELL_BURST;
+
+  for (;;) {
+    bool busy = false;
+    bool progress = false;
+
+    for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+      struct subscriber *s = &subscribers[i];
+
+      if (!s->in_burst) {
+        continue;
+      }
+      switch (burst_step(s, coincell)) {
+      case STEP_SENT:
+        progress = true;
+        busy = true;
+        break;
+      case STEP_WAIT:
+        busy = true;
+        break;
+      case STEP_DONE:
+        burst_close(s);
+        break;
+      }
+    }
+
+    if (progress) {
+      ring_release();
+    }
+    if (!busy) {
+      return true;
+    }
+    /* Centrals that are done start the next window without waiting */
+    if (k_sem_count_get(&burst_ready_sem) > 0) {
+      return false;
+    }
+    if (!progress) {
+      k_sem_take(&tx_complete_sem, K_MSEC(TX_COMPLETE_TIMEOUT_MS));
+    }
+  }
+}
+
+#if defined(CONFIG_ACCEL_PA_STREAM)
+/* Broadcast mode: one train update per CONFIG_ACCEL_PA_INTERVAL_MS, on a
+ * fixed schedule whoever listens. Packets are taken contiguous from the
+ * ring, so the update at the wrap point is shorter and the rest goes out
+ * with the next one. */
+static void broadcast_loop(void) {
+  int64_t next_ms = k_uptime_get();
+
+  while (1) {
+    accel_packet_t *pkt;
+    uint16_t n;
+    int err;
+
+    next_ms += CONFIG_ACCEL_PA_INTERVAL_MS;
+    k_sleep(K_TIMEOUT_ABS_MS(next_ms));
+
+    /* Burst windows only pace connections */
+    k_sem_reset(&burst_ready_sem);
+
+    n = spsc_ring_peek(&packet_ring, (void **)&pkt, PA_STREAM_TRAIN_PACKETS);
+    if (n == 0) {
+      continue;
+    }
+
+    err = pa_stream_send(pkt, n);
+    if (err == 0) {
+      packets_sent += n;
+      total_bursts++;
+    } else if (err != -ENODEV) {
+      packets_failed += n;
+      LOG_WRN("Train update failed: %d", err);
+    }
+
+    /* Copied into the train: hand the slots back to the reader thread */
+    spsc_ring_consume(&packet_ring, n);
+
+    /* Reset burst start time for next window */
+    burst_start_ms = k_uptime_get_32();
+  }
+}
+#endif /* CONFIG_ACCEL_PA_STREAM */
+
+static void burst_controller_thread_fn(void *p1, void *p2, void *p3) {
+  ARG_UNUSED(p1);
+  ARG_UNUSED(p2);
+  ARG_UNUSED(p3);
+
+  LOG_INF("Burst controller thread started");
 
-    LOG_INF("Starting burst %u: %u samples buffered", burst_id,
-            (uint16_t)(write_idx - read_idx));
+#if defined(CONFIG_ACCEL_PA_STREAM)
+  /* Never returns: connections get no live data in this mode */
+  broadcast_loop();
+#endif
 
-    /*
-     * Robustness fix: Only send full packets available in buffer.
-     * Prevents read_idx from overshooting write_idx (1024 is not divisible by
-     * 24).
-     */
-    uint16_t samples_available = write_idx - read_idx;
-    uint16_t packets_to_send = samples_available / SAMPLES_PER_PACKET;
+  while (1) {
+    /* Wait for buffer to fill */
+    k_sem_take(&burst_ready_sem, K_FOREVER);
 
-    if (packets_to_send > PACKETS_PER_BURST) {
-      packets_to_send = PACKETS_PER_BURST;
+#if defined(CONFIG_ACCEL_TRIGGER)
+    if (!capture_gate()) {
+      continue; /* Between events: the radio stays idle */
     }
+#endif
 
-    if (packets_to_send == 0) {
+    if (!burst_open()) {
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+      /* Not connected or notifications not enabled - keep it for later */
+      history_store();
+      history_backfill();
+#else
+      /* Not connected or notifications not enabled - silently drain buffer */
+      spsc_ring_drain(&packet_ring);
+#endif
       continue;
     }
 
-    /* REMOVED: Do NOT pause sampling. We need continuous data.
-     * The Ring Buffer will handle the concurrency.
-     */
-
-    for (uint16_t p = 0; p < packets_to_send; p++) {
-      /* Re-check connection status before each packet */
-      if (!accel_service_data_notify_enabled()) {
-        LOG_WRN("Connection lost mid-burst, aborting");
-        break;
-      }
-
-      /* Build packet */
-      tx_packet.burst_id = burst_id;
-
-      /* Read from Ring Buffer - Protected by Spinlock */
-      k_spinlock_key_t key = k_spin_lock(&buffer_lock);
-      for (uint16_t s = 0; s < SAMPLES_PER_PACKET; s++) {
-        uint16_t src_idx =
-            (read_idx + (p * SAMPLES_PER_PACKET) + s) & RING_BUFFER_MASK;
-        tx_packet.samples[s] = ring_buffer[src_idx];
-      }
-      k_spin_unlock(&buffer_lock, key);
-
-      /* Calculate CRC16 over header + samples (all but the last 2 bytes, which
-       * are the CRC itself) */
-      tx_packet.crc16 = crc16_ccitt(0xFFFF, (const uint8_t *)&tx_packet,
-                                    ACCEL_PACKET_SIZE - 2);
-
-      /* Send packet */
-      err = accel_service_notify_packet(NULL, &tx_packet);
-      if (err == 0) {
-        packets_sent++;
-      } else {
-        packets_failed++;
-        LOG_WRN("Packet %u failed: %d", p, err);
-      }
+    LOG_INF("Starting burst %u: %u packets buffered, %u centrals",
+            total_bursts, spsc_ring_used(&packet_ring),
+            (uint32_t)atomic_get(&conn_count));
+    total_bursts++;
 
-      /* Inter-packet delay to prevent coin-cell brownout */
-      /* SIMPLE BLOCKING SLEEP - Active Wait was causing index corruption */
-      if (accel_service_get_mode() == MODE_COINCELL_BURST) {
-        k_sleep(K_MSEC(INTER_PACKET_DELAY_MS));
-      }
+    if (!burst_pump()) {
+      continue; /* Still sending: the next window extends the bursts */
     }
 
-    /* Resume sampling */
-
-    /* Advance read pointer - Protected by Spinlock */
-    /* NOTE: Do NOT mask! Indices grow unboundedly, masking only when indexing
-     * array */
-    k_spinlock_key_t key = k_spin_lock(&buffer_lock);
-    read_idx += packets_to_send * SAMPLES_PER_PACKET;
-    k_spin_unlock(&buffer_lock, key);
-
     /* Calculate burst duration for logging */
-    uint32_t burst_end_ms = k_uptime_get_32();
-    uint32_t burst_duration_ms = burst_end_ms - burst_start_ms;
+    uint32_t burst_duration_ms = k_uptime_get_32() - burst_start_ms;
+    uint32_t available = spsc_ring_used(&packet_ring);
 
-    burst_id++;
-    total_bursts++;
-
-    /* Calculate available samples - simple subtraction works with unbounded
-     * indices */
-    uint16_t available = write_idx - read_idx;
-
-    LOG_INF("=== BURST #%u COMPLETE ===", burst_id);
+    LOG_INF("=== BURST #%u COMPLETE ===", total_bursts);
     LOG_INF("  Duration: %u ms (Target: ~20ms)", burst_duration_ms);
     LOG_INF("  Packets Sent: %u, Failed: %u", packets_sent, packets_failed);
-    LOG_INF("  Buffer: Write=%u, Read=%u, Available=%u", write_idx, read_idx,
-            available);
+    LOG_INF("  Buffer: Head=%u, Tail=%u, Available=%u packets",
+            packet_ring.head, packet_ring.tail, available);
     if (samples_overflowed > 0) {
       LOG_WRN("  !!! OVERFLOW: %u samples dropped !!!", samples_overflowed);
     }
 
     /* Reset burst start time for next window */
     burst_start_ms = k_uptime_get_32();
+
+#if defined(CONFIG_ACCEL_RETX)
+    /* Repair gaps before backfilling older data */
+    retx_serve();
+#endif
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+    /* Fill the gap until the next burst with logged packets */
+    history_backfill();
+#endif
   }
 }
 
@@ -337,6 +2118,84 @@ K_THREAD_DEFINE(burst_controller, 2048, burst_controller_thread_fn, NULL, NULL,
  * MPU6050 Initialization
  *===========================================================================*/
 
+static int mpu6050_write_reg(uint8_t reg, uint8_t val) {
+  uint8_t buf[2] = {reg, val};
+
+  return i2c_write(i2c_dev, buf, sizeof(buf), MPU6050_ADDR);
+}
+
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
+/* Flush the FIFO, (re)enable the captured channels and re-anchor the FIFO
+ * clock */
+static int mpu6050_fifo_reset(void) {
+  int ret;
+
+  ret = mpu6050_write_reg(MPU6050_USER_CTRL, MPU6050_USER_CTRL_FIFO_RESET);
+  if (ret < 0) {
+    return ret;
+  }
+
+  uint8_t captured = sampling.captured;
+  uint8_t fifo_en = 0;
+
+  fifo_en |= (captured & ACCEL_CH_ACCEL_XYZ) ? MPU6050_FIFO_EN_ACCEL : 0;
+  fifo_en |= (captured & ACCEL_CH_TEMP) ? MPU6050_FIFO_EN_TEMP : 0;
+  fifo_en |= (captured & ACCEL_CH_GX) ? MPU6050_FIFO_EN_XG : 0;
+  fifo_en |= (captured & ACCEL_CH_GY) ? MPU6050_FIFO_EN_YG : 0;
+  fifo_en |= (captured & ACCEL_CH_GZ) ? MPU6050_FIFO_EN_ZG : 0;
+
+  ret = mpu6050_write_reg(MPU6050_FIFO_EN, fifo_en);
+  if (ret < 0) {
+    return ret;
+  }
+
+  ret = mpu6050_write_reg(MPU6050_USER_CTRL, MPU6050_USER_CTRL_FIFO_EN);
+  if (ret < 0) {
+    return ret;
+  }
+
+  /* First frame lands one ODR period after the FIFO starts */
+  fifo_clock_us = k_ticks_to_us_floor64(k_uptime_ticks()) + sampling.period_us;
+  return 0;
+}
+#endif
+
+/* Program SMPLRT_DIV and the DLPF for cfg->rate_hz, and put the axes
+ * outside cfg->channel_mask in standby */
+static int mpu6050_configure(const struct sampling_cfg *cfg) {
+  uint8_t mask = cfg->channel_mask;
+  uint8_t standby = 0;
+  int ret;
+
+  /* DLPF enabled -> Gyro Rate = 1kHz, Sample Rate = 1kHz / (1 + SMPLRT_DIV) */
+  ret = mpu6050_write_reg(MPU6050_SMPLRT_DIV, cfg->smplrt_div);
+  if (ret < 0) {
+    LOG_ERR("Failed to set sample rate: %d", ret);
+    return ret;
+  }
+
+  ret = mpu6050_write_reg(MPU6050_CONFIG, cfg->dlpf_cfg);
+  if (ret < 0) {
+    LOG_ERR("Failed to set DLPF: %d", ret);
+    return ret;
+  }
+
+  /* PWR_MGMT_2: STBY_XA YA ZA XG YG ZG in bits 5..0 */
+  standby |= (mask & ACCEL_CH_AX) ? 0 : BIT(5);
+  standby |= (mask & ACCEL_CH_AY) ? 0 : BIT(4);
+  standby |= (mask & ACCEL_CH_AZ) ? 0 : BIT(3);
+  standby |= (mask & ACCEL_CH_GX) ? 0 : BIT(2);
+  standby |= (mask & ACCEL_CH_GY) ? 0 : BIT(1);
+  standby |= (mask & ACCEL_CH_GZ) ? 0 : BIT(0);
+  ret = mpu6050_write_reg(MPU6050_PWR_MGMT_2, standby);
+  if (ret < 0) {
+    LOG_ERR("Failed to set channel standby: %d", ret);
+    return ret;
+  }
+
+  return 0;
+}
+
 static int mpu6050_init(void) {
   uint8_t buf[2];
   int ret;
@@ -350,25 +2209,9 @@ static int mpu6050_init(void) {
     return ret;
   }
 
-  /* Set sample rate divider
-   * DLPF enabled (CFG=3) -> Gyro Rate = 1kHz.
-   * Sample Rate = 1kHz / (1 + SMPLRT_DIV).
-   * We want 1kHz, so SMPLRT_DIV must be 0.
-   */
-  buf[0] = MPU6050_SMPLRT_DIV;
-  buf[1] = 0;
-  ret = i2c_write(i2c_dev, buf, 2, MPU6050_ADDR);
-  if (ret < 0) {
-    LOG_ERR("Failed to set sample rate: %d", ret);
-    return ret;
-  }
-
-  /* Set DLPF to 44Hz bandwidth */
-  buf[0] = MPU6050_CONFIG;
-  buf[1] = 0x03;
-  ret = i2c_write(i2c_dev, buf, 2, MPU6050_ADDR);
+  /* Set sample rate divider, DLPF (44Hz bandwidth at 1kHz) and channels */
+  ret = mpu6050_configure(&sampling);
   if (ret < 0) {
-    LOG_ERR("Failed to set DLPF: %d", ret);
     return ret;
   }
 
@@ -381,21 +2224,320 @@ static int mpu6050_init(void) {
     return ret;
   }
 
-  LOG_INF("MPU6050 initialized: ±16g, 1kHz ODR, 44Hz DLPF");
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
+  /* Queue accel frames in the on-chip FIFO */
+  ret = mpu6050_fifo_reset();
+  if (ret < 0) {
+    LOG_ERR("Failed to enable FIFO: %d", ret);
+    return ret;
+  }
+  LOG_INF("MPU6050 FIFO enabled (watermark %u samples)",
+          CONFIG_ACCEL_FIFO_WATERMARK_SAMPLES);
+#endif
+
+#if defined(CONFIG_ACCEL_ACQ_DRDY)
+  /* INT pin: active high, push-pull, 50 µs pulse, cleared by any read */
+  ret = mpu6050_write_reg(MPU6050_INT_PIN_CFG, MPU6050_INT_PIN_CFG_RD_CLEAR);
+  if (ret < 0) {
+    LOG_ERR("Failed to configure INT pin: %d", ret);
+    return ret;
+  }
+
+  ret = mpu6050_write_reg(MPU6050_INT_ENABLE, MPU6050_INT_ENABLE_DATA_RDY);
+  if (ret < 0) {
+    LOG_ERR("Failed to enable DATA_RDY interrupt: %d", ret);
+    return ret;
+  }
+#endif
+
+  LOG_INF("MPU6050 initialized: ±16g, %u Hz ODR, DLPF_CFG=%u, channels 0x%02x",
+          MPU6050_GYRO_RATE_HZ / (1 + sampling.smplrt_div), sampling.dlpf_cfg,
+          sampling.channel_mask);
+  return 0;
+}
+
+#if defined(CONFIG_ACCEL_ACQ_DRDY)
+/* Route the MPU6050 INT pin to mpu6050_drdy_handler (left disabled) */
+static int mpu6050_drdy_setup(void) {
+  int ret;
+
+  if (!gpio_is_ready_dt(&mpu6050_int)) {
+    LOG_ERR("MPU6050 INT GPIO not ready");
+    return -ENODEV;
+  }
+
+  ret = gpio_pin_configure_dt(&mpu6050_int, GPIO_INPUT);
+  if (ret < 0) {
+    LOG_ERR("Failed to configure INT GPIO: %d", ret);
+    return ret;
+  }
+
+  gpio_init_callback(&mpu6050_int_cb, mpu6050_drdy_handler,
+                     BIT(mpu6050_int.pin));
+  ret = gpio_add_callback_dt(&mpu6050_int, &mpu6050_int_cb);
+  if (ret < 0) {
+    LOG_ERR("Failed to add INT callback: %d", ret);
+    return ret;
+  }
+
   return 0;
 }
+#endif
 
 /*============================================================================
- * BLE Connection Callbacks
+ * Sampling Rate Control
+ *
+ * A rate written over BLE is validated in the GATT callback, then applied by
+ * the reader thread between samples: pacing stops, the sensor is reprogrammed,
+ * the derived burst parameters are swapped in and pacing restarts. The new
+ * rate is persisted so the node comes back up at the same rate.
  *===========================================================================*/
 
-/* Forward declare MTU exchange callback and params */
-static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err,
-                            struct bt_gatt_exchange_params *params);
+/* Start the acquisition pacing for the current sampling configuration */
+static int sampling_start(void) {
+#if defined(CONFIG_ACCEL_DECIMATE)
+  /* Filter history from another configuration is of no use */
+  decimate_configure(sampling.decim, POPCOUNT(sampling.captured));
+#endif
 
-static struct bt_gatt_exchange_params mtu_exchange_params = {
-    .func = mtu_exchange_cb,
-};
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
+  /* Drop stale frames and re-anchor the FIFO clock, then drain once per
+   * watermark */
+  mpu6050_fifo_reset();
+  k_timer_start(
+      &sample_timer,
+      K_USEC(sampling.period_us * CONFIG_ACCEL_FIFO_WATERMARK_SAMPLES),
+      K_USEC(sampling.period_us * CONFIG_ACCEL_FIFO_WATERMARK_SAMPLES));
+  return 0;
+#elif defined(CONFIG_ACCEL_ACQ_DRDY)
+  return gpio_pin_interrupt_configure_dt(&mpu6050_int,
+                                         GPIO_INT_EDGE_TO_ACTIVE);
+#elif defined(CONFIG_ACCEL_ACQ_DPPI)
+  acq_dppi_set_period(sampling.period_us);
+  acq_dppi_set_frame(sampling.start_reg, sampling.frame_size);
+  return acq_dppi_start();
+#else
+  k_timer_start(&sample_timer, K_USEC(sampling.period_us),
+                K_USEC(sampling.period_us));
+  return 0;
+#endif
+}
+
+static void sampling_stop(void) {
+#if defined(CONFIG_ACCEL_ACQ_DRDY)
+  gpio_pin_interrupt_configure_dt(&mpu6050_int, GPIO_INT_DISABLE);
+
+  /* Drift window would otherwise mix two ODRs */
+  k_spinlock_key_t key = k_spin_lock(&drdy_lock);
+  drdy_window_edges = 0;
+  k_spin_unlock(&drdy_lock, key);
+#elif defined(CONFIG_ACCEL_ACQ_DPPI)
+  acq_dppi_stop(); /* Hands the TWIM back for the register writes */
+#else
+  k_timer_stop(&sample_timer);
+#endif
+}
+
+/* Runs in the reader thread, which owns the sensor bus */
+static void sampling_reconfigure(uint16_t rate_hz, uint8_t mask) {
+  struct sampling_cfg cfg;
+  int err;
+
+  if (rate_hz == sampling.rate_hz && mask == sampling.channel_mask) {
+    return;
+  }
+  sampling_cfg_compute(rate_hz, mask, &cfg);
+
+  sampling_stop();
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
+  /* Frames already queued were taken with the old configuration */
+  fifo_drain();
+#endif
+
+  err = mpu6050_configure(&cfg);
+  if (err < 0) {
+    /* Sensor state unknown: try to restore the old setup and carry on */
+    mpu6050_configure(&sampling);
+    sampling_start();
+    return;
+  }
+
+  /* Packets already in the ring are self-describing, and the open one is
+   * closed by the first sample taken with a different mask or rate. The
+   * burst controller only reads the rate for burst sizing, where a mix of old
+   * and new fields is harmless, so no lock is needed. */
+  sampling = cfg;
+  burst_window_packets = 0;
+
+#if defined(CONFIG_SETTINGS)
+  /* Flash write while pacing is stopped, not between samples */
+  err = settings_save_one("accel/rate", &cfg.rate_hz, sizeof(cfg.rate_hz));
+  if (!err) {
+    err = settings_save_one("accel/chmask", &cfg.channel_mask,
+                            sizeof(cfg.channel_mask));
+  }
+  if (err) {
+    LOG_WRN("Failed to persist sampling configuration (err %d)", err);
+  }
+#endif
+
+  /* Ticks queued before the switch belong to the old configuration */
+  k_sem_reset(&sample_ready_sem);
+  err = sampling_start();
+  if (err) {
+    LOG_ERR("Failed to restart sampling (err %d)", err);
+  }
+
+  accel_service_set_sampling_rate(cfg.rate_hz);
+  accel_service_set_channel_mask(cfg.channel_mask);
+  LOG_INF("Sampling now %u Hz, channels 0x%02x (%u-byte reads, burst every "
+          "%u samples)",
+          cfg.rate_hz, cfg.channel_mask, cfg.frame_size,
+          cfg.samples_before_burst);
+}
+
+/* Hand a pending request to the reader thread without waiting for a tick */
+static void sampling_wake_reader(void) {
+#if defined(CONFIG_ACCEL_ACQ_DPPI)
+  acq_dppi_wake();
+#else
+  k_sem_give(&sample_ready_sem);
+#endif
+}
+
+/* Sampling rate characteristic write handler (BT RX context) */
+static int sampling_rate_request(uint16_t rate_hz) {
+  if (!sampling_rate_valid(rate_hz)) {
+    return -EINVAL;
+  }
+
+  atomic_set(&requested_rate_hz, rate_hz);
+  sampling_wake_reader();
+  return 0;
+}
+
+/* Channel mask characteristic write handler (BT RX context) */
+static int channel_mask_request(uint8_t mask) {
+  if (!channel_mask_valid(mask)) {
+    return -EINVAL;
+  }
+
+  atomic_set(&requested_mask, mask);
+  sampling_wake_reader();
+  return 0;
+}
+
+#if defined(CONFIG_ACCEL_TRIGGER)
+#if defined(CONFIG_SETTINGS)
+/* Flash write off the BT RX thread */
+static void trigger_save_work_fn(struct k_work *work) {
+  trigger_config_t cfg;
+  int err;
+
+  ARG_UNUSED(work);
+
+  trigger_get_config(&cfg);
+  err = settings_save_one("accel/trigger", &cfg, sizeof(cfg));
+  if (err) {
+    LOG_WRN("Failed to persist trigger configuration (err %d)", err);
+  }
+}
+
+static K_WORK_DEFINE(trigger_save_work, trigger_save_work_fn);
+#endif
+
+/* Trigger characteristic write handler (BT RX context) */
+static int trigger_request(const trigger_config_t *cfg) {
+  int err = trigger_configure(cfg);
+
+  if (err) {
+    return err;
+  }
+
+  accel_service_set_trigger_config(cfg);
+#if defined(CONFIG_SETTINGS)
+  k_work_submit(&trigger_save_work);
+#endif
+  return 0;
+}
+#endif
+
+#if defined(CONFIG_SETTINGS)
+static int accel_settings_set(const char *name, size_t len,
+                              settings_read_cb read_cb, void *cb_arg) {
+  const char *next;
+  uint16_t rate_hz;
+  uint8_t mask;
+  int rc;
+
+  if (settings_name_steq(name, "rate", &next) && !next) {
+    if (len != sizeof(rate_hz)) {
+      return -EINVAL;
+    }
+
+    rc = read_cb(cb_arg, &rate_hz, sizeof(rate_hz));
+    if (rc < 0) {
+      return rc;
+    }
+    if (!sampling_rate_valid(rate_hz)) {
+      LOG_WRN("Ignoring stored sampling rate %u Hz", rate_hz);
+      return -EINVAL;
+    }
+
+    sampling_cfg_compute(rate_hz, sampling.channel_mask, &sampling);
+    return 0;
+  }
+
+  if (settings_name_steq(name, "chmask", &next) && !next) {
+    if (len != sizeof(mask)) {
+      return -EINVAL;
+    }
+
+    rc = read_cb(cb_arg, &mask, sizeof(mask));
+    if (rc < 0) {
+      return rc;
+    }
+    if (!channel_mask_valid(mask)) {
+      LOG_WRN("Ignoring stored channel mask 0x%02x", mask);
+      return -EINVAL;
+    }
+
+    sampling_cfg_compute(sampling.rate_hz, mask, &sampling);
+    return 0;
+  }
+
+#if defined(CONFIG_ACCEL_TRIGGER)
+  if (settings_name_steq(name, "trigger", &next) && !next) {
+    trigger_config_t trigger;
+
+    if (len != sizeof(trigger)) {
+      return -EINVAL;
+    }
+
+    rc = read_cb(cb_arg, &trigger, sizeof(trigger));
+    if (rc < 0) {
+      return rc;
+    }
+    if (trigger_configure(&trigger)) {
+      LOG_WRN("Ignoring stored trigger configuration");
+      return -EINVAL;
+    }
+    return 0;
+  }
+#endif
+
+  return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(accel, "accel", NULL, accel_settings_set, NULL,
+                               NULL);
+#endif
+
+/*============================================================================
+ * BLE Connection Callbacks
+ *===========================================================================*/
+
+static void advertising_resume(void);
 
 static void connected(struct bt_conn *conn, uint8_t err) {
   if (err) {
@@ -403,71 +2545,93 @@ static void connected(struct bt_conn *conn, uint8_t err) {
     return;
   }
 
-  LOG_INF("Connected");
+  struct subscriber *s = subscriber_get(conn);
+
+  LOG_INF("Connected (central %u)", subscriber_index(s));
 
   /* LED only in lab mode to save coin-cell power */
   if (accel_service_get_mode() == MODE_CONTINUOUS_LAB) {
     dk_set_led_on(DK_LED1);
   }
 
-  /* Request fast connection interval for high throughput */
-  struct bt_le_conn_param *param =
-      BT_LE_CONN_PARAM(6, 12, 0, 400); // 7.5ms - 15ms
-  int err_param = bt_conn_le_param_update(conn, param);
-  if (err_param) {
-    LOG_WRN("Conn param update failed: %d", err_param);
+  /* Pacing and burst sizing start conservative on the interval we
+   * connected with */
+  struct bt_conn_info info;
+
+  s->conn = bt_conn_ref(conn);
+  s->conn_interval_ms = 0;
+  if (bt_conn_get_info(conn, &info) == 0) {
+    s->conn_interval_ms = DIV_ROUND_UP(info.le.interval * 5U, 4U);
   }
+  atomic_set(&s->link_ppe_q4, LINK_PPE_INIT);
 
-  accel_service_set_conn(conn);
+  /* Reset MTU state; conn_tune runs the exchange */
+  s->mtu_ready = false;
+  s->mtu = 23;
 
-  /* Reset MTU state */
-  mtu_ready = false;
-  current_mtu = 23;
+  /* The burst controller resets its credits before it reads */
+  atomic_set(&s->state, SUB_JOINING);
 
-  /* Request MTU exchange for large packets */
-  int ret = bt_gatt_exchange_mtu(conn, &mtu_exchange_params);
-  if (ret) {
-    LOG_ERR("MTU exchange request failed (err %d)", ret);
-  } else {
-    LOG_INF("MTU exchange requested");
+  /* Reset burst timing on the first connection; later centrals join the
+   * running sample stream. The sample counter is left running: it wraps at
+   * its field width anyway, and logged and retained packets stay unique. */
+  if (atomic_inc(&conn_count) == 0) {
+    burst_start_ms = k_uptime_get_32();
   }
 
-  /* Reset burst timing on new connection */
-  burst_start_ms = k_uptime_get_32();
-  sample_counter = 0;
+  /* Connectable advertising stops on each connection */
+  advertising_resume();
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason) {
-  LOG_INF("Disconnected (reason %u)", reason);
-  dk_set_led_off(DK_LED1); /* Always safe to turn off */
+  struct subscriber *s = subscriber_get(conn);
+
+  LOG_INF("Disconnected (central %u, reason %u)", subscriber_index(s),
+          reason);
+  if (atomic_dec(&conn_count) == 1) {
+    dk_set_led_off(DK_LED1); /* Always safe to turn off */
+  }
+
+  /* CCC state is dropped by the stack */
+  s->mtu_ready = false;
+  s->mtu = 23;
+  s->conn_interval_ms = 0;
+#if defined(CONFIG_ACCEL_RETX)
+  /* Its index may go to the next central before the queue is served */
+  retx_conn_closed(conn);
+#endif
+
+  /* The burst controller releases the slot */
+  atomic_set(&s->state, SUB_LEAVING);
+  k_sem_give(&tx_complete_sem);
+}
 
-  accel_service_set_conn(NULL); /* Resets CCC state */
-  mtu_ready = false;
-  current_mtu = 23;
+/* The stack freed a connection object: a slot is free to advertise for */
+static void recycled(void) {
+  advertising_resume();
 }
 
 static void le_param_updated(struct bt_conn *conn, uint16_t interval,
                              uint16_t latency, uint16_t timeout) {
   LOG_INF("Connection params: interval=%u (%.2f ms), latency=%u, timeout=%u",
           interval, interval * 1.25, latency, timeout);
+
+  /* Units of 1.25 ms; TX depth and burst size adapt to the new cadence */
+  subscriber_get(conn)->conn_interval_ms = DIV_ROUND_UP(interval * 5U, 4U);
 }
 
-/* GATT MTU exchange callback implementation */
-static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err,
-                            struct bt_gatt_exchange_params *params) {
-  if (err) {
-    LOG_ERR("MTU exchange failed (err %u)", err);
-    return;
-  }
+/* MTU exchange result, reported by conn_tune */
+static void mtu_updated(struct bt_conn *conn, uint16_t mtu) {
+  struct subscriber *s = subscriber_get(conn);
 
-  current_mtu = bt_gatt_get_mtu(conn);
-  LOG_INF("MTU exchanged: %u bytes", current_mtu);
+  s->mtu = mtu;
+  LOG_INF("Central %u: MTU exchanged: %u bytes", subscriber_index(s), mtu);
 
-  if (current_mtu >= REQUIRED_MTU) {
-    mtu_ready = true;
+  if (mtu >= REQUIRED_MTU) {
+    s->mtu_ready = true;
     LOG_INF("MTU ready for 243-byte packets");
   } else {
-    LOG_WRN("MTU %u too small for 243-byte packets (need %u)", current_mtu,
+    LOG_WRN("MTU %u too small for 243-byte packets (need %u)", mtu,
             REQUIRED_MTU);
   }
 }
@@ -475,6 +2639,7 @@ static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err,
 BT_CONN_CB_DEFINE(conn_callbacks) = {
     .connected = connected,
     .disconnected = disconnected,
+    .recycled = recycled,
     .le_param_updated = le_param_updated,
 };
 
@@ -498,6 +2663,26 @@ static struct bt_le_adv_param adv_param = BT_LE_ADV_PARAM_INIT(
     BT_GAP_ADV_FAST_INT_MAX_2,                     /* 150 ms */
     NULL);
 
+/* Restart advertising while a connection slot is free. From a work item:
+ * not from within the stack's own callbacks. */
+static void advertising_work_fn(struct k_work *work) {
+  ARG_UNUSED(work);
+
+  int err = bt_le_adv_start(&adv_param, ad, ARRAY_SIZE(ad), sd,
+                            ARRAY_SIZE(sd));
+
+  /* -ENOMEM: every slot is taken, recycled() tries again */
+  if (err && err != -EALREADY && err != -ENOMEM) {
+    LOG_WRN("Advertising failed to restart (err %d)", err);
+  }
+}
+
+static K_WORK_DEFINE(advertising_work, advertising_work_fn);
+
+static void advertising_resume(void) {
+  k_work_submit(&advertising_work);
+}
+
 /*============================================================================
  * Main Entry Point
  *===========================================================================*/
@@ -519,16 +2704,23 @@ int main(void) {
   /* Power-safe enforcement: Ensure structures match BLE packet requirements */
   BUILD_ASSERT(sizeof(accel_sample_t) == 10, "Sample must be 10 bytes");
   BUILD_ASSERT(sizeof(accel_packet_t) == 243, "Packet must be 243 bytes");
+  /* Also the length of the on-device FFT (ACCEL_SPECTRUM_N) */
   BUILD_ASSERT(RING_BUFFER_SAMPLES == 1024, "Buffer must remain 1024 for FFT");
 
   LOG_INF("=========================================");
   LOG_INF("ISRO Coin-Cell Accelerometer Rev 5.2");
   LOG_INF("=========================================");
   LOG_INF("Sample format: %u bytes", ACCEL_SAMPLE_SIZE);
-  LOG_INF("Packet format: %u bytes (%u samples)", ACCEL_PACKET_SIZE,
-          SAMPLES_PER_PACKET);
-  LOG_INF("Buffer depth: %u samples", RING_BUFFER_SAMPLES);
-  LOG_INF("Packets per burst: %u", PACKETS_PER_BURST);
+  LOG_INF("Packet format: %u bytes (%s, %u samples)", ACCEL_PACKET_SIZE,
+          IS_ENABLED(CONFIG_ACCEL_PACKET_V4) ? "v4" : "Rev 3",
+          IS_ENABLED(CONFIG_ACCEL_PACKET_V4) ? V4_DATA_SIZE / 6
+                                             : SAMPLES_PER_PACKET);
+  LOG_INF("Buffer depth: %u samples (%u packets)", RING_BUFFER_SAMPLES,
+          PACKET_RING_SLOTS);
+  LOG_INF("Packets per burst: sized to the link, %u at most",
+          PACKET_RING_SLOTS);
+
+  sampling_cfg_compute(SAMPLE_FREQ_HZ, CONFIG_ACCEL_CHANNEL_MASK, &sampling);
 
   /* Get I2C device */
   i2c_dev = DEVICE_DT_GET(DT_NODELABEL(i2c1)); /* Check I2C */
@@ -563,17 +2755,64 @@ int main(void) {
   }
   LOG_INF("Bluetooth initialized");
 
+  /* MTU, DLE, 2M PHY and interval negotiation on every connect */
+  err = conn_tune_init(mtu_updated);
+  if (err) {
+    LOG_WRN("Controller event length not tuned (err %d)", err);
+  }
+
   /* Load settings */
   if (IS_ENABLED(CONFIG_SETTINGS)) {
     settings_load();
   }
 
+#if defined(CONFIG_ACCEL_FLASH_LOG)
+  /* Needs the sent position from settings */
+  err = flash_log_init();
+  if (err) {
+    LOG_WRN("Flash log unavailable, packets are dropped while disconnected "
+            "(err %d)", err);
+  } else if (flash_log_pending() > 0) {
+    LOG_INF("Flash log: %u packets waiting for a central",
+            flash_log_pending());
+  }
+#endif
+
+  /* A stored setup replaces the default the sensor was brought up with */
+  if (sampling.rate_hz != SAMPLE_FREQ_HZ ||
+      sampling.channel_mask != CONFIG_ACCEL_CHANNEL_MASK) {
+    mpu6050_configure(&sampling);
+  }
+
   /* Initialize accelerometer service */
   err = accel_service_init();
   if (err) {
     LOG_ERR("Accel service init failed (err %d)", err);
     return 0; /* Changed from void return */
   }
+  accel_service_set_sampling_rate(sampling.rate_hz);
+  accel_service_set_rate_cb(sampling_rate_request);
+  accel_service_set_channel_mask(sampling.channel_mask);
+  accel_service_set_chmask_cb(channel_mask_request);
+#if defined(CONFIG_ACCEL_RETX)
+  accel_service_set_retx_cb(retx_request);
+#endif
+#if defined(CONFIG_ACCEL_TRIGGER)
+  /* The stored configuration, loaded with the settings */
+  trigger_config_t trigger;
+
+  trigger_get_config(&trigger);
+  accel_service_set_trigger_config(&trigger);
+  accel_service_set_trigger_cb(trigger_request);
+#endif
+
+#if defined(CONFIG_ACCEL_L2CAP_STREAM)
+  /* Optional: GATT notifications stay available without it */
+  err = l2cap_stream_init(l2cap_sent);
+  if (err) {
+    LOG_WRN("L2CAP stream unavailable (err %d)", err);
+  }
+#endif
 
   /* Start advertising */
   err = bt_le_adv_start(&adv_param, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
@@ -581,15 +2820,53 @@ int main(void) {
     LOG_ERR("Advertising failed to start (err %d)", err);
     return err;
   }
-  LOG_INF("Advertising started as '%s'", CONFIG_BT_DEVICE_NAME);
+  LOG_INF("Advertising started as '%s' (up to %u centrals)",
+          CONFIG_BT_DEVICE_NAME, CONFIG_BT_MAX_CONN);
+
+#if defined(CONFIG_ACCEL_PA_STREAM)
+  /* Receivers find the train by the same name and service UUID */
+  err = pa_stream_init(ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
+  if (err) {
+    LOG_ERR("Periodic advertising unavailable, nothing is sent (err %d)",
+            err);
+  }
+#endif
 
   /* Initialize burst start time */
   burst_start_ms = k_uptime_get_32();
 
-  /* Start sample timer at 1 kHz */
-  k_timer_start(&sample_timer, K_USEC(SAMPLE_PERIOD_US),
-                K_USEC(SAMPLE_PERIOD_US));
-  LOG_INF("Sampling started at %u Hz", SAMPLE_FREQ_HZ);
+#if defined(CONFIG_ACCEL_ACQ_FIFO)
+  /* Drop samples queued while the radio was coming up */
+  sampling_start();
+  LOG_INF("Sampling started at %u Hz (FIFO, drained every %u ms)",
+          sampling.rate_hz,
+          sampling.period_us * CONFIG_ACCEL_FIFO_WATERMARK_SAMPLES / 1000U);
+#elif defined(CONFIG_ACCEL_ACQ_DRDY)
+  /* Sensor DATA_RDY paces sampling - no k_timer tick */
+  if (mpu6050_drdy_setup() == 0 && sampling_start() == 0) {
+    LOG_INF("Sampling started at %u Hz (DATA_RDY interrupt)",
+            sampling.rate_hz);
+  } else {
+    LOG_ERR("DATA_RDY interrupt unavailable - sampling disabled");
+  }
+#elif defined(CONFIG_ACCEL_ACQ_DPPI)
+  /* TIMER paces TWIM reads in hardware - no k_timer tick */
+  err = acq_dppi_init(MPU6050_ADDR, sampling.start_reg, sampling.frame_size,
+                      sampling.period_us);
+  if (!err) {
+    err = sampling_start();
+  }
+  if (!err) {
+    LOG_INF("Sampling started at %u Hz (DPPI, %u-sample blocks)",
+            sampling.rate_hz, CONFIG_ACCEL_DPPI_BLOCK_SAMPLES);
+  } else {
+    LOG_ERR("DPPI acquisition failed to start (err %d)", err);
+  }
+#else
+  /* Start the sample timer at the configured rate */
+  sampling_start();
+  LOG_INF("Sampling started at %u Hz", sampling.rate_hz);
+#endif
 
   /* Start diagnostics timer (every 10 seconds) */
   k_timer_start(&diagnostics_timer, K_SECONDS(10), K_SECONDS(10));
@@ -0,0 +1,142 @@
+/**
+ * @file pa_stream.c
+ * @brief Connectionless streaming on a periodic advertising train
+ *
+ * The periodic interval is one 1.25 ms unit shorter than the update period
+ * CONFIG_ACCEL_PA_INTERVAL_MS the caller keeps. Host and controller clocks
+ * drift apart, so with equal periods an update would now and then be
+ * replaced before any event carried it; slightly faster events instead
+ * carry every update at least once, and once in a while one twice.
+ * Receivers drop the repeat by its sample counters.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "pa_stream.h"
+
+LOG_MODULE_REGISTER(pa_stream, LOG_LEVEL_INF);
+
+/*============================================================================
+ * Configuration
+ *===========================================================================*/
+
+/* Periodic interval in 1.25 ms units, see above */
+#define PA_INTERVAL (CONFIG_ACCEL_PA_INTERVAL_MS * 4 / 5 - 1)
+
+#define PA_AD_DATA_LEN (2 + ACCEL_PACKET_SIZE) /* Company ID + packet */
+#define PA_EXT_AD_MAX 4 /* Extended advertising data entries (ad + sd) */
+
+BUILD_ASSERT(PA_INTERVAL >= BT_GAP_PER_ADV_MIN_INTERVAL,
+             "CONFIG_ACCEL_PA_INTERVAL_MS too short");
+/* One set for the connectable advertising, one for the train */
+BUILD_ASSERT(CONFIG_BT_EXT_ADV_MAX_ADV_SET >= 2,
+             "CONFIG_ACCEL_PA_STREAM needs CONFIG_BT_EXT_ADV_MAX_ADV_SET=2");
+
+/*============================================================================
+ * State Variables
+ *===========================================================================*/
+
+static struct bt_le_ext_adv *pa_adv = NULL;
+
+/* Staged train: the packet follows the company ID in each AD structure */
+static uint8_t train_buf[PA_STREAM_TRAIN_PACKETS][PA_AD_DATA_LEN];
+static struct bt_data train_ad[PA_STREAM_TRAIN_PACKETS];
+
+/*============================================================================
+ * Helpers
+ *===========================================================================*/
+
+/* Set the data and parameters, then start the train and the set behind it */
+static int pa_start(struct bt_le_ext_adv *adv, const struct bt_data *ext_ad,
+                    size_t ext_ad_len) {
+  int err;
+
+  err = bt_le_ext_adv_set_data(adv, ext_ad, ext_ad_len, NULL, 0);
+  if (err) {
+    LOG_ERR("Extended advertising data not set (err %d)", err);
+    return err;
+  }
+
+  err = bt_le_per_adv_set_param(
+      adv, BT_LE_PER_ADV_PARAM(PA_INTERVAL, PA_INTERVAL,
+                               BT_LE_PER_ADV_OPT_NONE));
+  if (err) {
+    LOG_ERR("Periodic advertising parameters rejected (err %d)", err);
+    return err;
+  }
+
+  err = bt_le_per_adv_start(adv);
+  if (err) {
+    LOG_ERR("Periodic advertising failed to start (err %d)", err);
+    return err;
+  }
+
+  err = bt_le_ext_adv_start(adv, BT_LE_EXT_ADV_START_DEFAULT);
+  if (err) {
+    LOG_ERR("Extended advertising failed to start (err %d)", err);
+    bt_le_per_adv_stop(adv);
+  }
+  return err;
+}
+
+/*============================================================================
+ * API Implementation
+ *===========================================================================*/
+
+int pa_stream_init(const struct bt_data *ad, size_t ad_len,
+                   const struct bt_data *sd, size_t sd_len) {
+  struct bt_data ext_ad[PA_EXT_AD_MAX];
+  struct bt_le_ext_adv *adv;
+  int err;
+
+  if (ad_len + sd_len > ARRAY_SIZE(ext_ad)) {
+    return -EINVAL;
+  }
+  memcpy(ext_ad, ad, ad_len * sizeof(*ad));
+  memcpy(&ext_ad[ad_len], sd, sd_len * sizeof(*sd));
+
+  for (size_t i = 0; i < ARRAY_SIZE(train_buf); i++) {
+    sys_put_le16(PA_STREAM_COMPANY_ID, train_buf[i]);
+  }
+
+  err = bt_le_ext_adv_create(BT_LE_EXT_ADV_NCONN, NULL, &adv);
+  if (err) {
+    LOG_ERR("Advertising set not created (err %d)", err);
+    return err;
+  }
+
+  err = pa_start(adv, ext_ad, ad_len + sd_len);
+  if (err) {
+    bt_le_ext_adv_delete(adv);
+    return err;
+  }
+
+  pa_adv = adv;
+  LOG_INF("Periodic train every %u.%02u ms, up to %u packets each",
+          PA_INTERVAL * 5 / 4, (PA_INTERVAL * 5 % 4) * 25,
+          PA_STREAM_TRAIN_PACKETS);
+  return 0;
+}
+
+int pa_stream_send(const accel_packet_t *packets, size_t count) {
+  if (!pa_adv) {
+    return -ENODEV;
+  }
+  if (count == 0 || count > PA_STREAM_TRAIN_PACKETS) {
+    return -EINVAL;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    memcpy(&train_buf[i][2], &packets[i], ACCEL_PACKET_SIZE);
+    train_ad[i] = (struct bt_data)BT_DATA(BT_DATA_MANUFACTURER_DATA,
+                                          train_buf[i], PA_AD_DATA_LEN);
+  }
+
+  /* The host fragments it over several HCI commands */
+  return bt_le_per_adv_set_data(pa_adv, train_ad, count);
+}
@@ -0,0 +1,66 @@
+/**
+ * @file pa_stream.h
+ * @brief Connectionless streaming on a periodic advertising train
+ *
+ * A non-connectable extended advertising set, carrying the same name and
+ * service UUID as the connectable advertising, announces a periodic train.
+ * Every periodic event repeats the latest train data: up to
+ * PA_STREAM_TRAIN_PACKETS complete accel_packet_t (same layout and CRC as
+ * the GATT notifications), each in a manufacturer specific AD structure of
+ * its own behind company ID 0xFFFF. The controller chains them over
+ * AUX_CHAIN_IND PDUs.
+ *
+ * Receivers scan for the set, sync to its train and never transmit, so any
+ * number of them can listen and the sensor's radio schedule is fixed by the
+ * periodic interval alone.
+ */
+
+#ifndef PA_STREAM_H_
+#define PA_STREAM_H_
+
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/types.h>
+
+#include "accel_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Packets per train update: 6 x (2 + 2 + 243) = 1482 of 1650 bytes */
+#define PA_STREAM_TRAIN_PACKETS CONFIG_ACCEL_PA_TRAIN_PACKETS
+
+/* Manufacturer specific data company ID, reserved for testing */
+#define PA_STREAM_COMPANY_ID 0xFFFF
+
+/**
+ * @brief Create the advertising set and start the periodic train
+ *
+ * Call after bt_enable(). The extended advertising data is ad followed by
+ * sd: a non-scannable set has no scan response.
+ * @param ad Advertising data
+ * @param ad_len Entries in ad
+ * @param sd Scan response data of the connectable advertising
+ * @param sd_len Entries in sd
+ * @return 0 on success, negative errno on failure
+ */
+int pa_stream_init(const struct bt_data *ad, size_t ad_len,
+                   const struct bt_data *sd, size_t sd_len);
+
+/**
+ * @brief Replace the train data
+ *
+ * Every periodic event from the next one on carries these packets, until
+ * the next call. The packets are copied before returning.
+ * @param packets First of count contiguous packets
+ * @param count 1 to PA_STREAM_TRAIN_PACKETS
+ * @return 0 on success, -ENODEV before pa_stream_init() succeeded, negative
+ *         errno on failure
+ */
+int pa_stream_send(const accel_packet_t *packets, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PA_STREAM_H_ */
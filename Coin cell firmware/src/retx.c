@@ -0,0 +1,141 @@
+/**
+ * @file retx.c
+ * @brief Selective retransmission of recently sent packets
+ *
+ * Requests name their central by connection index, which the stack hands to
+ * the next central once this one leaves. Each index therefore carries a
+ * generation, bumped on disconnect; a request from an older generation is
+ * dropped instead of being answered to whoever holds the index now.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+
+#include "retx.h"
+
+LOG_MODULE_REGISTER(retx, LOG_LEVEL_INF);
+
+#define RETX_SLOTS CONFIG_ACCEL_RETX_PACKETS
+#define RETX_QUEUE_DEPTH 8
+
+struct retx_range {
+  uint32_t first;
+  uint16_t count;
+  uint8_t conn_index; /* bt_conn_index() of the central that asked */
+  uint8_t conn_gen;   /* conn_gen[conn_index] when it asked */
+};
+
+/* Written from BT RX context, read by the burst controller */
+K_MSGQ_DEFINE(retx_queue, sizeof(struct retx_range), RETX_QUEUE_DEPTH, 4);
+
+/* Bumped from BT RX context on disconnect, read by both sides */
+static atomic_t conn_gen[CONFIG_BT_MAX_CONN];
+
+/* Burst controller only */
+static accel_packet_t retained[RETX_SLOTS];
+static uint32_t retained_total = 0; /* Packets ever retained */
+
+static struct retx_range active;
+static bool active_valid = false;
+static bool active_matched = false;
+static uint32_t scan = 0; /* Next retained packet to check against active */
+
+static bool packet_overlaps(const accel_packet_t *pkt,
+                            const struct retx_range *range) {
+  uint32_t first;
+  uint16_t count;
+  uint32_t mask;
+
+  accel_packet_span(pkt, &first, &count, &mask);
+  if (count == 0) {
+    return false;
+  }
+
+  /* Either start lies inside the other range, modulo the counter width */
+  return ((first - range->first) & mask) < range->count ||
+         ((range->first - first) & mask) < count;
+}
+
+/* The central that asked for range has left since */
+static bool range_stale(const struct retx_range *range) {
+  return (uint8_t)atomic_get(&conn_gen[range->conn_index]) != range->conn_gen;
+}
+
+int retx_request(struct bt_conn *conn, uint32_t first_counter,
+                 uint16_t count) {
+  uint8_t index = bt_conn_index(conn);
+  struct retx_range range = {
+      .first = first_counter,
+      .count = count,
+      .conn_index = index,
+      .conn_gen = (uint8_t)atomic_get(&conn_gen[index]),
+  };
+
+  if (count == 0) {
+    return -EINVAL;
+  }
+  if (k_msgq_put(&retx_queue, &range, K_NO_WAIT)) {
+    return -ENOMEM;
+  }
+  return 0;
+}
+
+void retx_conn_closed(struct bt_conn *conn) {
+  atomic_inc(&conn_gen[bt_conn_index(conn)]);
+}
+
+void retx_retain(const accel_packet_t *packets, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    memcpy(&retained[retained_total % RETX_SLOTS], &packets[i],
+           sizeof(accel_packet_t));
+    retained_total++;
+  }
+}
+
+bool retx_next(accel_packet_t *packet, uint8_t *conn_index) {
+  for (;;) {
+    if (!active_valid) {
+      if (k_msgq_get(&retx_queue, &active, K_NO_WAIT)) {
+        return false;
+      }
+      active_valid = true;
+      active_matched = false;
+      scan = retained_total > RETX_SLOTS ? retained_total - RETX_SLOTS : 0;
+    }
+
+    if (range_stale(&active)) {
+      active_valid = false;
+      continue;
+    }
+
+    /* Copies overwritten since the scan started are simply skipped */
+    if (retained_total - scan > RETX_SLOTS) {
+      scan = retained_total - RETX_SLOTS;
+    }
+
+    while (scan < retained_total) {
+      const accel_packet_t *pkt = &retained[scan++ % RETX_SLOTS];
+
+      if (!packet_overlaps(pkt, &active)) {
+        continue;
+      }
+
+      memcpy(packet, pkt, sizeof(*packet));
+      packet->burst_id |= ACCEL_BURST_ID_RETX;
+      packet->crc16 = crc16_ccitt(0xFFFF, (const uint8_t *)packet,
+                                  ACCEL_PACKET_SIZE - 2);
+      *conn_index = active.conn_index;
+      active_matched = true;
+      return true;
+    }
+
+    if (!active_matched) {
+      LOG_WRN("Samples %u-%u no longer retained", active.first,
+              active.first + active.count - 1);
+    }
+    active_valid = false;
+  }
+}
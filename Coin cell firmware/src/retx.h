@@ -0,0 +1,73 @@
+/**
+ * @file retx.h
+ * @brief Selective retransmission of recently sent packets
+ *
+ * The burst controller keeps a copy of the last CONFIG_ACCEL_RETX_PACKETS
+ * packets it sent (or failed to send). A central that sees a gap in the
+ * sample counters writes the missing range to the retransmit characteristic;
+ * every retained packet holding part of it is sent again on the data
+ * characteristic with ACCEL_BURST_ID_RETX set, between live bursts, to
+ * the central that asked.
+ *
+ * Ranges are matched on each layout's own counter width: 16 bits for Rev 3
+ * and packed packets, 32 bits for v4. Ranges no longer retained are ignored.
+ */
+
+#ifndef RETX_H_
+#define RETX_H_
+
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/types.h>
+
+#include "accel_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Queue a range for retransmission (BT RX context)
+ * @param conn Central to resend to
+ * @param first_counter Sample counter of the first missing sample
+ * @param count Missing samples, at least 1
+ * @return 0 if queued, -EINVAL for an empty range, -ENOMEM if too many
+ *         requests are pending
+ */
+int retx_request(struct bt_conn *conn, uint32_t first_counter,
+                 uint16_t count);
+
+/**
+ * @brief Drop the requests of a central that disconnected (BT RX context)
+ *
+ * Pending and partly served requests are discarded, so a central that
+ * later gets the same connection index never receives them.
+ * @param conn Central that left
+ */
+void retx_conn_closed(struct bt_conn *conn);
+
+/**
+ * @brief Keep copies of packets just handed to the radio
+ *
+ * Burst controller thread only; overwrites the oldest copies.
+ * @param packets First of count packets
+ * @param count Packets to retain
+ */
+void retx_retain(const accel_packet_t *packets, size_t count);
+
+/**
+ * @brief Get the next packet to send again
+ *
+ * Burst controller thread only. The copy has ACCEL_BURST_ID_RETX set and its
+ * CRC updated.
+ * @param packet Destination
+ * @param conn_index Set to the bt_conn_index() of the central that asked,
+ *        still the same central as when it asked
+ * @return true if there is one, false if no request is pending
+ */
+bool retx_next(accel_packet_t *packet, uint8_t *conn_index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RETX_H_ */
@@ -0,0 +1,292 @@
+/**
+ * @file spectrum.c
+ * @brief On-device FFT spectrum of the accelerometer axes
+ *
+ * The periodic Hann window has a coherent gain of 1/2 and leaks a constant
+ * into bins 0 and 1 only, so the mean (gravity) stays out of every bin from
+ * 2 up. Bins are scaled by 4 / N (window gain and the folded negative
+ * frequencies) to read as sinusoid amplitudes; bin 0 by 2 / N, the mean.
+ */
+
+#include <arm_math.h>
+#include <math.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+
+#include "spectrum.h"
+
+LOG_MODULE_REGISTER(spectrum, LOG_LEVEL_INF);
+
+/*============================================================================
+ * Configuration
+ *===========================================================================*/
+
+#define SPECTRUM_N ACCEL_SPECTRUM_N
+#define SPECTRUM_BINS ACCEL_SPECTRUM_BINS
+#define SPECTRUM_AXES 3 /* Accelerometer X, Y, Z */
+
+BUILD_ASSERT(SPECTRUM_PEAKS <= ACCEL_SPECTRUM_PEAKS_MAX,
+             "CONFIG_ACCEL_SPECTRUM_PEAKS exceeds one notification");
+
+/*============================================================================
+ * Blocks (reader thread fills, spectrum thread transforms)
+ *===========================================================================*/
+
+struct spectrum_block {
+  int16_t samples[SPECTRUM_AXES][SPECTRUM_N];
+  uint32_t base_counter;
+  uint16_t rate_hz;
+  uint16_t seq;
+  uint8_t axes; /* ACCEL_CH_AX/AY/AZ */
+};
+
+static struct spectrum_block blocks[2];
+
+/* Reader thread only */
+static uint8_t filling = 0;
+static uint16_t fill_count = 0;
+static uint16_t block_seq = 0;
+static uint32_t blocks_dropped = 0;
+
+/* Set while the spectrum thread owns ready_block */
+static atomic_t block_busy = ATOMIC_INIT(0);
+static struct spectrum_block *ready_block = NULL;
+static K_SEM_DEFINE(block_sem, 0, 1);
+
+/*============================================================================
+ * Transform State (spectrum thread only)
+ *===========================================================================*/
+
+static arm_rfft_fast_instance_f32 rfft;
+static float32_t window[SPECTRUM_N];
+static float32_t fft_in[SPECTRUM_N];
+static float32_t fft_out[SPECTRUM_N];
+static float32_t mag[SPECTRUM_BINS];
+static accel_spectrum_t msg;
+
+struct spectrum_peak {
+  float32_t freq_hz;
+  float32_t amplitude;
+};
+
+/*============================================================================
+ * Helpers
+ *===========================================================================*/
+
+/* Amplitude spectrum of one axis into mag[]. Returns its largest value. */
+static float32_t axis_spectrum(const int16_t *x) {
+  float32_t max = 0.0f;
+
+  for (size_t i = 0; i < SPECTRUM_N; i++) {
+    fft_in[i] = (float32_t)x[i] * window[i];
+  }
+
+  /* fft_in is used as scratch. fft_out[0] and [1] are the real DC and
+   * Nyquist terms, then re/im pairs from bin 1 up. */
+  arm_rfft_fast_f32(&rfft, fft_in, fft_out, 0);
+  mag[0] = fabsf(fft_out[0]) * 0.5f;
+  arm_cmplx_mag_f32(&fft_out[2], &mag[1], SPECTRUM_BINS - 1);
+
+  for (size_t k = 0; k < SPECTRUM_BINS; k++) {
+    mag[k] *= 4.0f / SPECTRUM_N;
+    max = MAX(max, mag[k]);
+  }
+  return max;
+}
+
+/* Largest shift that keeps max within 16 bits */
+static uint8_t value_shift(float32_t max) {
+  uint8_t shift = 0;
+
+  while (shift < 15 && max * (float32_t)(1U << (shift + 1)) <= UINT16_MAX) {
+    shift++;
+  }
+  return shift;
+}
+
+static uint16_t value_scale(float32_t v, uint8_t shift) {
+  v = v * (float32_t)(1U << shift) + 0.5f;
+  return v >= UINT16_MAX ? UINT16_MAX : (uint16_t)v;
+}
+
+/* Strongest SPECTRUM_PEAKS local maxima of mag[], strongest first */
+static uint8_t peaks_find(uint16_t rate_hz, struct spectrum_peak *peaks) {
+  uint8_t n = 0;
+
+  /* Bins 0 and 1 hold the mean */
+  for (size_t k = 2; k < SPECTRUM_BINS - 1; k++) {
+    float32_t a = mag[k - 1];
+    float32_t b = mag[k];
+    float32_t c = mag[k + 1];
+
+    if (b <= a || b < c) {
+      continue;
+    }
+
+    /* Vertex of the parabola through the three bins; b is a strict maximum
+     * on the left, so the denominator is negative */
+    float32_t delta = 0.5f * (a - c) / (a - 2.0f * b + c);
+    struct spectrum_peak p = {
+        .freq_hz = ((float32_t)k + delta) * rate_hz / SPECTRUM_N,
+        .amplitude = b - 0.25f * (a - c) * delta,
+    };
+
+    if (n == SPECTRUM_PEAKS && p.amplitude <= peaks[n - 1].amplitude) {
+      continue;
+    }
+
+    /* Insertion into the sorted list, the weakest falls off when full */
+    size_t i = (n < SPECTRUM_PEAKS) ? n++ : n - 1;
+
+    while (i > 0 && peaks[i - 1].amplitude < p.amplitude) {
+      peaks[i] = peaks[i - 1];
+      i--;
+    }
+    peaks[i] = p;
+  }
+  return n;
+}
+
+static void msg_header(const struct spectrum_block *b, uint8_t axis,
+                       uint8_t shift) {
+  msg.axis = axis;
+  msg.shift = shift;
+  msg.block = b->seq;
+  msg.rate_hz = b->rate_hz;
+  msg.base_counter = b->base_counter;
+}
+
+static int send_bins(const struct spectrum_block *b, uint8_t axis,
+                     float32_t max) {
+  uint8_t shift = value_shift(max);
+
+  msg_header(b, axis, shift);
+  for (uint16_t first = 0; first < SPECTRUM_BINS;
+       first += ACCEL_SPECTRUM_CHUNK_BINS) {
+    uint16_t count = MIN(ACCEL_SPECTRUM_CHUNK_BINS, SPECTRUM_BINS - first);
+
+    msg.first_bin = first;
+    msg.count = (uint8_t)count;
+    for (uint16_t i = 0; i < count; i++) {
+      msg.bins[i] = value_scale(mag[first + i], shift);
+    }
+
+    int err = accel_service_notify_spectrum(
+        NULL, &msg, ACCEL_SPECTRUM_HDR_SIZE + count * sizeof(msg.bins[0]));
+    if (err) {
+      return err;
+    }
+  }
+  return 0;
+}
+
+static int send_peaks(const struct spectrum_block *b, uint8_t axis) {
+  struct spectrum_peak peaks[MAX(SPECTRUM_PEAKS, 1)];
+  uint8_t n = peaks_find(b->rate_hz, peaks);
+  uint8_t shift = value_shift(n > 0 ? peaks[0].amplitude : 0.0f);
+
+  msg_header(b, axis | ACCEL_SPECTRUM_PEAKS, shift);
+  msg.first_bin = 0;
+  msg.count = n;
+  for (uint8_t i = 0; i < n; i++) {
+    msg.peaks[i].freq_chz = value_scale(peaks[i].freq_hz * 100.0f, 0);
+    msg.peaks[i].amplitude = value_scale(peaks[i].amplitude, shift);
+  }
+
+  return accel_service_notify_spectrum(
+      NULL, &msg, ACCEL_SPECTRUM_HDR_SIZE + n * sizeof(msg.peaks[0]));
+}
+
+static void spectrum_send(const struct spectrum_block *b) {
+  for (uint8_t axis = 0; axis < SPECTRUM_AXES; axis++) {
+    if (!(b->axes & BIT(axis))) {
+      continue;
+    }
+
+    float32_t max = axis_spectrum(b->samples[axis]);
+    int err = (SPECTRUM_PEAKS > 0) ? send_peaks(b, axis)
+                                   : send_bins(b, axis, max);
+    if (err) {
+      LOG_WRN("Spectrum %u not sent (err %d)", b->seq, err);
+      return;
+    }
+  }
+}
+
+/*============================================================================
+ * API Implementation
+ *===========================================================================*/
+
+void spectrum_push(const int16_t xyz[3], uint8_t axes, uint16_t rate_hz,
+                   uint32_t counter) {
+  struct spectrum_block *b = &blocks[filling];
+
+  /* Only consecutive samples of one configuration make a block */
+  if (fill_count > 0 &&
+      (axes != b->axes || rate_hz != b->rate_hz ||
+       counter != b->base_counter + fill_count)) {
+    fill_count = 0;
+  }
+  if (axes == 0) {
+    return;
+  }
+
+  if (fill_count == 0) {
+    b->axes = axes;
+    b->rate_hz = rate_hz;
+    b->base_counter = counter;
+  }
+  for (uint8_t axis = 0; axis < SPECTRUM_AXES; axis++) {
+    b->samples[axis][fill_count] = xyz[axis];
+  }
+  if (++fill_count < SPECTRUM_N) {
+    return;
+  }
+
+  /* Block complete: hand it over, or refill it if the other is still busy */
+  fill_count = 0;
+  b->seq = block_seq++;
+  if (!atomic_cas(&block_busy, 0, 1)) {
+    blocks_dropped++;
+    LOG_WRN("Spectrum %u dropped, previous one still sending (%u total)",
+            b->seq, blocks_dropped);
+    return;
+  }
+  ready_block = b;
+  filling ^= 1;
+  k_sem_give(&block_sem);
+}
+
+/*============================================================================
+ * Spectrum Thread
+ *
+ * Below the burst controller: a block takes ~1 ms per axis to transform,
+ * and sending may wait for TX buffers, with a whole block period to spare.
+ *===========================================================================*/
+
+static void spectrum_thread_fn(void *p1, void *p2, void *p3) {
+  ARG_UNUSED(p1);
+  ARG_UNUSED(p2);
+  ARG_UNUSED(p3);
+
+  arm_rfft_fast_init_f32(&rfft, SPECTRUM_N);
+  for (size_t i = 0; i < SPECTRUM_N; i++) {
+    window[i] = 0.5f - 0.5f * cosf(2.0f * PI * i / SPECTRUM_N);
+  }
+  LOG_INF("Spectrum thread started (%u-point FFT, %s)", SPECTRUM_N,
+          SPECTRUM_PEAKS > 0 ? "peaks" : "full spectrum");
+
+  while (1) {
+    k_sem_take(&block_sem, K_FOREVER);
+
+    /* Nobody listening: skip the transform */
+    if (accel_service_spectrum_notify_enabled(NULL)) {
+      spectrum_send(ready_block);
+    }
+    atomic_clear(&block_busy);
+  }
+}
+
+K_THREAD_DEFINE(spectrum, 2048, spectrum_thread_fn, NULL, NULL, NULL, 7, 0,
+                0); /* Priority 7 = lower than burst controller */
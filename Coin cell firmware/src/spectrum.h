@@ -0,0 +1,47 @@
+/**
+ * @file spectrum.h
+ * @brief On-device FFT spectrum of the accelerometer axes
+ *
+ * The reader thread hands every sample to spectrum_push() instead of packing
+ * it into the packet ring. Each run of ACCEL_SPECTRUM_N consecutive samples
+ * at one rate and channel mask makes a block; completed blocks go to a low
+ * priority thread that windows them, runs arm_rfft_fast_f32 per axis on the
+ * FPU and notifies the magnitude spectrum, or its strongest peaks, on the
+ * spectrum characteristic (layout in accel_service.h).
+ *
+ * Two blocks are kept: one filling while the other is transformed and sent.
+ * A block completed while the previous one is still being sent is dropped.
+ */
+
+#ifndef SPECTRUM_H_
+#define SPECTRUM_H_
+
+#include <zephyr/types.h>
+
+#include "accel_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Peaks sent per axis, 0 = full spectrum */
+#define SPECTRUM_PEAKS CONFIG_ACCEL_SPECTRUM_PEAKS
+
+/**
+ * @brief Add one sample to the block being filled
+ *
+ * Reader thread only. A change of axes or rate, or a gap in the sample
+ * counter, restarts the block.
+ * @param xyz Accelerometer X, Y and Z in raw counts (unused axes ignored)
+ * @param axes ACCEL_CH_AX/AY/AZ bits to transform, 0 to skip the sample
+ * @param rate_hz Sampling rate of the sample
+ * @param counter Sample counter of the sample
+ */
+void spectrum_push(const int16_t xyz[3], uint8_t axes, uint16_t rate_hz,
+                   uint32_t counter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPECTRUM_H_ */
@@ -0,0 +1,179 @@
+/**
+ * @file spsc_ring.h
+ * @brief Lock-free single-producer/single-consumer ring of fixed-size slots
+ *
+ * The producer owns head, the consumer owns tail. Each side publishes its
+ * index with a release store and reads the other side's index with an
+ * acquire load, so slot contents written before a commit are visible to the
+ * consumer, and slots are only reused after the consumer released them.
+ * No locks, no interrupt masking: safe between two threads, or a thread and
+ * an ISR, as long as each side has exactly one context.
+ *
+ * Indices run freely and are masked on access, so capacity must be a power
+ * of two and "used" is always head - tail.
+ *
+ * The consumer may also read ahead of the tail through cursors of its own
+ * (spsc_ring_peek_from()), e.g. one per reader of the same data, and release
+ * slots once the last cursor has passed them.
+ */
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct spsc_ring {
+  uint32_t head; /* Next slot to fill, written by the producer only */
+  uint32_t tail; /* Next slot to read, written by the consumer only */
+  uint8_t *buf;
+  uint32_t mask; /* capacity - 1 */
+  uint16_t elem_size;
+};
+
+/**
+ * @brief Statically define a ring of capacity elements of type
+ * @param name Name of the struct spsc_ring
+ * @param type Slot type
+ * @param capacity Number of slots, a power of two
+ */
+#define SPSC_RING_DEFINE(name, type, capacity)                                 \
+  BUILD_ASSERT(IS_POWER_OF_TWO(capacity), "SPSC capacity must be 2^n");        \
+  static type _spsc_buf_##name[capacity];                                      \
+  static struct spsc_ring name = {                                             \
+      .buf = (uint8_t *)_spsc_buf_##name,                                      \
+      .mask = (capacity) - 1,                                                  \
+      .elem_size = sizeof(type),                                               \
+  }
+
+static inline uint32_t spsc_ring_capacity(const struct spsc_ring *r) {
+  return r->mask + 1;
+}
+
+static inline void *spsc_ring_slot(const struct spsc_ring *r, uint32_t idx) {
+  return r->buf + (size_t)(idx & r->mask) * r->elem_size;
+}
+
+/*============================================================================
+ * Producer Side
+ *===========================================================================*/
+
+/**
+ * @brief Free slots, as seen by the producer
+ */
+static inline uint32_t spsc_ring_free_space(const struct spsc_ring *r) {
+  uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+
+  return spsc_ring_capacity(r) - (r->head - tail);
+}
+
+/**
+ * @brief Reserve up to want contiguous free slots
+ *
+ * Nothing is visible to the consumer until spsc_ring_commit().
+ * @param span Set to the first reserved slot
+ * @return Slots reserved (0 if full); may be less than want at the wrap
+ */
+static inline uint32_t spsc_ring_reserve(struct spsc_ring *r, void **span,
+                                         uint32_t want) {
+  uint32_t head = r->head;
+  uint32_t to_wrap = spsc_ring_capacity(r) - (head & r->mask);
+  uint32_t n = MIN(MIN(want, spsc_ring_free_space(r)), to_wrap);
+
+  *span = spsc_ring_slot(r, head);
+  return n;
+}
+
+/**
+ * @brief Publish n slots filled since spsc_ring_reserve()
+ */
+static inline void spsc_ring_commit(struct spsc_ring *r, uint32_t n) {
+  __atomic_store_n(&r->head, r->head + n, __ATOMIC_RELEASE);
+}
+
+/*============================================================================
+ * Consumer Side
+ *===========================================================================*/
+
+/**
+ * @brief Filled slots, as seen by the consumer
+ */
+static inline uint32_t spsc_ring_used(const struct spsc_ring *r) {
+  return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - r->tail;
+}
+
+/**
+ * @brief Contiguous filled slots starting at the tail
+ * @param span Set to the oldest filled slot
+ * @param want Maximum slots to return
+ * @return Slots available in span (0 if empty); may be less than want and
+ *         less than spsc_ring_used() at the wrap
+ */
+static inline uint32_t spsc_ring_peek(const struct spsc_ring *r, void **span,
+                                      uint32_t want) {
+  uint32_t to_wrap = spsc_ring_capacity(r) - (r->tail & r->mask);
+  uint32_t n = MIN(MIN(want, spsc_ring_used(r)), to_wrap);
+
+  *span = spsc_ring_slot(r, r->tail);
+  return n;
+}
+
+/**
+ * @brief Filled slot i positions after the tail (i < spsc_ring_used())
+ */
+static inline void *spsc_ring_at(const struct spsc_ring *r, uint32_t i) {
+  return spsc_ring_slot(r, r->tail + i);
+}
+
+/**
+ * @brief Index one past the newest filled slot, as seen by the consumer
+ *
+ * Every index in [tail, head) is a filled slot.
+ */
+static inline uint32_t spsc_ring_head(const struct spsc_ring *r) {
+  return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Contiguous filled slots starting at a consumer cursor
+ * @param idx Cursor, between the tail and spsc_ring_head()
+ * @param span Set to the slot at idx
+ * @param want Maximum slots to return
+ * @return Slots available in span (0 if idx is the head); may be less than
+ *         want at the wrap
+ */
+static inline uint32_t spsc_ring_peek_from(const struct spsc_ring *r,
+                                           uint32_t idx, void **span,
+                                           uint32_t want) {
+  uint32_t to_wrap = spsc_ring_capacity(r) - (idx & r->mask);
+  uint32_t n = MIN(MIN(want, spsc_ring_head(r) - idx), to_wrap);
+
+  *span = spsc_ring_slot(r, idx);
+  return n;
+}
+
+/**
+ * @brief Release n slots back to the producer
+ */
+static inline void spsc_ring_consume(struct spsc_ring *r, uint32_t n) {
+  __atomic_store_n(&r->tail, r->tail + n, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Release everything the producer has committed so far
+ */
+static inline void spsc_ring_drain(struct spsc_ring *r) {
+  __atomic_store_n(&r->tail, __atomic_load_n(&r->head, __ATOMIC_ACQUIRE),
+                   __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPSC_RING_H_ */
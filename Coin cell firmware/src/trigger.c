@@ -0,0 +1,229 @@
+/**
+ * @file trigger.c
+ * @brief Event detection for triggered capture
+ *
+ * Per axis: dc is an exponential average with a 1 s time constant, the
+ * RMS conditions average the squared signal with a window_ms time constant,
+ * and TRIGGER_BAND filters with an RBJ band-pass biquad (0 dB peak) first.
+ * Detection is edge-triggered per axis: an axis fires when its condition
+ * becomes true and re-arms when it turns false.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+
+#include "bandpass.h"
+#include "trigger.h"
+
+LOG_MODULE_REGISTER(trigger, LOG_LEVEL_INF);
+
+#define TRIGGER_AXES 3 /* Accelerometer X, Y, Z */
+
+/*============================================================================
+ * State Variables
+ *===========================================================================*/
+
+/* Written from BT RX context, copied by the reader thread */
+static struct k_spinlock config_lock;
+static trigger_config_t config; /* TRIGGER_OFF */
+static atomic_t config_gen = ATOMIC_INIT(0);
+
+/* Written by the reader thread, taken by the burst controller */
+static struct k_spinlock event_lock;
+static bool event_pending = false;
+static uint32_t event_first = 0;
+static uint32_t event_last = 0;
+
+struct axis_detector {
+  bool started; /* dc and prev hold a sample */
+  bool active;  /* Condition held on the last sample */
+  float dc;
+  float ms; /* Averaged square */
+  int16_t prev;
+  struct bandpass_state bp;
+};
+
+/* Reader thread only */
+static trigger_config_t active_cfg;
+static atomic_val_t active_gen = -1;
+static uint8_t active_axes = 0;
+static uint16_t active_rate_hz = 0;
+static struct axis_detector detectors[TRIGGER_AXES];
+static float dc_alpha;
+static float ms_alpha;
+static float threshold_sq;
+static struct bandpass bp;
+static bool bp_valid;
+
+/*============================================================================
+ * Helpers
+ *===========================================================================*/
+
+static bool config_valid(const trigger_config_t *cfg) {
+  if (cfg->type == TRIGGER_OFF) {
+    return true;
+  }
+  if (cfg->type > TRIGGER_BAND || cfg->threshold == 0 ||
+      cfg->pre_ms > TRIGGER_PRE_MAX_MS || cfg->pre_ms + cfg->post_ms == 0) {
+    return false;
+  }
+  if ((cfg->axes & ACCEL_CH_ACCEL_XYZ) == 0 ||
+      (cfg->axes & ~ACCEL_CH_ACCEL_XYZ) != 0) {
+    return false;
+  }
+  if ((cfg->type == TRIGGER_RMS || cfg->type == TRIGGER_BAND) &&
+      cfg->window_ms == 0) {
+    return false;
+  }
+  if (cfg->type == TRIGGER_BAND &&
+      (cfg->band_lo_hz == 0 || cfg->band_lo_hz >= cfg->band_hi_hz)) {
+    return false;
+  }
+  return true;
+}
+
+/* Coefficients for the configuration and rate, fresh detector state */
+static void detector_setup(uint16_t rate_hz) {
+  dc_alpha = 1.0f / rate_hz;
+  ms_alpha = MIN(1000.0f / ((float)rate_hz * active_cfg.window_ms), 1.0f);
+  threshold_sq = (float)active_cfg.threshold * active_cfg.threshold;
+
+  /* A band reaching Nyquist never fires */
+  bp_valid = bandpass_design(&bp, active_cfg.band_lo_hz,
+                             active_cfg.band_hi_hz, rate_hz);
+
+  memset(detectors, 0, sizeof(detectors));
+}
+
+/* Condition of one axis after taking in sample x */
+static bool detector_update(struct axis_detector *d, int16_t x) {
+  float xf = x;
+  bool hit = false;
+
+  if (!d->started) {
+    d->started = true;
+    d->dc = xf;
+    d->prev = x;
+    /* Band-pass at rest on x, no step response */
+    bandpass_rest(&bp, &d->bp, xf);
+  }
+  d->dc += dc_alpha * (xf - d->dc);
+
+  switch (active_cfg.type) {
+  case TRIGGER_LEVEL:
+    hit = fabsf(xf - d->dc) >= active_cfg.threshold;
+    break;
+  case TRIGGER_SLOPE:
+    hit = abs(x - d->prev) >= active_cfg.threshold;
+    break;
+  case TRIGGER_RMS: {
+    float ac = xf - d->dc;
+
+    d->ms += ms_alpha * (ac * ac - d->ms);
+    hit = d->ms >= threshold_sq;
+    break;
+  }
+  case TRIGGER_BAND: {
+    float y = bandpass_step(&bp, &d->bp, xf);
+
+    d->ms += ms_alpha * (y * y - d->ms);
+    hit = bp_valid && d->ms >= threshold_sq;
+    break;
+  }
+  default:
+    break;
+  }
+
+  d->prev = x;
+  return hit;
+}
+
+static void event_record(uint32_t counter) {
+  k_spinlock_key_t key = k_spin_lock(&event_lock);
+
+  if (!event_pending) {
+    event_pending = true;
+    event_first = counter;
+  }
+  event_last = counter;
+  k_spin_unlock(&event_lock, key);
+}
+
+/*============================================================================
+ * API Implementation
+ *===========================================================================*/
+
+int trigger_configure(const trigger_config_t *cfg) {
+  if (!config_valid(cfg)) {
+    return -EINVAL;
+  }
+
+  k_spinlock_key_t key = k_spin_lock(&config_lock);
+
+  config = *cfg;
+  k_spin_unlock(&config_lock, key);
+  atomic_inc(&config_gen);
+
+  LOG_INF("Trigger type %u on axes 0x%02x, threshold %u, %u ms + %u ms",
+          cfg->type, cfg->axes, cfg->threshold, cfg->pre_ms, cfg->post_ms);
+  return 0;
+}
+
+void trigger_get_config(trigger_config_t *cfg) {
+  k_spinlock_key_t key = k_spin_lock(&config_lock);
+
+  *cfg = config;
+  k_spin_unlock(&config_lock, key);
+}
+
+void trigger_push(const int16_t xyz[3], uint8_t axes, uint16_t rate_hz,
+                  uint32_t counter) {
+  atomic_val_t gen = atomic_get(&config_gen);
+
+  if (gen != active_gen || axes != active_axes || rate_hz != active_rate_hz) {
+    trigger_get_config(&active_cfg);
+    active_gen = gen;
+    active_axes = axes;
+    active_rate_hz = rate_hz;
+    detector_setup(rate_hz);
+  }
+  if (active_cfg.type == TRIGGER_OFF) {
+    return;
+  }
+
+  bool fired = false;
+
+  for (uint8_t a = 0; a < TRIGGER_AXES; a++) {
+    struct axis_detector *d = &detectors[a];
+
+    if (!(axes & active_cfg.axes & BIT(a))) {
+      continue;
+    }
+
+    bool hit = detector_update(d, xyz[a]);
+
+    fired |= hit && !d->active;
+    d->active = hit;
+  }
+
+  if (fired) {
+    event_record(counter);
+  }
+}
+
+bool trigger_take(uint32_t *first, uint32_t *last) {
+  k_spinlock_key_t key = k_spin_lock(&event_lock);
+  bool pending = event_pending;
+
+  *first = event_first;
+  *last = event_last;
+  event_pending = false;
+  k_spin_unlock(&event_lock, key);
+  return pending;
+}
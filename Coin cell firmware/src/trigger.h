@@ -0,0 +1,62 @@
+/**
+ * @file trigger.h
+ * @brief Event detection for triggered capture
+ *
+ * The reader thread runs every sample it reads through trigger_push(),
+ * which evaluates the condition written to the trigger characteristic
+ * (trigger_config_t in accel_service.h) on each watched accelerometer axis.
+ * Events are picked up by the burst controller with trigger_take(), which
+ * decides what part of the packet ring is sent.
+ */
+
+#ifndef TRIGGER_H_
+#define TRIGGER_H_
+
+#include <zephyr/types.h>
+
+#include "accel_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Replace the trigger configuration (any thread)
+ *
+ * The reader thread restarts detection with it from its next sample.
+ * @param cfg New configuration (copied)
+ * @return 0 on success, -EINVAL if cfg is not valid
+ */
+int trigger_configure(const trigger_config_t *cfg);
+
+/**
+ * @brief Get the configuration in effect
+ * @param cfg Destination
+ */
+void trigger_get_config(trigger_config_t *cfg);
+
+/**
+ * @brief Evaluate the condition on one sample
+ *
+ * Reader thread only. A change of axes or rate restarts detection.
+ * @param xyz Accelerometer X, Y and Z in raw counts (unused axes ignored)
+ * @param axes ACCEL_CH_AX/AY/AZ bits captured
+ * @param rate_hz Sampling rate of the sample
+ * @param counter Sample counter of the sample
+ */
+void trigger_push(const int16_t xyz[3], uint8_t axes, uint16_t rate_hz,
+                  uint32_t counter);
+
+/**
+ * @brief Take the events detected since the last call
+ * @param first Set to the sample counter of the first of them
+ * @param last Set to the sample counter of the last of them
+ * @return true if there was at least one
+ */
+bool trigger_take(uint32_t *first, uint32_t *last);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRIGGER_H_ */
@@ -0,0 +1,8 @@
+/* Host stand-in for the Zephyr header spsc_ring.h includes */
+#ifndef SHIM_ZEPHYR_SYS_UTIL_H_
+#define SHIM_ZEPHYR_SYS_UTIL_H_
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define IS_POWER_OF_TWO(x) (((x) != 0U) && (((x) & ((x) - 1U)) == 0U))
+
+#endif /* SHIM_ZEPHYR_SYS_UTIL_H_ */
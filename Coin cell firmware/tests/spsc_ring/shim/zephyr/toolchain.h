@@ -0,0 +1,7 @@
+/* Host stand-in for the Zephyr header spsc_ring.h includes */
+#ifndef SHIM_ZEPHYR_TOOLCHAIN_H_
+#define SHIM_ZEPHYR_TOOLCHAIN_H_
+
+#define BUILD_ASSERT(expr, msg) _Static_assert(expr, msg)
+
+#endif /* SHIM_ZEPHYR_TOOLCHAIN_H_ */
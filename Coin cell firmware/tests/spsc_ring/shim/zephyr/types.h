@@ -0,0 +1,8 @@
+/* Host stand-in for the Zephyr header spsc_ring.h includes */
+#ifndef SHIM_ZEPHYR_TYPES_H_
+#define SHIM_ZEPHYR_TYPES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#endif /* SHIM_ZEPHYR_TYPES_H_ */
@@ -0,0 +1,206 @@
+/**
+ * @file spsc_ring_stress.c
+ * @brief Producer/consumer stress test for spsc_ring.h
+ *
+ * One pthread produces numbered elements through reserve/commit, another
+ * consumes them through peek/consume, cursors (peek_from/at) and the odd
+ * drain, all with random sizes. The ring is small and its indices start
+ * just below 2^32, so both the slot wrap and the index wrap are crossed
+ * constantly. Every element read is checked against the sequence the
+ * consumer expects; a slot read before its contents were published, or
+ * after being reused, shows up as a wrong number or a torn element.
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* By path: src/ also has a features.h that would shadow the libc one */
+#include "../../src/spsc_ring.h"
+
+#define RING_CAPACITY 64
+#define DEFAULT_ELEMENTS 4000000U
+#define INDEX_START 0xFFFFFF00U /* Indices wrap early in the run */
+
+struct element {
+  uint32_t seq;
+  uint32_t inv; /* ~seq */
+  uint8_t fill[8]; /* Low byte of seq, a torn copy breaks it */
+};
+
+SPSC_RING_DEFINE(ring, struct element, RING_CAPACITY);
+
+static uint32_t total;
+static uint32_t failures;
+
+/*============================================================================
+ * Helpers
+ *===========================================================================*/
+
+static uint32_t rand_next(uint32_t *state) {
+  uint32_t x = *state; /* xorshift32 */
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+/* 1..max */
+static uint32_t rand_size(uint32_t *state, uint32_t max) {
+  return 1U + rand_next(state) % max;
+}
+
+static void element_fill(struct element *e, uint32_t seq) {
+  e->seq = seq;
+  e->inv = ~seq;
+  for (size_t i = 0; i < sizeof(e->fill); i++) {
+    e->fill[i] = (uint8_t)seq;
+  }
+}
+
+static bool element_check(const struct element *e, uint32_t seq) {
+  bool ok = e->seq == seq && e->inv == ~seq;
+
+  for (size_t i = 0; i < sizeof(e->fill); i++) {
+    ok = ok && e->fill[i] == (uint8_t)seq;
+  }
+  if (!ok && failures++ < 10) {
+    fprintf(stderr, "expected %" PRIu32 ", got %" PRIu32 "/%08" PRIx32 "\n",
+            seq, e->seq, e->inv);
+  }
+  return ok;
+}
+
+/*============================================================================
+ * Threads
+ *===========================================================================*/
+
+static void *producer(void *arg) {
+  uint32_t rng = 0x12345678U;
+  uint32_t seq = 0;
+
+  (void)arg;
+  while (seq < total) {
+    void *span;
+    uint32_t n = spsc_ring_reserve(&ring, &span, rand_size(&rng, RING_CAPACITY));
+
+    if (n == 0) {
+      sched_yield();
+      continue;
+    }
+
+    struct element *e = span;
+
+    n = MIN(n, total - seq);
+    for (uint32_t i = 0; i < n; i++) {
+      element_fill(&e[i], seq + i);
+    }
+    /* Publish part of it at times; the rest is reserved again next round */
+    uint32_t commit = (rand_next(&rng) & 3) ? n : rand_size(&rng, n);
+
+    spsc_ring_commit(&ring, commit);
+    seq += commit;
+  }
+  return NULL;
+}
+
+/* Walk from the tail to the head with a cursor, then release what was read */
+static uint32_t consume_by_cursor(uint32_t *rng, uint32_t expect) {
+  uint32_t idx = ring.tail;
+  uint32_t head = spsc_ring_head(&ring);
+
+  while (idx != head) {
+    void *span;
+    uint32_t n = spsc_ring_peek_from(&ring, idx, &span,
+                                     rand_size(rng, RING_CAPACITY));
+    const struct element *e = span;
+
+    for (uint32_t i = 0; i < n; i++) {
+      element_check(&e[i], expect + (idx - ring.tail) + i);
+    }
+    idx += n;
+  }
+
+  uint32_t n = idx - ring.tail;
+
+  if (n > 0) {
+    element_check(spsc_ring_at(&ring, n - 1), expect + n - 1);
+  }
+  spsc_ring_consume(&ring, n);
+  return n;
+}
+
+static void *consumer(void *arg) {
+  uint32_t rng = 0x9E3779B9U;
+  uint32_t expect = 0;
+
+  (void)arg;
+  while (expect < total) {
+    uint32_t mode = rand_next(&rng) % 64;
+    uint32_t n;
+
+    if (mode == 0) {
+      /* Everything committed goes unread; the numbers skip ahead */
+      uint32_t tail = ring.tail;
+
+      spsc_ring_drain(&ring);
+      n = ring.tail - tail;
+    } else if (mode < 16) {
+      n = consume_by_cursor(&rng, expect);
+    } else {
+      void *span;
+      uint32_t got =
+          spsc_ring_peek(&ring, &span, rand_size(&rng, RING_CAPACITY));
+      const struct element *e = span;
+
+      for (uint32_t i = 0; i < got; i++) {
+        element_check(&e[i], expect + i);
+      }
+      /* Release part of it at times; the rest is peeked again */
+      n = (got == 0 || (rand_next(&rng) & 3)) ? got : rand_size(&rng, got);
+      spsc_ring_consume(&ring, n);
+    }
+
+    if (n == 0) {
+      sched_yield();
+    }
+    expect += n;
+  }
+  return NULL;
+}
+
+/*============================================================================
+ * Main
+ *===========================================================================*/
+
+int main(int argc, char **argv) {
+  pthread_t prod;
+  pthread_t cons;
+
+  total = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_ELEMENTS;
+  ring.head = INDEX_START;
+  ring.tail = INDEX_START;
+
+  if (pthread_create(&cons, NULL, consumer, NULL) != 0 ||
+      pthread_create(&prod, NULL, producer, NULL) != 0) {
+    fprintf(stderr, "pthread_create failed\n");
+    return 2;
+  }
+  pthread_join(prod, NULL);
+  pthread_join(cons, NULL);
+
+  if (ring.head != ring.tail || ring.head != INDEX_START + total) {
+    fprintf(stderr, "end indices %08" PRIx32 "/%08" PRIx32 "\n", ring.head,
+            ring.tail);
+    failures++;
+  }
+  printf("%" PRIu32 " elements through a %u-slot ring, %" PRIu32
+         " failures\n",
+         total, RING_CAPACITY, failures);
+  return failures == 0 ? 0 : 1;
+}
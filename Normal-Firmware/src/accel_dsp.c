@@ -0,0 +1,300 @@
+/**
+ * @file accel_dsp.c
+ * @brief Fixed-point block DSP kernels for the sample path
+ *
+ * Every kernel is written against the handful of primitives below. With
+ * __ARM_FEATURE_DSP they are the ACLE SIMD intrinsics; without it they are
+ * C that computes exactly the same integers (wrapping and saturation
+ * included), so a host build is bit-exact with the target. Pairs of samples
+ * are read as one little-endian word, as the M33 loads them, so the host
+ * must be little-endian too. This file only needs the C library, so it
+ * builds outside Zephyr as it is.
+ *
+ * Cost per sample on the M33, in place of a float conversion and divide:
+ * FIR about n_taps / 2 cycles, a biquad stage about 8, RMS, DC removal and
+ * scaling 2 to 4.
+ */
+
+#include <string.h>
+
+#include "accel_dsp.h"
+
+#if defined(__ARM_FEATURE_DSP) && defined(__ARM_FEATURE_SIMD32)
+#include <arm_acle.h>
+#define ACCEL_DSP_SIMD 1
+#endif
+
+/*============================================================================
+ * Primitives
+ *===========================================================================*/
+
+/* Two Q15 values as one word, the first in the low half */
+static inline uint32_t q15x2_read(const int16_t *p) {
+  uint32_t v;
+
+  memcpy(&v, p, sizeof(v)); /* A single LDR; the M33 allows unaligned */
+  return v;
+}
+
+/* The compiler makes this one PKHBT */
+static inline uint32_t q15x2_pack(int16_t lo, int16_t hi) {
+  return (uint16_t)lo | ((uint32_t)(uint16_t)hi << 16);
+}
+
+/* acc + lo(a) * lo(b) + hi(a) * hi(b), 64-bit */
+static inline int64_t smlald(uint32_t a, uint32_t b, int64_t acc) {
+#if defined(ACCEL_DSP_SIMD)
+  return __smlald((int16x2_t)a, (int16x2_t)b, acc);
+#else
+  return acc + (int64_t)((int32_t)(int16_t)a * (int16_t)b) +
+         (int32_t)(int16_t)(a >> 16) * (int16_t)(b >> 16);
+#endif
+}
+
+/* Arithmetic shift by -16..31, left when negative */
+static inline int64_t shift_right(int64_t v, int s) {
+  return (s >= 0) ? (v >> s) : (int64_t)((uint64_t)v << -s);
+}
+
+static inline int16_t sat_q15(int64_t v) {
+  if (v > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (v < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)v;
+}
+
+static inline int32_t sat_q31(int64_t v) {
+  if (v > INT32_MAX) {
+    return INT32_MAX;
+  }
+  if (v < INT32_MIN) {
+    return INT32_MIN;
+  }
+  return (int32_t)v;
+}
+
+/* Sum of squares of n samples */
+static uint64_t energy(const int16_t *x, size_t n) {
+  int64_t acc = 0;
+  size_t k = 0;
+
+  for (; k + 1 < n; k += 2) {
+    uint32_t v = q15x2_read(&x[k]);
+
+    acc = smlald(v, v, acc);
+  }
+  if (k < n) {
+    acc += (int32_t)x[k] * x[k];
+  }
+  return (uint64_t)acc;
+}
+
+static uint32_t isqrt64(uint64_t v) {
+  uint64_t root = 0;
+  uint64_t bit = 1ULL << 62;
+
+  while (bit > v) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+/*============================================================================
+ * Biquad Cascade
+ *===========================================================================*/
+
+void accel_dsp_biquad_init(struct accel_dsp_biquad *f, uint8_t stages,
+                           const int16_t *coeffs, int16_t *state) {
+  f->coeffs = coeffs;
+  f->state = state;
+  f->stages = stages;
+  memset(state, 0, stages * ACCEL_DSP_BIQUAD_STATE * sizeof(*state));
+}
+
+void accel_dsp_biquad_q15(struct accel_dsp_biquad *f, const int16_t *in,
+                          int16_t *out, size_t n) {
+  const int16_t *src = in;
+
+  for (uint8_t s = 0; s < f->stages; s++) {
+    const int16_t *c = &f->coeffs[s * ACCEL_DSP_BIQUAD_COEFFS];
+    int16_t *st = &f->state[s * ACCEL_DSP_BIQUAD_STATE];
+    uint32_t b0_b1 = q15x2_read(&c[0]);
+    uint32_t b2_a1 = q15x2_read(&c[2]);
+    int16_t a2 = c[4];
+    int16_t x1 = st[0], x2 = st[1], y1 = st[2], y2 = st[3];
+
+    for (size_t i = 0; i < n; i++) {
+      int16_t x0 = src[i];
+      int64_t acc = 1 << 13; /* Round to nearest */
+
+      acc = smlald(b0_b1, q15x2_pack(x0, x1), acc);
+      acc = smlald(b2_a1, q15x2_pack(x2, y1), acc);
+      acc += (int32_t)a2 * y2;
+
+      int16_t y0 = sat_q15(acc >> 14);
+
+      x2 = x1;
+      x1 = x0;
+      y2 = y1;
+      y1 = y0;
+      out[i] = y0;
+    }
+
+    st[0] = x1;
+    st[1] = x2;
+    st[2] = y1;
+    st[3] = y2;
+    src = out; /* Later stages run in place */
+  }
+
+  if (f->stages == 0 && out != in) {
+    memmove(out, in, n * sizeof(*out));
+  }
+}
+
+/*============================================================================
+ * FIR
+ *===========================================================================*/
+
+void accel_dsp_fir_init(struct accel_dsp_fir *f, uint16_t n_taps,
+                        const int16_t *taps, int16_t *state,
+                        uint16_t block_max) {
+  f->taps = taps;
+  f->state = state;
+  f->n_taps = n_taps;
+  f->block_max = block_max;
+  memset(state, 0, (n_taps - 1U + block_max) * sizeof(*state));
+}
+
+void accel_dsp_fir_q15(struct accel_dsp_fir *f, const int16_t *in,
+                       int16_t *out, size_t n) {
+  const int16_t *h = f->taps;
+  int16_t *hist = f->state; /* n_taps - 1 past samples, then this block */
+  size_t past = f->n_taps - 1U;
+
+  if (n > f->block_max) {
+    n = f->block_max;
+  }
+  memcpy(&hist[past], in, n * sizeof(*hist));
+
+  for (size_t i = 0; i < n; i++) {
+    const int16_t *x = &hist[i]; /* Oldest sample the output sees */
+    int64_t acc = 1 << 14;       /* Round to nearest */
+    size_t k = 0;
+
+    for (; k + 1 < f->n_taps; k += 2) {
+      acc = smlald(q15x2_read(&h[k]), q15x2_read(&x[k]), acc);
+    }
+    if (k < f->n_taps) {
+      acc += (int32_t)h[k] * x[k];
+    }
+    out[i] = sat_q15(acc >> 15);
+  }
+
+  memmove(hist, &hist[n], past * sizeof(*hist));
+}
+
+/*============================================================================
+ * Moving RMS
+ *===========================================================================*/
+
+void accel_dsp_rms_init(struct accel_dsp_rms *r, int16_t *window,
+                        uint16_t len) {
+  r->window = window;
+  r->len = len;
+  r->pos = 0;
+  r->energy = 0;
+  memset(window, 0, len * sizeof(*window));
+}
+
+int16_t accel_dsp_rms_q15(struct accel_dsp_rms *r, const int16_t *in,
+                          size_t n) {
+  if (r->len == 0) {
+    return 0;
+  }
+
+  while (n > 0) {
+    /* Up to the end of the window, so both sides stay contiguous */
+    size_t chunk = r->len - r->pos;
+
+    if (chunk > n) {
+      chunk = n;
+    }
+    r->energy -= energy(&r->window[r->pos], chunk);
+    r->energy += energy(in, chunk);
+    memcpy(&r->window[r->pos], in, chunk * sizeof(*in));
+
+    /* chunk <= len - pos, so the sum fits the uint16_t */
+    r->pos = (r->pos + chunk == r->len) ? 0 : (uint16_t)(r->pos + chunk);
+    in += chunk;
+    n -= chunk;
+  }
+
+  uint32_t rms = isqrt64(r->energy / r->len);
+
+  return (int16_t)(rms > INT16_MAX ? INT16_MAX : rms);
+}
+
+/*============================================================================
+ * DC Removal
+ *===========================================================================*/
+
+void accel_dsp_dc_init(struct accel_dsp_dc *d, int16_t pole_q15) {
+  d->pole = pole_q15;
+  d->x1 = 0;
+  d->y1 = 0;
+}
+
+void accel_dsp_dc_q15(struct accel_dsp_dc *d, const int16_t *in, int16_t *out,
+                      size_t n) {
+  int16_t x1 = d->x1;
+  int32_t y1 = d->y1;
+
+  for (size_t i = 0; i < n; i++) {
+    int16_t x0 = in[i];
+    /* Q31: the difference gains 16 bits, the pole product drops 15 */
+    int64_t acc = ((int64_t)(x0 - x1) << 16) + (((int64_t)d->pole * y1) >> 15);
+
+    y1 = sat_q31(acc);
+    x1 = x0;
+    out[i] = sat_q15(((int64_t)y1 + (1 << 15)) >> 16);
+  }
+
+  d->x1 = x1;
+  d->y1 = y1;
+}
+
+/*============================================================================
+ * Scaling
+ *===========================================================================*/
+
+void accel_dsp_scale_q15(const int16_t *in, int16_t *out, size_t n,
+                         int16_t scale, int8_t shift) {
+  int s = 15 - shift;
+
+  /* 16 x 16 products: one SMULBB each, no pairing needed */
+  for (size_t i = 0; i < n; i++) {
+    out[i] = sat_q15(shift_right((int32_t)in[i] * scale, s));
+  }
+}
+
+void accel_dsp_scale_q31(const int16_t *in, int32_t *out, size_t n,
+                         int32_t scale, int8_t shift) {
+  int s = 15 - shift;
+
+  for (size_t i = 0; i < n; i++) {
+    out[i] = sat_q31(shift_right((int64_t)in[i] * scale, s));
+  }
+}
@@ -0,0 +1,192 @@
+/**
+ * @file accel_dsp.h
+ * @brief Fixed-point block DSP kernels for the sample path
+ *
+ * Q15 data in and out: raw MPU6050 counts are already Q15 of full scale, so
+ * samples go through without a float conversion. Coefficients are Q15 (Q14
+ * for the biquads, whose feedback terms reach 2), products are summed in 64
+ * bits and results saturate. On cores with the DSP extension (the M33 here)
+ * the multiply-accumulate loops take two samples per SMLALD; anywhere else,
+ * including a host build of accel_dsp.c on its own, the same arithmetic runs
+ * in plain C with bit-identical results. tests/accel_dsp checks both against
+ * a straightforward reference.
+ *
+ * Kernels work on blocks of any length; 24-64 samples amortise the call and
+ * the state load/store. Nothing is allocated: state and history buffers are
+ * the caller's. In-place operation (out == in) is allowed throughout.
+ */
+
+#ifndef ACCEL_DSP_H_
+#define ACCEL_DSP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ * Biquad Cascade (direct form I)
+ *===========================================================================*/
+
+/* Per stage: b0, b1, b2, -a1, -a2 in Q14, then a 0 pad to whole pairs */
+#define ACCEL_DSP_BIQUAD_COEFFS 6
+/* Per stage: x[n-1], x[n-2], y[n-1], y[n-2] */
+#define ACCEL_DSP_BIQUAD_STATE 4
+
+struct accel_dsp_biquad {
+  const int16_t *coeffs; /* ACCEL_DSP_BIQUAD_COEFFS per stage */
+  int16_t *state;        /* ACCEL_DSP_BIQUAD_STATE per stage */
+  uint8_t stages;
+};
+
+/**
+ * @brief Set up a cascade with cleared state
+ * @param f Filter
+ * @param stages Number of second-order sections
+ * @param coeffs stages * ACCEL_DSP_BIQUAD_COEFFS values, kept by reference
+ * @param state stages * ACCEL_DSP_BIQUAD_STATE values
+ */
+void accel_dsp_biquad_init(struct accel_dsp_biquad *f, uint8_t stages,
+                           const int16_t *coeffs, int16_t *state);
+
+/**
+ * @brief Filter a block through every stage
+ * @param f Filter
+ * @param in Input, Q15
+ * @param out Output, Q15 (may be in)
+ * @param n Samples
+ */
+void accel_dsp_biquad_q15(struct accel_dsp_biquad *f, const int16_t *in,
+                          int16_t *out, size_t n);
+
+/*============================================================================
+ * FIR
+ *===========================================================================*/
+
+struct accel_dsp_fir {
+  const int16_t *taps; /* Q15, time-reversed (same for symmetric taps) */
+  int16_t *state;      /* n_taps - 1 + block_max samples */
+  uint16_t n_taps;
+  uint16_t block_max;
+};
+
+/**
+ * @brief Set up a filter with cleared history
+ * @param f Filter
+ * @param n_taps Number of taps
+ * @param taps n_taps values, kept by reference
+ * @param state n_taps - 1 + block_max values
+ * @param block_max Largest block passed to accel_dsp_fir_q15()
+ */
+void accel_dsp_fir_init(struct accel_dsp_fir *f, uint16_t n_taps,
+                        const int16_t *taps, int16_t *state,
+                        uint16_t block_max);
+
+/**
+ * @brief Filter a block
+ * @param f Filter
+ * @param in Input, Q15
+ * @param out Output, Q15 (may be in)
+ * @param n Samples, at most block_max
+ */
+void accel_dsp_fir_q15(struct accel_dsp_fir *f, const int16_t *in,
+                       int16_t *out, size_t n);
+
+/*============================================================================
+ * Moving RMS
+ *===========================================================================*/
+
+struct accel_dsp_rms {
+  int16_t *window; /* The last len samples, circular */
+  uint16_t len;
+  uint16_t pos;    /* Oldest sample */
+  uint64_t energy; /* Sum of squares over the window */
+};
+
+/**
+ * @brief Set up an RMS over a window of zeros
+ * @param r RMS state
+ * @param window len samples
+ * @param len Window length in samples
+ */
+void accel_dsp_rms_init(struct accel_dsp_rms *r, int16_t *window,
+                        uint16_t len);
+
+/**
+ * @brief Slide the window over a block
+ * @param r RMS state
+ * @param in Input, Q15
+ * @param n Samples
+ * @return RMS of the last len samples, Q15
+ */
+int16_t accel_dsp_rms_q15(struct accel_dsp_rms *r, const int16_t *in,
+                          size_t n);
+
+/*============================================================================
+ * DC Removal
+ *
+ * y[n] = x[n] - x[n-1] + pole * y[n-1]: a zero at DC and a pole just inside
+ * it. The -3 dB corner is about (1 - pole) * fs / (2 * pi), so 0.995 at
+ * 1 kHz takes out gravity and drift below 0.8 Hz. y[n-1] is kept in Q31 so
+ * the feedback does not truncate to a limit cycle.
+ *===========================================================================*/
+
+struct accel_dsp_dc {
+  int16_t pole; /* Q15, below 1 */
+  int16_t x1;
+  int32_t y1; /* Q31 */
+};
+
+/**
+ * @brief Set up a DC blocker with cleared state
+ * @param d Blocker
+ * @param pole_q15 Pole, e.g. 32604 (0.995)
+ */
+void accel_dsp_dc_init(struct accel_dsp_dc *d, int16_t pole_q15);
+
+/**
+ * @brief Remove DC from a block
+ * @param d Blocker
+ * @param in Input, Q15
+ * @param out Output, Q15 (may be in)
+ * @param n Samples
+ */
+void accel_dsp_dc_q15(struct accel_dsp_dc *d, const int16_t *in, int16_t *out,
+                      size_t n);
+
+/*============================================================================
+ * Scaling
+ *
+ * out = in * scale * 2^shift, for unit conversion without floats: counts to
+ * mg at +/-16 g is 1000 / 2048 = 0.488 = 16000 (Q15) with shift 0.
+ *===========================================================================*/
+
+/**
+ * @brief Scale a block, saturating to Q15
+ * @param in Input, Q15
+ * @param out Output, Q15 (may be in)
+ * @param n Samples
+ * @param scale Q15
+ * @param shift Extra gain as a power of 2, -16 to 15
+ */
+void accel_dsp_scale_q15(const int16_t *in, int16_t *out, size_t n,
+                         int16_t scale, int8_t shift);
+
+/**
+ * @brief Scale a block to Q31, keeping the bits the product adds
+ * @param in Input, Q15
+ * @param out Output, Q31
+ * @param n Samples
+ * @param scale Q31
+ * @param shift Extra gain as a power of 2, -16 to 15
+ */
+void accel_dsp_scale_q31(const int16_t *in, int32_t *out, size_t n,
+                         int32_t scale, int8_t shift);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ACCEL_DSP_H_ */
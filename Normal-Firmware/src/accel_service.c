@@ -14,15 +14,18 @@
 /* Service configuration */
 #define SAMPLING_RATE_HZ 1000
 
-/* State variables */
+/* State variables: true while any central is subscribed. Each central's own
+ * CCC is looked up with bt_gatt_is_subscribed(). */
 static bool data_notify_enabled = false;
 static bool timestamp_notify_enabled = false;
-static struct bt_conn *current_conn = NULL;
 
 /* Static data for characteristics */
 static uint16_t sampling_rate = SAMPLING_RATE_HZ;
 static uint32_t current_timestamp = 0;
 
+/* One per connection slot, indexed by bt_conn_index() */
+static struct link_profile link_profiles[CONFIG_BT_MAX_CONN];
+
 static struct sensor_metadata sensor_meta = {
     .sensor_name = "ISRO_Phase2_Accel", .range_g = 16, .unit = "g"};
 
@@ -69,6 +72,16 @@ static ssize_t read_sensor_meta(struct bt_conn *conn,
                            sizeof(sensor_meta));
 }
 
+/* Read callback for link profile characteristic */
+static ssize_t read_link_profile(struct bt_conn *conn,
+                                 const struct bt_gatt_attr *attr, void *buf,
+                                 uint16_t len, uint16_t offset) {
+  const struct link_profile *profile = &link_profiles[bt_conn_index(conn)];
+
+  return bt_gatt_attr_read(conn, attr, buf, len, offset, profile,
+                           sizeof(*profile));
+}
+
 /* GATT Service Definition */
 BT_GATT_SERVICE_DEFINE(
     accel_svc,
@@ -92,7 +105,12 @@ BT_GATT_SERVICE_DEFINE(
 
     /* Sensor Metadata Characteristic (READ only) */
     BT_GATT_CHARACTERISTIC(SENSOR_META_CHAR_UUID, BT_GATT_CHRC_READ,
-                           BT_GATT_PERM_READ, read_sensor_meta, NULL, NULL), );
+                           BT_GATT_PERM_READ, read_sensor_meta, NULL, NULL),
+
+    /* Link Profile Characteristic (READ only) */
+    BT_GATT_CHARACTERISTIC(LINK_PROFILE_CHAR_UUID, BT_GATT_CHRC_READ,
+                           BT_GATT_PERM_READ, read_link_profile, NULL,
+                           NULL), );
 
 int accel_service_init(void) {
   // LOG_INF_SAFE("Accelerometer GATT Service initialized");
@@ -102,48 +120,50 @@ int accel_service_init(void) {
   return 0;
 }
 
-/* Static batch packet to avoid malloc overhead */
-static struct accel_batch_packet tx_batch;
-
-int accel_service_notify_batch(struct bt_conn *conn, const struct accel_sample *samples, size_t count) {
-  if (!data_notify_enabled) {
-    return -ENOTCONN;
+/* Subscription of conn, or of any central if conn is NULL */
+static bool notify_enabled(struct bt_conn *conn,
+                           const struct bt_gatt_attr *attr, bool any) {
+  if (!conn) {
+    return any;
   }
+  return bt_gatt_is_subscribed(conn, attr, BT_GATT_CCC_NOTIFY);
+}
 
-  struct bt_conn *target = conn ? conn : current_conn;
-  if (!target) {
+int accel_service_notify_batch(struct bt_conn *conn,
+                               const struct accel_batch_packet *batch,
+                               bt_gatt_complete_func_t func, void *user_data) {
+  if (!notify_enabled(conn, &accel_svc.attrs[1], data_notify_enabled)) {
     return -ENOTCONN;
   }
 
-  /* Copy data to static buffer */
-  tx_batch.batch_count = count;
-  memcpy(tx_batch.samples, samples, count * sizeof(struct accel_sample));
-  
-  size_t payload_size = 1 + (count * sizeof(struct accel_sample));
-
-  /* Send directly - bt_gatt_notify handles buffering internally */
-  return bt_gatt_notify(target, &accel_svc.attrs[1], &tx_batch, payload_size);
+  /* Notify straight from the caller's packet - the stack copies it once into
+   * the ATT buffer, so no staging copy is needed here */
+  struct bt_gatt_notify_params params = {
+      .attr = &accel_svc.attrs[1],
+      .data = batch,
+      .len = 1 + (batch->batch_count * sizeof(struct accel_sample)),
+      .func = func,
+      .user_data = user_data,
+  };
+
+  return bt_gatt_notify_cb(conn, &params);
 }
 
 int accel_service_notify_timestamp(struct bt_conn *conn, uint32_t uptime_ms) {
-  if (!timestamp_notify_enabled) {
+  if (!notify_enabled(conn, &accel_svc.attrs[4], timestamp_notify_enabled)) {
     return -ENOTCONN;
   }
 
-  struct bt_conn *target = conn ? conn : current_conn;
-  if (!target) {
-    return -ENOTCONN;
-  }
-
-  return bt_gatt_notify(target, &accel_svc.attrs[4], &uptime_ms,
+  return bt_gatt_notify(conn, &accel_svc.attrs[4], &uptime_ms,
                         sizeof(uptime_ms));
 }
 
-bool accel_service_data_notify_enabled(void) { return data_notify_enabled; }
+bool accel_service_data_notify_enabled(struct bt_conn *conn) {
+  return conn && bt_gatt_is_subscribed(conn, &accel_svc.attrs[1],
+                                       BT_GATT_CCC_NOTIFY);
+}
 
-void accel_service_set_conn(struct bt_conn *conn) {
-  if (current_conn) {
-    bt_conn_unref(current_conn);
-  }
-  current_conn = conn ? bt_conn_ref(conn) : NULL;
+void accel_service_set_link_profile(struct bt_conn *conn,
+                                    const struct link_profile *profile) {
+  link_profiles[bt_conn_index(conn)] = *profile;
 }
@@ -2,6 +2,7 @@
 #define ACCEL_SERVICE_H_
 
 #include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
 #include <zephyr/types.h>
 
 #ifdef __cplusplus
@@ -28,11 +29,16 @@ extern "C" {
 #define SENSOR_META_CHAR_UUID_VAL                                              \
   BT_UUID_128_ENCODE(0x12340004, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
 
+/* Link Profile Characteristic UUID: 12340008-... (READ) */
+#define LINK_PROFILE_CHAR_UUID_VAL                                             \
+  BT_UUID_128_ENCODE(0x12340008, 0x1234, 0x5678, 0x9ABC, 0xDEF012345678)
+
 #define ACCEL_SERVICE_UUID BT_UUID_DECLARE_128(ACCEL_SERVICE_UUID_VAL)
 #define ACCEL_DATA_CHAR_UUID BT_UUID_DECLARE_128(ACCEL_DATA_CHAR_UUID_VAL)
 #define TIMESTAMP_CHAR_UUID BT_UUID_DECLARE_128(TIMESTAMP_CHAR_UUID_VAL)
 #define SAMPLE_RATE_CHAR_UUID BT_UUID_DECLARE_128(SAMPLE_RATE_CHAR_UUID_VAL)
 #define SENSOR_META_CHAR_UUID BT_UUID_DECLARE_128(SENSOR_META_CHAR_UUID_VAL)
+#define LINK_PROFILE_CHAR_UUID BT_UUID_DECLARE_128(LINK_PROFILE_CHAR_UUID_VAL)
 
 /* Single acceleration sample (14 bytes) */
 struct accel_sample {
@@ -65,6 +71,20 @@ struct sensor_metadata {
   char unit[8];
 } __packed;
 
+/* Negotiated link parameters, little-endian as read by the central (19 bytes) */
+struct link_profile {
+  uint8_t tx_phy;          /* BT_GAP_LE_PHY_* */
+  uint8_t rx_phy;          /* BT_GAP_LE_PHY_* */
+  uint16_t tx_max_len;     /* LL payload octets (27-251) */
+  uint16_t rx_max_len;     /* LL payload octets (27-251) */
+  uint16_t tx_max_time_us; /* LL TX time per packet */
+  uint16_t interval;       /* 1.25 ms units */
+  uint16_t latency;        /* Connection events */
+  uint16_t timeout;        /* 10 ms units */
+  uint16_t att_mtu;        /* Negotiated ATT MTU */
+  uint8_t param_set;       /* Granted fallback set, 0xFF = none */
+} __packed;
+
 /**
  * @brief Initialize the Accelerometer GATT Service
  * @return 0 on success, negative errno on failure
@@ -73,14 +93,19 @@ int accel_service_init(void);
 
 /**
  * @brief Send batched acceleration data notification
- * @param conn Connection object (NULL for all connections)
- * @param samples Array of acceleration samples
- * @param count Number of samples in the batch (1 to ACCEL_BATCH_SIZE)
- * @return 0 on success, negative errno on failure
+ *
+ * The batch is sent as-is (no staging copy), so the caller can fill
+ * batch->samples in place. Only the first batch_count samples go on air.
+ * @param conn Connection object (NULL for all subscribed connections)
+ * @param batch Packet with batch_count set (1 to ACCEL_BATCH_SIZE)
+ * @param func Called once the notification left the stack, or NULL
+ * @param user_data Passed to func
+ * @return 0 on success, -ENOTCONN if not subscribed, negative errno on
+ *         failure
  */
 int accel_service_notify_batch(struct bt_conn *conn,
-                               const struct accel_sample *samples,
-                               size_t count);
+                               const struct accel_batch_packet *batch,
+                               bt_gatt_complete_func_t func, void *user_data);
 
 /**
  * @brief Send timestamp notification
@@ -91,16 +116,21 @@ int accel_service_notify_batch(struct bt_conn *conn,
 int accel_service_notify_timestamp(struct bt_conn *conn, uint32_t uptime_ms);
 
 /**
- * @brief Check if notifications are enabled for acceleration data
- * @return true if enabled, false otherwise
+ * @brief Check if a central enabled notifications for acceleration data
+ * @param conn Connection to check
+ * @return true if enabled, false otherwise (or if conn is NULL)
  */
-bool accel_service_data_notify_enabled(void);
+bool accel_service_data_notify_enabled(struct bt_conn *conn);
 
 /**
- * @brief Set the current connection reference
- * @param conn Connection object
+ * @brief Publish the negotiated link profile of one connection
+ *
+ * Each central reads the profile of its own link.
+ * @param conn Connection the profile belongs to
+ * @param profile Current link parameters (copied)
  */
-void accel_service_set_conn(struct bt_conn *conn);
+void accel_service_set_link_profile(struct bt_conn *conn,
+                                    const struct link_profile *profile);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,349 @@
+/**
+ * @file conn_tune.c
+ * @brief Link-layer throughput negotiation after connect
+ *
+ * Sequence, from the system workqueue shortly after each connect:
+ *
+ *   MTU exchange -> DLE (251 B / 2120 µs) -> 2M PHY -> param set 0
+ *
+ * The MTU, DLE and PHY procedures are one-shot: whatever the central agrees
+ * to is what the link runs with. Peripherals only get to ask for connection
+ * parameters, and a central that rejects the request stays silent, so each
+ * set has CONN_TUNE_PARAM_TIMEOUT_MS to show up in le_param_updated before
+ * the next, more relaxed, one is requested.
+ */
+
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/kernel.h>
+#if defined(CONFIG_BT_LL_SOFTDEVICE_HEADERS_INCLUDE)
+#include <bluetooth/hci_vs_sdc.h>
+#endif
+
+#include "accel_service.h"
+#include "conn_tune.h"
+
+/* Conditional logging - disabled in release builds */
+#if defined(CONFIG_LOG)
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(conn_tune, LOG_LEVEL_INF);
+#define LOG_INF_SAFE(...) LOG_INF(__VA_ARGS__)
+#define LOG_WRN_SAFE(...) LOG_WRN(__VA_ARGS__)
+#else
+#define LOG_INF_SAFE(...) do {} while(0)
+#define LOG_WRN_SAFE(...) do {} while(0)
+#endif
+
+/*============================================================================
+ * Configuration
+ *===========================================================================*/
+
+#define PARAM_SET_NONE 0xFF
+#define ATT_DEFAULT_MTU 23
+
+/* Preferred first; 1.25 ms interval units, 10 ms timeout units */
+static const struct bt_le_conn_param param_sets[] = {
+    BT_LE_CONN_PARAM_INIT(6, 12, 0, 400),  /* 7.5-15 ms */
+    BT_LE_CONN_PARAM_INIT(12, 24, 0, 400), /* 15-30 ms */
+    BT_LE_CONN_PARAM_INIT(24, 40, 0, 400), /* 30-50 ms */
+};
+
+/*============================================================================
+ * State Variables
+ *
+ * One tuning state per connection slot, indexed by bt_conn_index(), so each
+ * central negotiates and falls back on its own.
+ *===========================================================================*/
+
+struct tune_state {
+  struct bt_conn *conn; /* NULL if the slot is free */
+  uint8_t param_idx;
+  struct link_profile profile;
+  struct bt_gatt_exchange_params mtu_params;
+  struct k_work_delayable tune_work;
+  struct k_work_delayable param_check_work;
+};
+
+static struct tune_state tunes[CONFIG_BT_MAX_CONN];
+static conn_tune_mtu_cb_t mtu_handler = NULL;
+
+/*============================================================================
+ * Helpers
+ *===========================================================================*/
+
+/* Tuning state of conn, or NULL if it is not being tuned */
+static struct tune_state *tune_get(struct bt_conn *conn) {
+  struct tune_state *t = &tunes[bt_conn_index(conn)];
+
+  return t->conn == conn ? t : NULL;
+}
+
+static void profile_reset(struct tune_state *t) {
+  t->profile = (struct link_profile){
+      .tx_phy = BT_GAP_LE_PHY_1M,
+      .rx_phy = BT_GAP_LE_PHY_1M,
+      .tx_max_len = 27,
+      .rx_max_len = 27,
+      .tx_max_time_us = 328,
+      .att_mtu = ATT_DEFAULT_MTU,
+      .param_set = PARAM_SET_NONE,
+  };
+}
+
+static void profile_publish(struct tune_state *t) {
+  accel_service_set_link_profile(t->conn, &t->profile);
+}
+
+static void param_request(struct tune_state *t) {
+  const struct bt_le_conn_param *p = &param_sets[t->param_idx];
+  int err;
+
+  LOG_INF_SAFE("Requesting param set %u (interval %u-%u)", t->param_idx,
+          p->interval_min, p->interval_max);
+
+  err = bt_conn_le_param_update(t->conn, p);
+  if (err) {
+    LOG_WRN_SAFE("Param set %u request failed (err %d)", t->param_idx, err);
+  }
+
+  /* Rejections are silent: check back later either way */
+  k_work_reschedule(&t->param_check_work, K_MSEC(CONN_TUNE_PARAM_TIMEOUT_MS));
+}
+
+/*============================================================================
+ * Work Handlers
+ *===========================================================================*/
+
+static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err,
+                            struct bt_gatt_exchange_params *params) {
+  struct tune_state *t = CONTAINER_OF(params, struct tune_state, mtu_params);
+
+  if (err) {
+    LOG_WRN_SAFE("MTU exchange failed (err %u)", err);
+  }
+
+  if (t->conn != conn) {
+    return; /* Disconnected meanwhile */
+  }
+
+  t->profile.att_mtu = bt_gatt_get_mtu(conn);
+  profile_publish(t);
+
+  if (mtu_handler) {
+    mtu_handler(conn, t->profile.att_mtu);
+  }
+}
+
+static void tune_work_fn(struct k_work *work) {
+  struct tune_state *t = CONTAINER_OF(k_work_delayable_from_work(work),
+                                      struct tune_state, tune_work);
+  int err;
+
+  if (!t->conn) {
+    return;
+  }
+
+  t->mtu_params.func = mtu_exchange_cb;
+  err = bt_gatt_exchange_mtu(t->conn, &t->mtu_params);
+  if (err) {
+    LOG_WRN_SAFE("MTU exchange request failed (err %d)", err);
+  }
+
+#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
+  err = bt_conn_le_data_len_update(t->conn, BT_LE_DATA_LEN_PARAM_MAX);
+  if (err) {
+    LOG_WRN_SAFE("DLE request failed (err %d)", err);
+  }
+#endif
+
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+  err = bt_conn_le_phy_update(t->conn, BT_CONN_LE_PHY_PARAM_2M);
+  if (err) {
+    LOG_WRN_SAFE("2M PHY request failed (err %d)", err);
+  }
+#endif
+
+  t->param_idx = 0;
+  param_request(t);
+}
+
+static void param_check_fn(struct k_work *work) {
+  struct tune_state *t = CONTAINER_OF(k_work_delayable_from_work(work),
+                                      struct tune_state, param_check_work);
+
+  if (!t->conn || t->profile.param_set != PARAM_SET_NONE) {
+    return;
+  }
+
+  if (t->param_idx + 1 >= ARRAY_SIZE(param_sets)) {
+    LOG_WRN_SAFE("Central granted no parameter set, keeping interval %u",
+            t->profile.interval);
+    return;
+  }
+
+  t->param_idx++;
+  param_request(t);
+}
+
+/*============================================================================
+ * Connection Callbacks
+ *===========================================================================*/
+
+static void tune_connected(struct bt_conn *conn, uint8_t err) {
+  struct tune_state *t = &tunes[bt_conn_index(conn)];
+  struct bt_conn_info info;
+
+  if (err || t->conn) {
+    return;
+  }
+
+  t->conn = bt_conn_ref(conn);
+  profile_reset(t);
+  if (bt_conn_get_info(conn, &info) == 0) {
+    t->profile.interval = info.le.interval;
+    t->profile.latency = info.le.latency;
+    t->profile.timeout = info.le.timeout;
+  }
+  profile_publish(t);
+
+  /* Out of the connected callback: the procedures issue HCI commands */
+  k_work_reschedule(&t->tune_work, K_MSEC(50));
+}
+
+static void tune_disconnected(struct bt_conn *conn, uint8_t reason) {
+  ARG_UNUSED(reason);
+
+  struct tune_state *t = tune_get(conn);
+
+  if (!t) {
+    return;
+  }
+
+  k_work_cancel_delayable(&t->tune_work);
+  k_work_cancel_delayable(&t->param_check_work);
+  profile_reset(t);
+  profile_publish(t);
+  bt_conn_unref(t->conn);
+  t->conn = NULL;
+}
+
+static void tune_param_updated(struct bt_conn *conn, uint16_t interval,
+                               uint16_t latency, uint16_t timeout) {
+  struct tune_state *t = tune_get(conn);
+
+  if (!t) {
+    return;
+  }
+
+  t->profile.interval = interval;
+  t->profile.latency = latency;
+  t->profile.timeout = timeout;
+
+  /* Granted if it falls in the range of the set being tried */
+  const struct bt_le_conn_param *p = &param_sets[t->param_idx];
+
+  if (interval >= p->interval_min && interval <= p->interval_max) {
+    t->profile.param_set = t->param_idx;
+    k_work_cancel_delayable(&t->param_check_work);
+    LOG_INF_SAFE("Param set %u granted (interval %u)", t->param_idx, interval);
+  }
+  profile_publish(t);
+}
+
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+static void tune_phy_updated(struct bt_conn *conn,
+                             struct bt_conn_le_phy_info *param) {
+  struct tune_state *t = tune_get(conn);
+
+  if (!t) {
+    return;
+  }
+
+  LOG_INF_SAFE("PHY tx %u rx %u", param->tx_phy, param->rx_phy);
+  t->profile.tx_phy = param->tx_phy;
+  t->profile.rx_phy = param->rx_phy;
+  profile_publish(t);
+}
+#endif
+
+#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
+static void tune_data_len_updated(struct bt_conn *conn,
+                                  struct bt_conn_le_data_len_info *info) {
+  struct tune_state *t = tune_get(conn);
+
+  if (!t) {
+    return;
+  }
+
+  LOG_INF_SAFE("Data length tx %u B / %u us, rx %u B", info->tx_max_len,
+          info->tx_max_time, info->rx_max_len);
+  t->profile.tx_max_len = info->tx_max_len;
+  t->profile.tx_max_time_us = info->tx_max_time;
+  t->profile.rx_max_len = info->rx_max_len;
+  profile_publish(t);
+}
+#endif
+
+BT_CONN_CB_DEFINE(conn_tune_callbacks) = {
+    .connected = tune_connected,
+    .disconnected = tune_disconnected,
+    .le_param_updated = tune_param_updated,
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+    .le_phy_updated = tune_phy_updated,
+#endif
+#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
+    .le_data_len_updated = tune_data_len_updated,
+#endif
+};
+
+/*============================================================================
+ * Controller Setup
+ *===========================================================================*/
+
+#if defined(CONFIG_BT_LL_SOFTDEVICE_HEADERS_INCLUDE)
+/* SoftDevice Controller vendor commands, sent over HCI to the network core */
+static int controller_event_len_set(void) {
+  const sdc_hci_cmd_vs_event_length_set_t len = {
+      .event_length_us = CONN_TUNE_EVENT_LEN_US,
+  };
+  /* Let events run past the reserved length while there is data to send */
+  const sdc_hci_cmd_vs_conn_event_extend_t ext = {
+      .enable = 1,
+  };
+  int err;
+
+  err = hci_vs_sdc_event_length_set(&len);
+  if (err) {
+    return err;
+  }
+  return hci_vs_sdc_conn_event_extend(&ext);
+}
+#else
+static int controller_event_len_set(void) { return -ENOTSUP; }
+#endif
+
+/*============================================================================
+ * API Implementation
+ *===========================================================================*/
+
+int conn_tune_init(conn_tune_mtu_cb_t mtu_cb) {
+  int err;
+
+  mtu_handler = mtu_cb;
+  for (size_t i = 0; i < ARRAY_SIZE(tunes); i++) {
+    k_work_init_delayable(&tunes[i].tune_work, tune_work_fn);
+    k_work_init_delayable(&tunes[i].param_check_work, param_check_fn);
+  }
+
+  /* Applies to connections established from now on */
+  err = controller_event_len_set();
+  if (err) {
+    LOG_WRN_SAFE("Connection event length not set (err %d)", err);
+    return err;
+  }
+
+  LOG_INF_SAFE("Connection event length %u us, extension on",
+          CONN_TUNE_EVENT_LEN_US);
+  return 0;
+}
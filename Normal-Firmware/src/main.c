@@ -6,13 +6,17 @@
 #if defined(CONFIG_SENSOR)
 #include <zephyr/drivers/sensor.h>
 #endif
+#include <zephyr/drivers/i2c.h>
 #include <zephyr/kernel.h>
+#include <zephyr/rtio/rtio.h>
 #include <zephyr/settings/settings.h>
 #include <zephyr/pm/pm.h>
 #include <zephyr/pm/device.h>
 #include <zephyr/pm/device_runtime.h>
+#include <zephyr/sys/byteorder.h>
 
 #include "accel_service.h"
+#include "conn_tune.h"
 
 /* Conditional logging - disabled in release builds */
 #if defined(CONFIG_LOG)
@@ -41,20 +45,75 @@ LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 #define LEDS_INIT() 0
 #endif
 
-/* MPU6050 device */
+/* MPU6050 device (driver used for init/config only) */
 static const struct device *mpu;
 
 /* Sensor Parameters */
 #define SAMPLE_FREQ_HZ 1000.0f   /* 1 kHz high-rate sampling */
 #define SAMPLE_PERIOD_US 1000    /* 1 ms between samples */
 #define BATCH_PERIOD_MS 17       /* Send batch every 17 ms (17 samples) */
-#define MPU_LSB_PER_G 2048.0f    /* ±16g range */
+#define MPU6050_ACCEL_XOUT_H 0x3B
+#define MPU6050_ACCEL_CONFIG 0x1C
+#define MPU6050_AFS_SEL_16G 0x18 /* 2048 LSB/g, matches the dashboard */
+
+static const struct i2c_dt_spec mpu_i2c =
+    I2C_DT_SPEC_GET(DT_NODELABEL(mpu6050));
+
+/* Async raw reads: I2C transactions queued on RTIO, never blocking the
+ * sensor thread. Two reads can be in flight; each has its own buffer. */
+I2C_DT_IODEV_DEFINE(mpu_iodev, DT_NODELABEL(mpu6050));
+RTIO_DEFINE(mpu_rtio, 4, 4);
+
+struct mpu_read {
+  uint8_t raw[6];
+  uint32_t timestamp_ms; /* Captured at submission, on the 1 ms grid */
+  bool in_flight;
+};
+
+static uint8_t mpu_accel_reg = MPU6050_ACCEL_XOUT_H;
+static struct mpu_read mpu_reads[2];
 
 /* Statistics timer (only used in debug builds) */
 #if defined(CONFIG_LOG)
 static int64_t last_stats_time = 0;
 #endif
 
+/* Batch ring: each batch is built once, in place, and every subscribed
+ * central is notified from the same slot. A slot is refilled only once all
+ * cursors have passed it; a central lapped by the sensor skips ahead. */
+#define BATCH_RING_SIZE 8 /* ~136 ms at 1 kHz */
+
+static struct accel_batch_packet batch_ring[BATCH_RING_SIZE];
+static uint32_t batch_head = 0; /* Batches completed so far */
+
+/* Notifications each central may have queued in the stack. The TX contexts
+ * are shared by all connections: each gets its own share. */
+#define SUB_TX_DEPTH (CONFIG_BT_CONN_TX_MAX / CONFIG_BT_MAX_CONN)
+
+BUILD_ASSERT(SUB_TX_DEPTH >= 1,
+             "CONFIG_BT_CONN_TX_MAX too small for CONFIG_BT_MAX_CONN");
+
+enum sub_state {
+  SUB_FREE,
+  SUB_JOINING, /* Connected, not yet seen by the sensor thread */
+  SUB_ACTIVE,
+  SUB_LEAVING, /* Disconnected, conn not yet released */
+};
+
+/* One per connection slot, indexed by bt_conn_index() */
+struct subscriber {
+  atomic_t state;       /* enum sub_state */
+  struct bt_conn *conn; /* Referenced unless SUB_FREE */
+  atomic_t in_flight;   /* Notifications queued in the stack */
+  atomic_t gen;         /* Bumped per connection, tags its notifications */
+  uint32_t cursor;      /* Next batch to send, sensor thread only */
+};
+
+static struct subscriber subscribers[CONFIG_BT_MAX_CONN];
+static atomic_t conn_count = ATOMIC_INIT(0);
+
+static void advertising_resume(void);
+
 /* BLE Connection Callbacks */
 static void connected(struct bt_conn *conn, uint8_t err) {
   if (err) {
@@ -62,23 +121,40 @@ static void connected(struct bt_conn *conn, uint8_t err) {
     return;
   }
 
+  struct subscriber *s = &subscribers[bt_conn_index(conn)];
+
   // LOG_INF_SAFE("Connected");
   // Turn off LED for power saving when connected
   LED_OFF(DK_LED1);
 
-  accel_service_set_conn(conn);
+  /* The sensor thread takes it in on its next tick */
+  s->conn = bt_conn_ref(conn);
+  atomic_inc(&s->gen);
+  atomic_set(&s->state, SUB_JOINING);
 
 #if defined(CONFIG_LOG)
-  /* Reset stats timer on new connection */
-  last_stats_time = k_uptime_get();
+  /* Reset stats timer on the first connection */
+  if (atomic_get(&conn_count) == 0) {
+    last_stats_time = k_uptime_get();
+  }
 #endif
+  atomic_inc(&conn_count);
+
+  /* Connectable advertising stops on each connection */
+  advertising_resume();
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason) {
   // LOG_INF_SAFE("Disconnected (reason %u)", reason);
   LED_OFF(DK_LED1);
 
-  accel_service_set_conn(NULL);
+  atomic_dec(&conn_count);
+  atomic_set(&subscribers[bt_conn_index(conn)].state, SUB_LEAVING);
+}
+
+/* The stack freed a connection object: a slot is free to advertise for */
+static void recycled(void) {
+  advertising_resume();
 }
 
 static void le_param_updated(struct bt_conn *conn, uint16_t interval,
@@ -90,9 +166,110 @@ static void le_param_updated(struct bt_conn *conn, uint16_t interval,
 BT_CONN_CB_DEFINE(conn_callbacks) = {
     .connected = connected,
     .disconnected = disconnected,
+    .recycled = recycled,
     .le_param_updated = le_param_updated,
 };
 
+/* BT stack context: a batch left the stack (or was dropped). user_data is
+ * the generation of the connection it was sent on: the connection object,
+ * and so the pointer, is reused by the next central in the slot. */
+static void batch_sent(struct bt_conn *conn, void *user_data) {
+  struct subscriber *s = &subscribers[bt_conn_index(conn)];
+
+  /* Late completions of an earlier connection: its count was reset */
+  if (POINTER_TO_UINT(user_data) == (unsigned int)atomic_get(&s->gen)) {
+    atomic_dec(&s->in_flight);
+  }
+}
+
+/* Send each central the batches it has not had yet, as far as its credits
+ * go. Sensor thread, every tick: a slow central simply catches up later. */
+static void subscribers_pump(void) {
+  for (size_t i = 0; i < ARRAY_SIZE(subscribers); i++) {
+    struct subscriber *s = &subscribers[i];
+
+    switch (atomic_get(&s->state)) {
+    case SUB_JOINING:
+      atomic_set(&s->in_flight, 0);
+      s->cursor = batch_head;
+      /* Fails if it already left again: released on the next tick */
+      atomic_cas(&s->state, SUB_JOINING, SUB_ACTIVE);
+      continue;
+    case SUB_LEAVING:
+      bt_conn_unref(s->conn);
+      s->conn = NULL;
+      atomic_set(&s->state, SUB_FREE);
+      continue;
+    case SUB_ACTIVE:
+      break;
+    default:
+      continue;
+    }
+
+    /* Starts with fresh data once it subscribes */
+    if (!accel_service_data_notify_enabled(s->conn)) {
+      s->cursor = batch_head;
+      continue;
+    }
+
+    /* The slot being filled is the one BATCH_RING_SIZE behind the head */
+    if (batch_head - s->cursor > BATCH_RING_SIZE - 1) {
+#if defined(CONFIG_LOG)
+      buffer_overflows += batch_head - s->cursor - (BATCH_RING_SIZE - 1);
+#endif
+      s->cursor = batch_head - (BATCH_RING_SIZE - 1);
+    }
+
+    while (s->cursor != batch_head &&
+           atomic_get(&s->in_flight) < SUB_TX_DEPTH) {
+      atomic_inc(&s->in_flight);
+
+      int err = accel_service_notify_batch(
+          s->conn, &batch_ring[s->cursor % BATCH_RING_SIZE], batch_sent,
+          UINT_TO_POINTER((unsigned int)atomic_get(&s->gen)));
+
+      if (err) {
+        atomic_dec(&s->in_flight);
+        if (err == -ENOMEM || err == -EAGAIN) {
+          break; /* Stack buffers busy: retry on the next tick */
+        }
+#if defined(CONFIG_LOG)
+        if (err != -ENOTCONN) {
+          batches_dropped++;
+        }
+#endif
+      } else {
+#if defined(CONFIG_LOG)
+        batches_sent++;
+#endif
+      }
+      s->cursor++;
+    }
+  }
+}
+
+/* Queue one register-address write + 6-byte read transaction */
+static int mpu_read_submit(struct mpu_read *rd) {
+  struct rtio_sqe *wr_sqe = rtio_sqe_acquire(&mpu_rtio);
+  struct rtio_sqe *rd_sqe = rtio_sqe_acquire(&mpu_rtio);
+
+  if (!wr_sqe || !rd_sqe) {
+    rtio_sqe_drop_all(&mpu_rtio);
+    return -ENOMEM;
+  }
+
+  rtio_sqe_prep_tiny_write(wr_sqe, &mpu_iodev, RTIO_PRIO_NORM, &mpu_accel_reg,
+                           1, NULL);
+  wr_sqe->flags |= RTIO_SQE_TRANSACTION | RTIO_SQE_NO_RESPONSE;
+
+  rtio_sqe_prep_read(rd_sqe, &mpu_iodev, RTIO_PRIO_NORM, rd->raw,
+                     sizeof(rd->raw), rd);
+  rd_sqe->iodev_flags |= RTIO_IODEV_I2C_RESTART | RTIO_IODEV_I2C_STOP;
+
+  rd->in_flight = true;
+  return rtio_submit(&mpu_rtio, 0);
+}
+
 /* MPU6050 Sensor Thread with 1 kHz Sampling */
 static void sensor_thread_fn(void *p1, void *p2, void *p3) {
   ARG_UNUSED(p1);
@@ -100,11 +277,11 @@ static void sensor_thread_fn(void *p1, void *p2, void *p3) {
   ARG_UNUSED(p3);
 
   uint32_t sample_counter = 0;
-  struct sensor_value accel[3];
+  uint8_t read_slot = 0;
 
-  /* Sample buffer for batching (17 samples = 17ms at 1kHz) */
-  static struct accel_sample buffer[ACCEL_BATCH_SIZE];
-  uint8_t buffer_idx = 0;
+  /* Samples are written straight into the notification payload, in the
+   * batch ring (17 samples = 17ms at 1kHz) */
+  struct accel_batch_packet *batch = &batch_ring[0];
 
   /* Timing variables for precise 1 kHz */
   int64_t next_sample_time = k_uptime_get();
@@ -119,59 +296,58 @@ static void sensor_thread_fn(void *p1, void *p2, void *p3) {
       k_sleep(K_TIMEOUT_ABS_MS(next_sample_time));
     }
 
-    /* Fetch sensor data */
-    int ret = sensor_sample_fetch(mpu);
-    if (ret < 0) {
-      LOG_WRN_SAFE("Sensor fetch failed: %d", ret);
-      continue;
+    /* Queue this tick's read - completes in the background */
+    struct mpu_read *rd = &mpu_reads[read_slot];
+    if (!rd->in_flight) {
+      rd->timestamp_ms = (uint32_t)next_sample_time;
+      int ret = mpu_read_submit(rd);
+      if (ret < 0) {
+        rd->in_flight = false;
+        LOG_WRN_SAFE("Sensor read submit failed: %d", ret);
+      }
+      read_slot ^= 1;
+    } else {
+      LOG_WRN_SAFE("Sensor read still in flight, skipping tick");
     }
 
-    /* Get tri-axial acceleration */
-    sensor_channel_get(mpu, SENSOR_CHAN_ACCEL_XYZ, accel);
-
-    /* Convert from m/s² to g, then to raw counts */
-    float ax_g = (float)sensor_value_to_double(&accel[0]) / 9.81f;
-    float ay_g = (float)sensor_value_to_double(&accel[1]) / 9.81f;
-    float az_g = (float)sensor_value_to_double(&accel[2]) / 9.81f;
-
-    int16_t ax_raw = (int16_t)(ax_g * MPU_LSB_PER_G);
-    int16_t ay_raw = (int16_t)(ay_g * MPU_LSB_PER_G);
-    int16_t az_raw = (int16_t)(az_g * MPU_LSB_PER_G);
-
-    sample_counter++;
+    /* Collect finished reads (normally the previous tick's) */
+    struct rtio_cqe *cqe;
+    while ((cqe = rtio_cqe_consume(&mpu_rtio)) != NULL) {
+      struct mpu_read *done = cqe->userdata;
+      int result = cqe->result;
+      rtio_cqe_release(&mpu_rtio, cqe);
 
-    /* Store sample in buffer with individual timestamp */
-    buffer[buffer_idx].sample_counter = sample_counter;
-    buffer[buffer_idx].timestamp_ms = (uint32_t)k_uptime_get();
-    buffer[buffer_idx].accel_x = ax_raw;
-    buffer[buffer_idx].accel_y = ay_raw;
-    buffer[buffer_idx].accel_z = az_raw;
-    buffer_idx++;
+      if (done == NULL) {
+        continue;
+      }
+      done->in_flight = false;
+      if (result < 0) {
+        LOG_WRN_SAFE("Sensor read failed: %d", result);
+        continue;
+      }
 
-    /* When batch is full (17 samples = 17ms at 1kHz), send it */
-    if (buffer_idx >= ACCEL_BATCH_SIZE) {
-      if (accel_service_data_notify_enabled()) {
-        int err = accel_service_notify_batch(NULL, buffer, ACCEL_BATCH_SIZE);
-#if defined(CONFIG_LOG)
-        if (err == 0) {
-          batches_sent++;
-        } else if (err == -ENOMEM || err == -EAGAIN) {
-          batches_dropped++;
-        } else if (err != -ENOTCONN) {
-          batches_dropped++;
-        }
-#else
-        (void)err;
-#endif
-      } else {
-#if defined(CONFIG_LOG)
-        /* Not connected - buffer overflow, drop oldest */
-        buffer_overflows++;
-#endif
+      sample_counter++;
+
+      /* Store raw big-endian counts directly - no unit conversion */
+      struct accel_sample *s = &batch->samples[batch->batch_count++];
+      s->sample_counter = sample_counter;
+      s->timestamp_ms = done->timestamp_ms;
+      s->accel_x = (int16_t)sys_get_be16(&done->raw[0]);
+      s->accel_y = (int16_t)sys_get_be16(&done->raw[2]);
+      s->accel_z = (int16_t)sys_get_be16(&done->raw[4]);
+
+      /* When batch is full (17 samples = 17ms at 1kHz), publish it */
+      if (batch->batch_count >= ACCEL_BATCH_SIZE) {
+        batch_head++;
+        batch = &batch_ring[batch_head % BATCH_RING_SIZE];
+        batch->batch_count = 0; /* Reset buffer */
       }
-      buffer_idx = 0; /* Reset buffer */
     }
 
+    /* Every central gets new batches, and retries the ones its link could
+     * not take yet */
+    subscribers_pump();
+
 #if defined(CONFIG_LOG)
     /* Log statistics every 5 seconds (debug only) */
     int64_t stats_now = k_uptime_get();
@@ -214,6 +390,24 @@ static const struct bt_data sd[] = {
     BT_DATA_BYTES(BT_DATA_UUID128_ALL, ACCEL_SERVICE_UUID_VAL),
 };
 
+/* Restart advertising while a connection slot is free. From a work item:
+ * not from within the stack's own callbacks. */
+static void advertising_work_fn(struct k_work *work) {
+  ARG_UNUSED(work);
+
+  int err = bt_le_adv_start(BT_LE_ADV_CONN_CUSTOM, ad, ARRAY_SIZE(ad), sd,
+                            ARRAY_SIZE(sd));
+
+  /* -ENOMEM: every slot is taken, recycled() tries again */
+  if (err && err != -EALREADY && err != -ENOMEM) {
+    LOG_WRN_SAFE("Advertising failed to restart (err %d)", err);
+  }
+}
+
+static K_WORK_DEFINE(advertising_work, advertising_work_fn);
+
+static void advertising_resume(void) { k_work_submit(&advertising_work); }
+
 int main(void) {
   int err;
 
@@ -230,6 +424,14 @@ int main(void) {
   }
   LOG_INF_SAFE("MPU6050 ready");
 
+  /* Raw counts are sent as-is, so pin the range to ±16g ourselves */
+  err = i2c_reg_write_byte_dt(&mpu_i2c, MPU6050_ACCEL_CONFIG,
+                              MPU6050_AFS_SEL_16G);
+  if (err) {
+    LOG_ERR_SAFE("Could not set accel range (err %d)", err);
+    return err;
+  }
+
   /* Set sampling rate to 1000 Hz for high-rate sampling */
   struct sensor_value odr = {.val1 = 1000, .val2 = 0};
   err = sensor_attr_set(mpu, SENSOR_CHAN_ACCEL_XYZ,
@@ -252,6 +454,12 @@ int main(void) {
   }
   LOG_INF_SAFE("Bluetooth initialized");
 
+  /* MTU, DLE, 2M PHY and interval negotiation on every connect */
+  err = conn_tune_init(NULL);
+  if (err) {
+    LOG_WRN_SAFE("Controller event length not tuned (err %d)", err);
+  }
+
   /* Load settings */
   if (IS_ENABLED(CONFIG_SETTINGS)) {
     settings_load();
@@ -0,0 +1,180 @@
+/**
+ * @file accel_dsp_ref.c
+ * @brief Plain-C reference for the accel_dsp kernels
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "accel_dsp_ref.h"
+
+/*============================================================================
+ * Helpers
+ *===========================================================================*/
+
+/* floor(v / 2^s), or v * 2^-s for a negative s */
+static int64_t floor_shift(int64_t v, int s) {
+  if (s < 0) {
+    return v * ((int64_t)1 << -s);
+  }
+
+  int64_t d = (int64_t)1 << s;
+  int64_t q = v / d;
+
+  if (v % d != 0 && v < 0) {
+    q--;
+  }
+  return q;
+}
+
+static int16_t sat16(int64_t v) {
+  return (int16_t)(v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : v);
+}
+
+static int32_t sat32(int64_t v) {
+  return (int32_t)(v > INT32_MAX ? INT32_MAX : v < INT32_MIN ? INT32_MIN : v);
+}
+
+/* floor(sqrt(v)) */
+static uint64_t isqrt(uint64_t v) {
+  uint64_t r = (uint64_t)sqrt((double)v);
+
+  while (r > 0 && r * r > v) {
+    r--;
+  }
+  while ((r + 1) * (r + 1) <= v) {
+    r++;
+  }
+  return r;
+}
+
+/*============================================================================
+ * Biquad Cascade
+ *===========================================================================*/
+
+void ref_biquad_init(struct ref_biquad *f, uint8_t stages,
+                     const int16_t *coeffs) {
+  memset(f, 0, sizeof(*f));
+  f->coeffs = coeffs;
+  f->stages = stages;
+}
+
+void ref_biquad_q15(struct ref_biquad *f, const int16_t *in, int16_t *out,
+                    size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    int16_t v = in[i];
+
+    /* y = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2] */
+    for (uint8_t s = 0; s < f->stages; s++) {
+      const int16_t *c = &f->coeffs[s * 6];
+      int64_t acc = (int64_t)c[0] * v + (int64_t)c[1] * f->x[s][0] +
+                    (int64_t)c[2] * f->x[s][1] + (int64_t)c[3] * f->y[s][0] +
+                    (int64_t)c[4] * f->y[s][1];
+      int16_t y = sat16(floor_shift(acc + (1 << 13), 14));
+
+      f->x[s][1] = f->x[s][0];
+      f->x[s][0] = v;
+      f->y[s][1] = f->y[s][0];
+      f->y[s][0] = y;
+      v = y;
+    }
+    out[i] = v;
+  }
+}
+
+/*============================================================================
+ * FIR
+ *===========================================================================*/
+
+void ref_fir_init(struct ref_fir *f, uint16_t n_taps, const int16_t *taps) {
+  memset(f, 0, sizeof(*f));
+  f->taps = taps;
+  f->n_taps = n_taps;
+}
+
+void ref_fir_q15(struct ref_fir *f, const int16_t *in, int16_t *out,
+                 size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    int64_t acc = 0;
+
+    memmove(&f->delay[1], &f->delay[0],
+            (REF_FIR_MAX_TAPS - 1) * sizeof(f->delay[0]));
+    f->delay[0] = in[i];
+
+    /* Taps are stored time-reversed: the last one weighs the newest input */
+    for (uint16_t j = 0; j < f->n_taps; j++) {
+      acc += (int64_t)f->taps[f->n_taps - 1 - j] * f->delay[j];
+    }
+    out[i] = sat16(floor_shift(acc + (1 << 14), 15));
+  }
+}
+
+/*============================================================================
+ * Moving RMS
+ *===========================================================================*/
+
+void ref_rms_init(struct ref_rms *r, uint16_t len) {
+  memset(r, 0, sizeof(*r));
+  r->len = len;
+}
+
+int16_t ref_rms_q15(struct ref_rms *r, const int16_t *in, size_t n) {
+  uint64_t sum = 0;
+
+  if (r->len == 0) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    memmove(&r->window[0], &r->window[1],
+            (r->len - 1U) * sizeof(r->window[0]));
+    r->window[r->len - 1U] = in[i];
+  }
+  for (uint16_t i = 0; i < r->len; i++) {
+    sum += (uint64_t)((int64_t)r->window[i] * r->window[i]);
+  }
+
+  uint64_t rms = isqrt(sum / r->len);
+
+  return (int16_t)(rms > INT16_MAX ? INT16_MAX : rms);
+}
+
+/*============================================================================
+ * DC Removal
+ *===========================================================================*/
+
+void ref_dc_init(struct ref_dc *d, int16_t pole_q15) {
+  d->pole = pole_q15;
+  d->x1 = 0;
+  d->y1 = 0;
+}
+
+void ref_dc_q15(struct ref_dc *d, const int16_t *in, int16_t *out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    /* y[n] = x[n] - x[n-1] + pole * y[n-1], y in Q31 */
+    int64_t diff = (int64_t)in[i] - d->x1;
+    int64_t fb = floor_shift((int64_t)d->pole * d->y1, 15);
+
+    d->y1 = sat32(diff * 65536 + fb);
+    d->x1 = in[i];
+    out[i] = sat16(floor_shift((int64_t)d->y1 + 32768, 16));
+  }
+}
+
+/*============================================================================
+ * Scaling
+ *===========================================================================*/
+
+void ref_scale_q15(const int16_t *in, int16_t *out, size_t n, int16_t scale,
+                   int8_t shift) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = sat16(floor_shift((int64_t)in[i] * scale, 15 - shift));
+  }
+}
+
+void ref_scale_q31(const int16_t *in, int32_t *out, size_t n, int32_t scale,
+                   int8_t shift) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = sat32(floor_shift((int64_t)in[i] * scale, 15 - shift));
+  }
+}
@@ -0,0 +1,67 @@
+/**
+ * @file accel_dsp_ref.h
+ * @brief Plain-C reference for the accel_dsp kernels
+ *
+ * Each kernel written straight from its equation: one sample and one term
+ * at a time, no paired loads, no circular buffers, and the window energy
+ * summed again on every call. The rounding and saturation rules are the
+ * ones accel_dsp.h documents, so the results must match bit for bit.
+ * Shifts of negative values are written as floor divisions, not relying on
+ * the compiler's arithmetic shift.
+ */
+
+#ifndef ACCEL_DSP_REF_H_
+#define ACCEL_DSP_REF_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define REF_BIQUAD_MAX_STAGES 8
+#define REF_FIR_MAX_TAPS 64
+#define REF_RMS_MAX_LEN 256
+
+struct ref_biquad {
+  const int16_t *coeffs; /* ACCEL_DSP_BIQUAD_COEFFS per stage */
+  uint8_t stages;
+  int16_t x[REF_BIQUAD_MAX_STAGES][2]; /* x[n-1], x[n-2] */
+  int16_t y[REF_BIQUAD_MAX_STAGES][2]; /* y[n-1], y[n-2] */
+};
+
+struct ref_fir {
+  const int16_t *taps; /* Time-reversed, as for accel_dsp_fir */
+  uint16_t n_taps;
+  int16_t delay[REF_FIR_MAX_TAPS]; /* delay[0] is the newest input */
+};
+
+struct ref_rms {
+  uint16_t len;
+  int16_t window[REF_RMS_MAX_LEN]; /* window[0] is the oldest sample */
+};
+
+struct ref_dc {
+  int16_t pole;
+  int16_t x1;
+  int32_t y1;
+};
+
+void ref_biquad_init(struct ref_biquad *f, uint8_t stages,
+                     const int16_t *coeffs);
+void ref_biquad_q15(struct ref_biquad *f, const int16_t *in, int16_t *out,
+                    size_t n);
+
+void ref_fir_init(struct ref_fir *f, uint16_t n_taps, const int16_t *taps);
+void ref_fir_q15(struct ref_fir *f, const int16_t *in, int16_t *out,
+                 size_t n);
+
+void ref_rms_init(struct ref_rms *r, uint16_t len);
+int16_t ref_rms_q15(struct ref_rms *r, const int16_t *in, size_t n);
+
+void ref_dc_init(struct ref_dc *d, int16_t pole_q15);
+void ref_dc_q15(struct ref_dc *d, const int16_t *in, int16_t *out, size_t n);
+
+void ref_scale_q15(const int16_t *in, int16_t *out, size_t n, int16_t scale,
+                   int8_t shift);
+void ref_scale_q31(const int16_t *in, int32_t *out, size_t n, int32_t scale,
+                   int8_t shift);
+
+#endif /* ACCEL_DSP_REF_H_ */
@@ -0,0 +1,289 @@
+/**
+ * @file accel_dsp_test.c
+ * @brief accel_dsp kernels against the plain-C reference
+ *
+ * Every kernel runs side by side with its reference over random blocks of
+ * 24 to 64 samples, with state carried from block to block, and every
+ * output is compared. Blocks mix full-range noise, small signals and runs
+ * at the rails; coefficients and gains include extremes that drive the
+ * outputs into saturation. Some blocks run in place (out == in).
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "accel_dsp.h"
+#include "accel_dsp_ref.h"
+
+#define BLOCK_MIN 24
+#define BLOCK_MAX 64
+#define TRIALS 300
+#define BLOCKS_PER_TRIAL 40
+#define BIQUAD_MAX_STAGES 4
+
+#define ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
+
+static uint32_t rng = 0x2545F491U;
+static uint32_t blocks;
+static uint32_t failures;
+
+/*============================================================================
+ * Helpers
+ *===========================================================================*/
+
+static uint32_t rand_next(void) {
+  uint32_t x = rng; /* xorshift32 */
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  rng = x;
+  return x;
+}
+
+/* lo..hi inclusive */
+static int32_t rand_range(int32_t lo, int32_t hi) {
+  return lo + (int32_t)(rand_next() % (uint32_t)(hi - lo + 1));
+}
+
+static int16_t rand_q15(void) {
+  return (int16_t)(uint16_t)rand_next();
+}
+
+static size_t rand_block_len(void) {
+  return (size_t)rand_range(BLOCK_MIN, BLOCK_MAX);
+}
+
+/* One block of one kind of signal */
+static void fill_block(int16_t *x, size_t n) {
+  uint32_t kind = rand_next() % 4;
+  int16_t level = rand_q15();
+
+  for (size_t i = 0; i < n; i++) {
+    switch (kind) {
+    case 0: /* Full-range noise */
+      x[i] = rand_q15();
+      break;
+    case 1: /* Small signal around a random offset */
+      x[i] = (int16_t)((level / 2) + rand_range(-256, 256));
+      break;
+    case 2: /* Rails */
+      x[i] = (rand_next() & 1) ? INT16_MAX : INT16_MIN;
+      break;
+    default: /* Steps between held levels */
+      if ((rand_next() % 16) == 0) {
+        level = rand_q15();
+      }
+      x[i] = level;
+      break;
+    }
+  }
+}
+
+static void check_q15(const char *kernel, const int16_t *got,
+                      const int16_t *want, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (got[i] != want[i] && failures++ < 10) {
+      fprintf(stderr, "%s: block %" PRIu32 " sample %zu: %d, want %d\n",
+              kernel, blocks, i, got[i], want[i]);
+    }
+  }
+  blocks++;
+}
+
+static void check_q31(const char *kernel, const int32_t *got,
+                      const int32_t *want, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (got[i] != want[i] && failures++ < 10) {
+      fprintf(stderr,
+              "%s: block %" PRIu32 " sample %zu: %" PRId32 ", want %" PRId32
+              "\n",
+              kernel, blocks, i, got[i], want[i]);
+    }
+  }
+  blocks++;
+}
+
+/* Output buffer for the kernel: the input itself every third block */
+static int16_t *out_for(int16_t *in, int16_t *out) {
+  return (rand_next() % 3 == 0) ? in : out;
+}
+
+/*============================================================================
+ * Kernels
+ *===========================================================================*/
+
+static void test_biquad(void) {
+  for (int t = 0; t < TRIALS; t++) {
+    int16_t coeffs[BIQUAD_MAX_STAGES * ACCEL_DSP_BIQUAD_COEFFS];
+    int16_t state[BIQUAD_MAX_STAGES * ACCEL_DSP_BIQUAD_STATE];
+    uint8_t stages = (uint8_t)rand_range(0, BIQUAD_MAX_STAGES);
+    bool wild = (t % 4) == 0; /* Any Q14 values: unstable, saturating */
+    struct accel_dsp_biquad f;
+    struct ref_biquad ref;
+
+    for (size_t i = 0; i < ARRAY_LEN(coeffs); i++) {
+      if (i % ACCEL_DSP_BIQUAD_COEFFS == ACCEL_DSP_BIQUAD_COEFFS - 1) {
+        coeffs[i] = 0; /* Pad */
+      } else {
+        coeffs[i] = wild ? rand_q15() : (int16_t)rand_range(-12000, 12000);
+      }
+    }
+    accel_dsp_biquad_init(&f, stages, coeffs, state);
+    ref_biquad_init(&ref, stages, coeffs);
+
+    for (int b = 0; b < BLOCKS_PER_TRIAL; b++) {
+      int16_t in[BLOCK_MAX], out[BLOCK_MAX], want[BLOCK_MAX];
+      size_t n = rand_block_len();
+
+      fill_block(in, n);
+      ref_biquad_q15(&ref, in, want, n);
+
+      int16_t *dst = out_for(in, out);
+
+      accel_dsp_biquad_q15(&f, in, dst, n);
+      check_q15("biquad", dst, want, n);
+    }
+  }
+}
+
+static void test_fir(void) {
+  for (int t = 0; t < TRIALS; t++) {
+    int16_t taps[REF_FIR_MAX_TAPS];
+    int16_t state[REF_FIR_MAX_TAPS - 1 + BLOCK_MAX];
+    uint16_t n_taps = (uint16_t)rand_range(1, REF_FIR_MAX_TAPS);
+    uint32_t kind = rand_next() % 4;
+    struct accel_dsp_fir f;
+    struct ref_fir ref;
+
+    for (uint16_t i = 0; i < n_taps; i++) {
+      /* Rails on every tap saturate on almost any input */
+      taps[i] = (kind == 0)   ? INT16_MAX
+                : (kind == 1) ? INT16_MIN
+                              : rand_q15();
+    }
+    accel_dsp_fir_init(&f, n_taps, taps, state, BLOCK_MAX);
+    ref_fir_init(&ref, n_taps, taps);
+
+    for (int b = 0; b < BLOCKS_PER_TRIAL; b++) {
+      int16_t in[BLOCK_MAX], out[BLOCK_MAX], want[BLOCK_MAX];
+      size_t n = rand_block_len();
+
+      fill_block(in, n);
+      ref_fir_q15(&ref, in, want, n);
+
+      int16_t *dst = out_for(in, out);
+
+      accel_dsp_fir_q15(&f, in, dst, n);
+      check_q15("fir", dst, want, n);
+    }
+  }
+}
+
+static void test_rms(void) {
+  for (int t = 0; t < TRIALS; t++) {
+    int16_t window[REF_RMS_MAX_LEN];
+    uint16_t len = (uint16_t)rand_range(1, REF_RMS_MAX_LEN);
+    struct accel_dsp_rms r;
+    struct ref_rms ref;
+
+    accel_dsp_rms_init(&r, window, len);
+    ref_rms_init(&ref, len);
+
+    for (int b = 0; b < BLOCKS_PER_TRIAL; b++) {
+      int16_t in[BLOCK_MAX];
+      size_t n = rand_block_len();
+
+      fill_block(in, n);
+      if (b == BLOCKS_PER_TRIAL - 1) {
+        /* All INT16_MIN: an RMS of 32768 that must clamp */
+        for (size_t i = 0; i < n; i++) {
+          in[i] = INT16_MIN;
+        }
+      }
+
+      int16_t want = ref_rms_q15(&ref, in, n);
+      int16_t got = accel_dsp_rms_q15(&r, in, n);
+
+      check_q15("rms", &got, &want, 1);
+    }
+  }
+}
+
+static void test_dc(void) {
+  for (int t = 0; t < TRIALS; t++) {
+    /* Mostly realistic poles, some anywhere including negative */
+    int16_t pole = (t % 4 == 0) ? rand_q15() : (int16_t)rand_range(30000, 32767);
+    struct accel_dsp_dc d;
+    struct ref_dc ref;
+
+    accel_dsp_dc_init(&d, pole);
+    ref_dc_init(&ref, pole);
+
+    for (int b = 0; b < BLOCKS_PER_TRIAL; b++) {
+      int16_t in[BLOCK_MAX], out[BLOCK_MAX], want[BLOCK_MAX];
+      size_t n = rand_block_len();
+
+      fill_block(in, n);
+      ref_dc_q15(&ref, in, want, n);
+
+      int16_t *dst = out_for(in, out);
+
+      accel_dsp_dc_q15(&d, in, dst, n);
+      check_q15("dc", dst, want, n);
+    }
+  }
+}
+
+static void test_scale(void) {
+  for (int t = 0; t < TRIALS * BLOCKS_PER_TRIAL; t++) {
+    int16_t in[BLOCK_MAX], out[BLOCK_MAX], want[BLOCK_MAX];
+    int32_t out31[BLOCK_MAX], want31[BLOCK_MAX];
+    size_t n = rand_block_len();
+    int8_t shift = (int8_t)rand_range(-16, 15);
+    int16_t scale = rand_q15();
+    int32_t scale31 = (int32_t)rand_next();
+
+    fill_block(in, n);
+
+    ref_scale_q31(in, want31, n, scale31, shift);
+    accel_dsp_scale_q31(in, out31, n, scale31, shift);
+    check_q31("scale_q31", out31, want31, n);
+
+    ref_scale_q15(in, want, n, scale, shift);
+
+    int16_t *dst = out_for(in, out);
+
+    accel_dsp_scale_q15(in, dst, n, scale, shift);
+    check_q15("scale_q15", dst, want, n);
+  }
+}
+
+/*============================================================================
+ * Main
+ *===========================================================================*/
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    rng = (uint32_t)strtoul(argv[1], NULL, 0) | 1U;
+  }
+
+  test_biquad();
+  test_fir();
+  test_rms();
+  test_dc();
+  test_scale();
+
+  printf("%" PRIu32 " blocks compared (%s path), %" PRIu32 " failures\n",
+         blocks,
+#if defined(__ARM_FEATURE_DSP)
+         "ACLE",
+#else
+         "portable",
+#endif
+         failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file arm_acle.h
+ * @brief Host model of the ACLE intrinsics accel_dsp.c uses
+ *
+ * Lets the __ARM_FEATURE_DSP branch of accel_dsp.c build and run on the
+ * host, so the intrinsic call sites (operand order, the casts to the packed
+ * types) are checked against the reference too. The bodies follow the
+ * instruction pseudocode in the Armv8-M Architecture Reference Manual.
+ */
+
+#ifndef ARM_ACLE_H_
+#define ARM_ACLE_H_
+
+#include <stdint.h>
+
+typedef int32_t int16x2_t;
+
+/* SMLALD: acc + lo(a) * lo(b) + hi(a) * hi(b), wrapping in 64 bits */
+static inline int64_t __smlald(int16x2_t a, int16x2_t b, int64_t acc) {
+  int32_t lo = (int32_t)(int16_t)(uint16_t)a * (int16_t)(uint16_t)b;
+  int32_t hi = (int32_t)(int16_t)(uint16_t)((uint32_t)a >> 16) *
+               (int16_t)(uint16_t)((uint32_t)b >> 16);
+
+  return (int64_t)((uint64_t)acc + (uint64_t)(int64_t)lo +
+                   (uint64_t)(int64_t)hi);
+}
+
+#endif /* ARM_ACLE_H_ */
@@ -0,0 +1,71 @@
+// ================= Lossless packet codec (decoder) =================
+// JS port of accel_codec_decode() in the coin-cell firmware's
+// src/accel_codec.c; the bitstream is described in src/accel_codec.h.
+//
+// First sample verbatim (int16 per channel), then blocks of 16 samples:
+// per channel 1 bit predictor order + 4 bits Rice k, then one Rice code per
+// sample of the zig-zagged residual. Bits are LSB first.
+
+const CODEC_BLOCK = 16;
+const CODEC_K_BITS = 4;
+const CODEC_ESCAPE = 24;
+const CODEC_RAW_BITS = 18;
+
+// bytes: Uint8Array of the packet's data area. Returns an Int16Array of
+// count * nch values (sample-major), or null if the data is malformed.
+function accelCodecDecode(bytes, nch, count) {
+    const lenBits = bytes.length * 8;
+    let pos = 0;
+
+    const get = (n) => {
+        if (pos + n > lenBits) throw new RangeError("codec data ends early");
+        let v = 0;
+        for (let i = 0; i < n; i++, pos++) {
+            v += ((bytes[pos >> 3] >> (pos & 7)) & 1) * 2 ** i;
+        }
+        return v;
+    };
+
+    const rice = (k) => {
+        let q = 0;
+        while (get(1)) {
+            if (++q === CODEC_ESCAPE) return get(CODEC_RAW_BITS);
+        }
+        return q * 2 ** k + get(k);
+    };
+
+    const unzigzag = (u) => (u & 1) ? -((u + 1) / 2) : u / 2;
+    const toInt16 = (v) => ((v + 0x8000) & 0xFFFF) - 0x8000;
+
+    try {
+        const out = new Int16Array(count * nch);
+        const prev1 = new Array(nch);
+        const prev2 = new Array(nch);
+
+        for (let ch = 0; ch < nch; ch++) {
+            out[ch] = toInt16(get(16));
+            prev1[ch] = prev2[ch] = out[ch];
+        }
+
+        for (let start = 1; start < count; start += CODEC_BLOCK) {
+            const n = Math.min(CODEC_BLOCK, count - start);
+
+            for (let ch = 0; ch < nch; ch++) {
+                const order = get(1);
+                const k = get(CODEC_K_BITS);
+
+                for (let i = 0; i < n; i++) {
+                    const pred = order ? 2 * prev1[ch] - prev2[ch] : prev1[ch];
+                    const x = pred + unzigzag(rice(k));
+
+                    out[(start + i) * nch + ch] = x;
+                    prev2[ch] = prev1[ch];
+                    prev1[ch] = x;
+                }
+            }
+        }
+        return out;
+    } catch (e) {
+        return null;
+    }
+}
@@ -1,15 +1,23 @@
 // ================= BLE UUIDs (Custom GATT Service) =================
 const ACCEL_SERVICE_UUID = "12340000-1234-5678-9abc-def012345678";
 const ACCEL_DATA_CHAR_UUID = "12340001-1234-5678-9abc-def012345678"; // NOTIFY
+const SAMPLE_RATE_CHAR_UUID = "12340003-1234-5678-9abc-def012345678"; // READ | WRITE
+const CHANNEL_MASK_CHAR_UUID = "12340006-1234-5678-9abc-def012345678"; // READ | WRITE
+const RETX_CHAR_UUID = "1234000a-1234-5678-9abc-def012345678"; // WRITE (optional)
 
-let device, accelDataChar, timeChart, fftChart;
+let device, accelDataChar, sampleRateChar, channelMaskChar, timeChart, fftChart;
+let retxChar = null;  // Only on firmware built with CONFIG_ACCEL_RETX
 
 // ===== Sensor Parameters =====
-const SAMPLE_RATE = 1000;   // 1000 Hz sensor sampling
+let sampleRate = 1000;      // Hz, read from the device on connect
 const LSB_PER_G = 2048.0;   // ±16g range
+const LSB_PER_DPS = 131.0;  // ±250 °/s gyro range (MPU6050 default)
 let sampleCount = 0;
 let lastSampleCounter = 0;
 let droppedSamples = 0;
+let gapSamples = 0;             // Samples ever missed, keeps t on the device's timeline
+let missingSamples = new Map(); // counter -> t, until retransmitted
+const RETX_MAX_SAMPLES = 4096;  // Larger gaps are beyond the device's window
 
 // ===== Data Storage =====
 let receivedData = [];  // [{t, x, y, z, ts}, ...]
@@ -36,7 +44,7 @@ let fftSize = 512;
 let fftAxis = 'x';
 
 // ===== DOM Element References =====
-let connectButton, startButton, stopButton, exportButton;
+let connectButton, startButton, stopButton, exportButton, rateSelect, channelSelect;
 let updateYAxisButton, zoomInButton, zoomOutButton;
 let xValue, yValue, zValue;
 let yAxisMin, yAxisMax, windowDisplay;
@@ -51,6 +59,8 @@ document.addEventListener("DOMContentLoaded", () => {
     startButton = document.getElementById("startButton");
     stopButton = document.getElementById("stopButton");
     exportButton = document.getElementById("exportButton");
+    rateSelect = document.getElementById("rateSelect");
+    channelSelect = document.getElementById("channelSelect");
     updateYAxisButton = document.getElementById("updateYAxisButton");
     zoomInButton = document.getElementById("zoomInButton");
     zoomOutButton = document.getElementById("zoomOutButton");
@@ -88,6 +98,8 @@ document.addEventListener("DOMContentLoaded", () => {
     updateYAxisButton.onclick = updateYAxis;
     zoomInButton.onclick = zoomIn;
     zoomOutButton.onclick = zoomOut;
+    rateSelect.onchange = writeSampleRate;
+    channelSelect.onchange = writeChannelMask;
 
     fftAxisSelect.onchange = () => { fftAxis = fftAxisSelect.value; };
     fftSizeSelect.onchange = () => {
@@ -107,6 +119,18 @@ async function connectBLE() {
         const server = await device.gatt.connect();
         const service = await server.getPrimaryService(ACCEL_SERVICE_UUID);
         accelDataChar = await service.getCharacteristic(ACCEL_DATA_CHAR_UUID);
+        sampleRateChar = await service.getCharacteristic(SAMPLE_RATE_CHAR_UUID);
+
+        const rateValue = await sampleRateChar.readValue();
+        applySampleRate(rateValue.getUint16(0, true));
+        rateSelect.disabled = false;
+
+        channelMaskChar = await service.getCharacteristic(CHANNEL_MASK_CHAR_UUID);
+        const maskValue = await channelMaskChar.readValue();
+        applyChannelMask(maskValue.getUint8(0));
+        channelSelect.disabled = false;
+
+        retxChar = await service.getCharacteristic(RETX_CHAR_UUID).catch(() => null);
 
         connectButton.textContent = "Connected";
         connectButton.disabled = true;
@@ -119,11 +143,65 @@ async function connectBLE() {
     }
 }
 
+// Sampling rate: uint16 LE Hz. The device applies it between samples and
+// keeps it across reboots; unsupported rates are rejected with an ATT error.
+async function writeSampleRate() {
+    const rate = parseInt(rateSelect.value);
+    const value = new DataView(new ArrayBuffer(2));
+    value.setUint16(0, rate, true);
+    try {
+        await sampleRateChar.writeValueWithResponse(value);
+        applySampleRate(rate);
+        console.log("Sampling rate set to", rate, "Hz");
+    } catch (err) {
+        console.error("Rate write failed:", err);
+        alert("Sampling rate change failed: " + err.message);
+        rateSelect.value = String(sampleRate);
+    }
+}
+
+function applySampleRate(rate) {
+    sampleRate = rate;
+    if (![...rateSelect.options].some(o => o.value === String(rate))) {
+        rateSelect.add(new Option(`${rate} Hz`, String(rate)));
+    }
+    rateSelect.value = String(rate);
+    fftChart.options.scales.x.max = sampleRate / 2;
+    fftChart.update('none');
+    updateFftResolution();
+}
+
+// Channel mask: uint8, bit 0-2 accel X/Y/Z, bit 3 temp, bit 4-6 gyro X/Y/Z.
+// Anything but accel XYZ arrives in the packed layout.
+async function writeChannelMask() {
+    const mask = parseInt(channelSelect.value);
+    try {
+        await channelMaskChar.writeValueWithResponse(new Uint8Array([mask]));
+        console.log("Channel mask set to 0x" + mask.toString(16));
+    } catch (err) {
+        console.error("Channel mask write failed:", err);
+        alert("Channel change failed: " + err.message);
+        channelSelect.value = channelSelect.dataset.current;
+        return;
+    }
+    channelSelect.dataset.current = String(mask);
+}
+
+function applyChannelMask(mask) {
+    if (![...channelSelect.options].some(o => o.value === String(mask))) {
+        channelSelect.add(new Option(`Mask 0x${mask.toString(16)}`, String(mask)));
+    }
+    channelSelect.value = String(mask);
+    channelSelect.dataset.current = String(mask);
+}
+
 async function sendStart() {
     receivedData = [];
     sampleCount = 0;
     lastSampleCounter = 0;
     droppedSamples = 0;
+    gapSamples = 0;
+    missingSamples.clear();
     latencyHistory = [];
     latencyMax = 0;
     startTime = Date.now();
@@ -162,10 +240,163 @@ async function sendStop() {
 // ================= DATA PROCESSING (Rev 3 Format) =================
 // Packet: burst_id(1) + samples[24×10] + crc16(2) = 243 bytes
 // Sample: sample_counter(2) + rel_timestamp_ms(2) + x(2) + y(2) + z(2) = 10 bytes
+//
+// Packed layout (burst_id bit 7 set), same 243 bytes:
+// burst_id(1) + channel_mask(1) + sample_count(1) + rate_hz(2)
+//   + base_counter(2) + base_timestamp_ms(2) + data[232] + crc16(2)
+// Each sample holds the channels set in channel_mask, in bit order, as int16:
+// bit 0-2 accel X/Y/Z, bit 3 temperature, bit 4-6 gyro X/Y/Z.
+//
+// v4 layout (packed, and bit 7 of channel_mask set), same 243 bytes:
+// burst_id(1) + channel_mask(1) + sample_count(1) + rate_hz(2)
+//   + base_counter(4) + base_timestamp_us(4) + data[228] + crc16(2)
+// 32-bit counter, timestamp in µs of device uptime; 38 XYZ samples.
+// rate_hz bit 15 set: data[] is losslessly coded (accel_codec.js), up to 255
+// samples.
 
 const SAMPLE_SIZE = 10;
 const SAMPLES_PER_PACKET = 24;
 const PACKET_SIZE = 243;  // 1 + 240 + 2
+const BURST_ID_PACKED = 0x80;
+const BURST_ID_RETX = 0x40;    // Sent again on request
+const PACKED_HEADER_SIZE = 9;  // burst_id + 8-byte header
+const PACKED_V4 = 0x80;        // channel_mask flag
+const V4_HEADER_SIZE = 13;     // burst_id + 12-byte header
+const RATE_CODED = 0x8000;     // v4 rate_hz flag
+const CH_COUNT = 7;
+
+// Returns [{counter, ts, raw: [ax, ay, az, temp, gx, gy, gz]}]; channels not
+// in the packet are null. v4 results have .wide set: 32-bit counters, and ts
+// in ms from the µs timestamp (wraps with it, every 2^32 µs).
+function decodePackedSamples(view) {
+    const wide = (view.getUint8(1) & PACKED_V4) !== 0;
+    const mask = view.getUint8(1) & ~PACKED_V4;
+    const count = view.getUint8(2);
+    const rate = view.getUint16(3, true) & ~RATE_CODED;
+    const samples = [];
+    samples.wide = wide;
+
+    if (wide) {
+        const baseCounter = view.getUint32(5, true);
+        const baseTsUs = view.getUint32(9, true);
+        const makeSample = (i, raw) => ({
+            counter: (baseCounter + i) >>> 0,
+            ts: (((baseTsUs + Math.round(i * 1e6 / rate)) >>> 0) / 1000),
+            raw
+        });
+
+        if (view.getUint16(3, true) & RATE_CODED) {
+            decodeCodedData(view, V4_HEADER_SIZE, mask, count, makeSample,
+                            samples);
+        } else {
+            decodePackedData(view, V4_HEADER_SIZE, mask, count, makeSample,
+                             samples);
+        }
+        return samples;
+    }
+
+    const baseCounter = view.getUint16(5, true);
+    const baseTs = view.getUint16(7, true);
+    decodePackedData(view, PACKED_HEADER_SIZE, mask, count, (i, raw) => ({
+        counter: (baseCounter + i) & 0xFFFF,
+        ts: (baseTs + Math.round(i * 1000 / rate)) & 0xFFFF,
+        raw
+    }), samples);
+    return samples;
+}
+
+// Coded v4 data: decode, then spread the values over the masked channels
+function decodeCodedData(view, offset, mask, count, makeSample, samples) {
+    const channels = [];
+    for (let c = 0; c < CH_COUNT; c++) {
+        if (mask & (1 << c)) channels.push(c);
+    }
+
+    const bytes = new Uint8Array(view.buffer, view.byteOffset + offset,
+                                 PACKET_SIZE - 2 - offset);
+    const values = accelCodecDecode(bytes, channels.length, count);
+    if (!values) {
+        console.warn("Corrupt coded packet, skipped");
+        return;
+    }
+
+    for (let i = 0; i < count; i++) {
+        const raw = new Array(CH_COUNT).fill(null);
+        channels.forEach((c, j) => { raw[c] = values[i * channels.length + j]; });
+        samples.push(makeSample(i, raw));
+    }
+}
+
+// Sample-major int16 channels shared by the packed and v4 layouts
+function decodePackedData(view, offset, mask, count, makeSample, samples) {
+    for (let i = 0; i < count; i++) {
+        const raw = new Array(CH_COUNT).fill(null);
+        for (let c = 0; c < CH_COUNT; c++) {
+            if (mask & (1 << c)) {
+                raw[c] = view.getInt16(offset, true);
+                offset += 2;
+            }
+        }
+        samples.push(makeSample(i, raw));
+    }
+}
+
+// Rev 3 samples in the shape decodePackedSamples() returns
+function decodeRev3Samples(view) {
+    const samples = [];
+    for (let i = 0; i < SAMPLES_PER_PACKET; i++) {
+        const offset = 1 + i * SAMPLE_SIZE;
+        samples.push({
+            counter: view.getUint16(offset, true),
+            ts: view.getUint16(offset + 2, true),
+            raw: [view.getInt16(offset + 4, true), view.getInt16(offset + 6, true),
+                  view.getInt16(offset + 8, true), null, null, null, null]
+        });
+    }
+    return samples;
+}
+
+// ================= RETRANSMISSION =================
+// Request: uint32 first counter + uint16 count, LE. Rev 3 and packed packets
+// match on the low 16 bits of the counter.
+function requestRetransmit(first, count, tFirst, wide) {
+    if (count > RETX_MAX_SAMPLES) return;
+    for (let k = 0; k < count; k++) {
+        const c = wide ? (first + k) >>> 0 : (first + k) & 0xFFFF;
+        missingSamples.set(c, tFirst + k / sampleRate);
+    }
+    if (!retxChar) return;
+
+    const req = new DataView(new ArrayBuffer(6));
+    req.setUint32(0, first >>> 0, true);
+    req.setUint16(4, count, true);
+    retxChar.writeValueWithoutResponse(req)
+        .catch(err => console.warn("Retransmit request failed:", err));
+}
+
+// Resent packet: keep only the samples still missing. They go to the CSV
+// (sorted back into place on export), not to the live charts.
+function onRetransmit(view) {
+    const samples = (view.getUint8(0) & BURST_ID_PACKED)
+        ? decodePackedSamples(view) : decodeRev3Samples(view);
+
+    for (const s of samples) {
+        const t = missingSamples.get(s.counter);
+        if (t === undefined) continue;
+        missingSamples.delete(s.counter);
+        droppedSamples--;
+
+        const opt = (v, scale, off = 0) => v === null ? null : v / scale + off;
+        receivedData.push({
+            t, x: (s.raw[0] ?? 0) / LSB_PER_G, y: (s.raw[1] ?? 0) / LSB_PER_G,
+            z: (s.raw[2] ?? 0) / LSB_PER_G, ts: s.ts + fwTsWrapOffset,
+            temp: opt(s.raw[3], 340.0, 36.53), gx: opt(s.raw[4], LSB_PER_DPS),
+            gy: opt(s.raw[5], LSB_PER_DPS), gz: opt(s.raw[6], LSB_PER_DPS),
+            recovered: true
+        });
+    }
+    droppedCountEl.textContent = droppedSamples.toString();
+}
 
 function onData(event) {
     const view = event.target.value;
@@ -173,10 +404,20 @@ function onData(event) {
 
     const packetLen = view.byteLength;
 
-    // Determine packet format: Rev 3 (243 bytes) or legacy (141 bytes)
-    let samplesInPacket, sampleSize, hasNewFormat;
+    if (packetLen >= 243 && (view.getUint8(0) & BURST_ID_RETX)) {
+        onRetransmit(view);
+        return;
+    }
+
+    // Determine packet format: Rev 3 / packed (243 bytes) or legacy (141 bytes)
+    let samplesInPacket, sampleSize, hasNewFormat, packedSamples = null;
 
-    if (packetLen >= 243) {
+    if (packetLen >= 243 && (view.getUint8(0) & BURST_ID_PACKED)) {
+        hasNewFormat = true;
+        packedSamples = decodePackedSamples(view);
+        samplesInPacket = packedSamples.length;
+        if (samplesInPacket === 0) return;
+    } else if (packetLen >= 243) {
         // Rev 3: 243-byte packet (24 samples × 10 bytes)
         hasNewFormat = true;
         samplesInPacket = SAMPLES_PER_PACKET;
@@ -198,8 +439,21 @@ function onData(event) {
     // Parse each sample
     for (let i = 0; i < samplesInPacket; i++) {
         let offset, sampleCounter, timestampMs, rawX, rawY, rawZ;
-
-        if (hasNewFormat) {
+        let temp = null, gx = null, gy = null, gz = null;
+
+        if (packedSamples) {
+            const s = packedSamples[i];
+            sampleCounter = s.counter;
+            timestampMs = s.ts;
+            // Missing accel axes plot as 0
+            rawX = s.raw[0] ?? 0;
+            rawY = s.raw[1] ?? 0;
+            rawZ = s.raw[2] ?? 0;
+            if (s.raw[3] !== null) temp = s.raw[3] / 340.0 + 36.53;
+            if (s.raw[4] !== null) gx = s.raw[4] / LSB_PER_DPS;
+            if (s.raw[5] !== null) gy = s.raw[5] / LSB_PER_DPS;
+            if (s.raw[6] !== null) gz = s.raw[6] / LSB_PER_DPS;
+        } else if (hasNewFormat) {
             // Rev 3 format: burst_id(1) + samples[24 × 10]
             offset = 1 + (i * SAMPLE_SIZE);
             sampleCounter = view.getUint16(offset, true);      // 2 bytes
@@ -218,7 +472,15 @@ function onData(event) {
         }
 
         // Unwrap 16-bit timestamp (Rev 3+ uses uint16 timestamps that wrap every ~65s)
-        if (hasNewFormat) {
+        const wide = packedSamples !== null && packedSamples.wide;
+        if (wide) {
+            // v4: ms from the 32-bit µs uptime, wraps every ~71.6 min
+            if (timestampMs < lastFwTs - 30000) {
+                fwTsWrapOffset += 2 ** 32 / 1000;
+            }
+            lastFwTs = timestampMs;
+            timestampMs += fwTsWrapOffset;
+        } else if (hasNewFormat) {
             // If timestamp jumped backwards significantly, it wrapped
             if (timestampMs < lastFwTs - 30000) {
                 fwTsWrapOffset += 65536;
@@ -229,10 +491,17 @@ function onData(event) {
 
         // Check for dropped samples (handle 16-bit wrap for Rev 3)
         if (lastSampleCounter > 0) {
-            let expected = (lastSampleCounter + 1) & (hasNewFormat ? 0xFFFF : 0xFFFFFFFF);
+            let expected = wide || !hasNewFormat
+                ? (lastSampleCounter + 1) >>> 0
+                : (lastSampleCounter + 1) & 0xFFFF;
             if (sampleCounter !== expected && sampleCounter > lastSampleCounter) {
                 const dropped = sampleCounter - lastSampleCounter - 1;
                 droppedSamples += dropped;
+                if (hasNewFormat) {
+                    requestRetransmit(expected, dropped,
+                                      (sampleCount + gapSamples) / sampleRate, wide);
+                }
+                gapSamples += dropped;
             }
         }
         lastSampleCounter = sampleCounter;
@@ -242,12 +511,12 @@ function onData(event) {
         const ay_g = rawY / LSB_PER_G;
         const az_g = rawZ / LSB_PER_G;
 
-        // Calculate time from sample counter
-        const t = (sampleCount) / SAMPLE_RATE;
+        // Calculate time from sample counter (gaps keep their slots)
+        const t = (sampleCount + gapSamples) / sampleRate;
         sampleCount++;
 
         // Store for CSV
-        receivedData.push({ t, x: ax_g, y: ay_g, z: az_g, ts: timestampMs });
+        receivedData.push({ t, x: ax_g, y: ay_g, z: az_g, ts: timestampMs, temp, gx, gy, gz });
 
         // Update chart datasets
         timeChart.data.datasets[0].data.push({ x: t, y: ax_g });
@@ -256,7 +525,7 @@ function onData(event) {
 
         // Calculate E2E latency (for burst mode, this includes buffering time)
         // Reset anchor on new burst (detected by ID change)
-        let currentBurstId = hasNewFormat ? view.getUint8(0) : -1;
+        let currentBurstId = hasNewFormat ? (view.getUint8(0) & ~BURST_ID_PACKED) : -1;
         if (sampleCount === 1 || (hasNewFormat && currentBurstId !== lastBurstId)) {
             window.firstDeviceTs = timestampMs;
             window.firstBrowserTs = receiveTime;
@@ -318,7 +587,7 @@ function renderLoop() {
     }
 
     // Trim time-domain chart
-    const maxPoints = Math.ceil(windowSeconds * SAMPLE_RATE) + 20;
+    const maxPoints = Math.ceil(windowSeconds * sampleRate) + 20;
     timeChart.data.datasets.forEach(ds => {
         while (ds.data.length > maxPoints) ds.data.shift();
     });
@@ -362,7 +631,7 @@ function computeAndDisplayFFT() {
 
     // Compute magnitude spectrum (single-sided)
     const magnitudes = [];
-    const freqBinSize = SAMPLE_RATE / n;
+    const freqBinSize = sampleRate / n;
     let peakMag = 0;
     let peakIdx = 0;
 
@@ -442,7 +711,7 @@ function reverseBits(n, bits) {
 }
 
 function updateFftResolution() {
-    const resolution = SAMPLE_RATE / fftSize;
+    const resolution = sampleRate / fftSize;
     freqResolution.textContent = `Resolution: ${resolution.toFixed(2)} Hz`;
 }
 
@@ -497,7 +766,7 @@ function initCharts() {
                 legend: { display: false }
             },
             scales: {
-                x: { type: "linear", title: { display: true, text: "Frequency (Hz)", font: { size: 11 } }, min: 0, max: SAMPLE_RATE / 2, grid: { color: '#f0f0f0' } },
+                x: { type: "linear", title: { display: true, text: "Frequency (Hz)", font: { size: 11 } }, min: 0, max: sampleRate / 2, grid: { color: '#f0f0f0' } },
                 y: { title: { display: true, text: "Magnitude (g)", font: { size: 11 } }, min: 0, grid: { color: '#f0f0f0' } }
             }
         }
@@ -536,8 +805,12 @@ function updateWindowDisplay() {
 // ================= CSV EXPORT =================
 function saveDataToCSV() {
     const fileName = document.getElementById("file-name").value || "accel_data";
-    let csv = "Time(s),DeviceTs(ms),X(g),Y(g),Z(g)\n";
-    receivedData.forEach(d => csv += `${d.t.toFixed(4)},${d.ts || 0},${d.x.toFixed(4)},${d.y.toFixed(4)},${d.z.toFixed(4)}\n`);
+    const opt = (v, digits) => (v === null || v === undefined) ? "" : v.toFixed(digits);
+    let csv = "Time(s),DeviceTs(ms),X(g),Y(g),Z(g),Temp(C),GX(dps),GY(dps),GZ(dps)\n";
+    const rows = receivedData.some(d => d.recovered)
+        ? [...receivedData].sort((a, b) => a.t - b.t) : receivedData;
+    rows.forEach(d => csv += `${d.t.toFixed(4)},${d.ts || 0},${d.x.toFixed(4)},${d.y.toFixed(4)},${d.z.toFixed(4)},` +
+        `${opt(d.temp, 2)},${opt(d.gx, 3)},${opt(d.gy, 3)},${opt(d.gz, 3)}\n`);
     const blob = new Blob([csv], { type: "text/csv" });
     const a = document.createElement("a");
     a.href = URL.createObjectURL(blob);